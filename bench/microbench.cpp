@@ -0,0 +1,533 @@
+/**
+ * @file microbench.cpp
+ * @brief Micro-benchmarks of the building blocks of the solvers.
+ *
+ * End-to-end timings hide regressions of the individual kernels, so this program
+ * times each building block in isolation:
+ * - sweep: the 5-point in-place Jacobi sweep (precomputed and functional right-hand side,
+ *   compile-time-fixed size, threaded strips)
+ * - smoother: Gauss-Seidel sweeps, lexicographic and red-black on the natural layout, and
+ *   red-black on the red/black split layout (whole sweep, and the conversion to and from it)
+ * - layout: the Jacobi sweep and the multigrid restriction (full weighting) and prolongation
+ *   (bilinear) on the natural row-major layout and on tiled grids, with the tiles in row-major
+ *   and in Morton order, and the conversion to and from the tiled layout
+ * - residual: the squared difference between two grids (serial and threaded)
+ * - halo: pack of the boundary rows into the send buffers and unpack of the ghost rows
+ * - rhs: precompute of h^2 f on the whole grid
+ * - boundary: evaluation of the four boundary conditions
+ * - expr: evaluation of the forcing term as a lambda and as a muParserX expression
+ *
+ * Every benchmark is parameterized over n and, when threaded, over the number of threads.
+ * The number of repetitions of a sample is calibrated so that a sample lasts at least
+ * --min-time seconds; the median over --samples samples is reported in ns per point and
+ * GB/s, together with the minimum and the median absolute deviation, so that noisy
+ * results can be recognized. The L1 data cache and last-level cache load misses per point
+ * of one more sample are counted with perf events, when the kernel allows it.
+ *
+ * Command Line Options:
+ * - --n <list>: Comma-separated grid sizes (default 64,256,1024)
+ * - --threads <list>: Comma-separated thread counts of the threaded benchmarks (default 1,2,4)
+ * - --samples <k>: Number of samples of each benchmark (default 15)
+ * - --min-time <s>: Minimum duration of a sample in seconds (default 0.01)
+ * - --filter <text>: Only run the benchmarks whose name contains text
+ * - --csv <file>: Also write the results as CSV
+ *
+ * Build and run with
+ * ```bash
+ * make microbench && ./microbench
+ * ```
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <omp.h>
+
+#include "kernels.hpp"
+#include "checkerboard.hpp"
+#include "tiled.hpp"
+#include "perf_counters.hpp"
+#include "thread_pool.hpp"
+#include "muparser_interface.hpp"
+
+namespace
+{
+    constexpr auto pi = std::numbers::pi;
+
+    /// @brief result of a benchmark
+    struct Result
+    {
+        std::string name;
+        size_t n;
+        unsigned threads;
+        double median_ns_point;
+        double min_ns_point;
+        double mad_percent;
+        double gb_per_s;
+        double l1_misses_point;
+        double llc_misses_point;
+    };
+
+    /// @brief options of the run
+    struct Options
+    {
+        std::vector<size_t> sizes{64, 256, 1024};
+        std::vector<unsigned> threads{1, 2, 4};
+        unsigned samples = 15;
+        double min_time = 0.01;
+        std::string filter;
+        std::string csv;
+    };
+
+    /// @brief parse a comma-separated list of numbers
+    template <typename T>
+    std::vector<T> parse_list(const std::string &text)
+    {
+        std::vector<T> values;
+        std::stringstream ss(text);
+        std::string cell;
+        while (std::getline(ss, cell, ','))
+            values.push_back(static_cast<T>(std::stoul(cell)));
+        return values;
+    }
+
+    /// @brief execute job(thread_id, num_threads) on a team of threads, as the threaded solvers do
+    void parallel(unsigned threads, const std::function<void(unsigned, unsigned)> &job)
+    {
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+        job(omp_get_thread_num(), omp_get_num_threads());
+#else
+        solver::ThreadPool::instance().run(threads, job);
+#endif
+    }
+
+    /// @brief barrier among the threads of the team started by parallel
+    void barrier()
+    {
+#ifdef _OPENMP
+#pragma omp barrier
+#else
+        solver::ThreadPool::instance().barrier();
+#endif
+    }
+
+    /// @brief time a function and summarize the samples
+    /// @param name name of the benchmark
+    /// @param n grid size
+    /// @param threads number of threads
+    /// @param points points processed by one call
+    /// @param bytes bytes moved by one call
+    /// @param fun function to be timed
+    Result measure(const Options &options, const std::string &name, size_t n, unsigned threads,
+                   double points, double bytes, const std::function<void()> &fun)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Warm-up, then calibrate the repetitions of a sample
+        fun();
+        size_t reps = 1;
+        while (true)
+        {
+            auto start = clock::now();
+            for (size_t r = 0; r < reps; ++r)
+                fun();
+            double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            if (elapsed >= options.min_time || reps >= (size_t{1} << 30))
+                break;
+            reps *= 2;
+        }
+
+        std::vector<double> seconds(options.samples);
+        for (double &sample : seconds)
+        {
+            auto start = clock::now();
+            for (size_t r = 0; r < reps; ++r)
+                fun();
+            sample = std::chrono::duration<double>(clock::now() - start).count() / reps;
+        }
+
+        // One more sample with the cache miss counters (negative if they are not available)
+        perf::Counter l1(perf::Event::L1DLoadMisses), llc(perf::Event::LLCLoadMisses);
+        l1.start();
+        llc.start();
+        for (size_t r = 0; r < reps; ++r)
+            fun();
+        const int64_t l1_misses = l1.stop(), llc_misses = llc.stop();
+
+        std::sort(seconds.begin(), seconds.end());
+        const double median = seconds[seconds.size() / 2];
+        std::vector<double> deviations(seconds.size());
+        std::transform(seconds.begin(), seconds.end(), deviations.begin(), [median](double s)
+                       { return std::abs(s - median); });
+        std::sort(deviations.begin(), deviations.end());
+        const double mad = deviations[deviations.size() / 2];
+
+        return {name, n, threads, median / points * 1e9, seconds.front() / points * 1e9,
+                100.0 * mad / median, bytes / median * 1e-9,
+                (l1_misses < 0) ? -1.0 : l1_misses / (points * reps), (llc_misses < 0) ? -1.0 : llc_misses / (points * reps)};
+    }
+
+    /// @brief set up the grid of the benchmark problem (zero boundary, zero interior)
+    std::vector<double> make_grid(size_t n)
+    {
+        return std::vector<double>(n * n, 0.0);
+    }
+
+    /// @brief h^2 f of the benchmark problem on the whole grid
+    std::vector<double> make_rhs(size_t n)
+    {
+        const double h = 1.0 / (n - 1);
+        std::vector<double> rhs(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                rhs[i * n + j] = h * h * 8 * pi * pi * std::sin(2 * pi * i * h) * std::sin(2 * pi * j * h);
+        return rhs;
+    }
+
+    /// @brief compile-time-fixed-size sweep if n is one of the specialized sizes
+    bool sweep_fixed(size_t n, double *grid, const double *rhs)
+    {
+        switch (n)
+        {
+        case 16:
+            solver::kernels::jacobi_sweep_fixed<16>(grid, rhs);
+            return true;
+        case 32:
+            solver::kernels::jacobi_sweep_fixed<32>(grid, rhs);
+            return true;
+        case 64:
+            solver::kernels::jacobi_sweep_fixed<64>(grid, rhs);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// @brief run all the benchmarks of one grid size
+    void run_size(const Options &options, size_t n, std::vector<Result> &results)
+    {
+        const double interior = static_cast<double>((n - 2) * (n - 2));
+        const double all = static_cast<double>(n * n);
+        const double h = 1.0 / (n - 1);
+        auto selected = [&](const std::string &name)
+        { return options.filter.empty() || name.find(options.filter) != std::string::npos; };
+
+        std::vector<double> grid = make_grid(n);
+        std::vector<double> rhs = make_rhs(n);
+        std::vector<double> above(n), current(n);
+
+        std::function<double(std::vector<double>)> f = [](std::vector<double> x)
+        { return 8 * pi * pi * std::sin(2 * pi * x[0]) * std::sin(2 * pi * x[1]); };
+
+        // 5-point sweep with a precomputed right-hand side: grid read and written, rhs read
+        if (selected("sweep/precomputed"))
+        {
+            auto rhs_at = [&](size_t i, size_t j)
+            { return rhs[i * n + j]; };
+            results.push_back(measure(options, "sweep/precomputed", n, 1, interior, 3.0 * 8 * all, [&]
+                                      {
+                std::copy(grid.begin(), grid.begin() + n, above.begin());
+                solver::kernels::jacobi_sweep_inplace(grid.data(), n, 1, n - 1, above, current, &grid[(n - 1) * n], rhs_at); }));
+        }
+
+        // 5-point sweep evaluating f at every point, as the Solver class does
+        if (selected("sweep/function"))
+        {
+            auto rhs_at = [&](size_t i, size_t j)
+            { return h * h * f({static_cast<double>(i) * h, static_cast<double>(j) * h}); };
+            results.push_back(measure(options, "sweep/function", n, 1, interior, 2.0 * 8 * all, [&]
+                                      {
+                std::copy(grid.begin(), grid.begin() + n, above.begin());
+                solver::kernels::jacobi_sweep_inplace(grid.data(), n, 1, n - 1, above, current, &grid[(n - 1) * n], rhs_at); }));
+        }
+
+        // Compile-time-fixed-size sweep of the batch mode
+        if (selected("sweep/fixed") && sweep_fixed(n, grid.data(), rhs.data()))
+        {
+            results.push_back(measure(options, "sweep/fixed", n, 1, interior, 3.0 * 8 * all, [&]
+                                      { sweep_fixed(n, grid.data(), rhs.data()); }));
+        }
+
+        // Threaded sweep on strips, with the copies of the bordering rows and the barriers of the solvers
+        for (unsigned threads : options.threads)
+        {
+            if (!selected("sweep/strips"))
+                break;
+            auto rhs_at = [&](size_t i, size_t j)
+            { return rhs[i * n + j]; };
+            results.push_back(measure(options, "sweep/strips", n, threads, interior, 3.0 * 8 * all, [&]
+                                      { parallel(threads, [&](unsigned id, unsigned team)
+                                                 {
+                size_t first, last;
+                solver::kernels::strip_bounds(1, n - 1, id, team, first, last);
+                std::vector<double> strip_above(grid.begin() + (first - 1) * n, grid.begin() + first * n);
+                std::vector<double> strip_below(grid.begin() + last * n, grid.begin() + (last + 1) * n);
+                std::vector<double> strip_current(n);
+                barrier();
+                solver::kernels::jacobi_sweep_inplace(grid.data(), n, first, last, strip_above, strip_current, strip_below.data(), rhs_at); }); }));
+        }
+
+        // Gauss-Seidel smoothers on the natural layout: every colour pass of the red-black sweep
+        // reads and writes the whole grid and reads the whole rhs
+        if (selected("smoother/lexicographic"))
+        {
+            results.push_back(measure(options, "smoother/lexicographic", n, 1, interior, 3.0 * 8 * all, [&]
+                                      { solver::kernels::gauss_seidel_sweep(grid.data(), n, rhs.data()); }));
+        }
+        if (selected("smoother/red_black"))
+        {
+            results.push_back(measure(options, "smoother/red_black", n, 1, interior, 2 * 3.0 * 8 * all, [&]
+                                      { solver::kernels::red_black_sweep(grid.data(), n, rhs.data()); }));
+        }
+
+        // Red-black on the split layout: a colour pass reads and writes its colour, reads its rhs
+        // and the other colour, half of the grid each
+        solver::checkerboard::Grid split_grid(n), split_rhs(n);
+        split_grid.split(grid.data());
+        split_rhs.split(rhs.data());
+        if (selected("smoother/rb_split"))
+        {
+            results.push_back(measure(options, "smoother/rb_split", n, 1, interior, 2 * 4.0 * 8 * all / 2, [&]
+                                      { solver::checkerboard::sweep(split_grid, split_rhs); }));
+        }
+        if (selected("smoother/rb_convert"))
+        {
+            results.push_back(measure(options, "smoother/rb_convert", n, 1, all, 4.0 * 8 * all, [&]
+                                      {
+                split_grid.split(grid.data());
+                split_grid.merge(grid.data()); }));
+        }
+
+        // Jacobi sweep and multigrid transfers on the row-major layout and on tiled grids; the
+        // transfers need an odd size, so that the coarse points lie on fine points
+        const size_t m = n | 1, mc = (m + 1) / 2;
+        const double fine_points = static_cast<double>(m * m);
+        std::vector<double> fine = make_rhs(m), coarse(mc * mc), next(grid);
+        if (selected("layout/jacobi_rows"))
+        {
+            results.push_back(measure(options, "layout/jacobi_rows", n, 1, interior, 3.0 * 8 * all, [&]
+                                      {
+                for (size_t i = 1; i < n - 1; ++i)
+                    for (size_t j = 1; j < n - 1; ++j)
+                        next[i * n + j] = 0.25 * (grid[(i - 1) * n + j] + grid[(i + 1) * n + j] + grid[i * n + j - 1] +
+                                                  grid[i * n + j + 1] + rhs[i * n + j]);
+                std::swap(grid, next); }));
+        }
+        if (selected("layout/restrict_rows"))
+        {
+            results.push_back(measure(options, "layout/restrict_rows", m, 1, fine_points, 8.0 * (m * m + mc * mc), [&]
+                                      { solver::kernels::restrict_full_weighting(fine.data(), m, coarse.data()); }));
+        }
+        if (selected("layout/prolong_rows"))
+        {
+            results.push_back(measure(options, "layout/prolong_rows", m, 1, fine_points, 8.0 * (2 * m * m + mc * mc), [&]
+                                      { solver::kernels::prolong_bilinear(coarse.data(), m, fine.data()); }));
+        }
+        for (auto [order, label] : {std::pair{solver::tiled::Order::RowMajor, "tiled"}, std::pair{solver::tiled::Order::Morton, "morton"}})
+        {
+            const std::string suffix = label;
+            solver::tiled::Grid tiled_grid(n, 32, order), tiled_next(n, 32, order), tiled_rhs(n, 32, order);
+            tiled_grid.from_natural(grid.data());
+            tiled_next.from_natural(grid.data());
+            tiled_rhs.from_natural(rhs.data());
+            solver::tiled::Grid tiled_fine(m, 32, order), tiled_coarse(mc, 32, order);
+            tiled_fine.from_natural(fine.data());
+            if (selected("layout/jacobi_" + suffix))
+            {
+                results.push_back(measure(options, "layout/jacobi_" + suffix, n, 1, interior, 3.0 * 8 * all, [&]
+                                          {
+                    solver::tiled::jacobi_sweep(tiled_grid, tiled_next, tiled_rhs);
+                    std::swap(tiled_grid, tiled_next); }));
+            }
+            if (selected("layout/restrict_" + suffix))
+            {
+                results.push_back(measure(options, "layout/restrict_" + suffix, m, 1, fine_points, 8.0 * (m * m + mc * mc), [&]
+                                          { solver::tiled::restrict_full_weighting(tiled_fine, tiled_coarse); }));
+            }
+            if (selected("layout/prolong_" + suffix))
+            {
+                results.push_back(measure(options, "layout/prolong_" + suffix, m, 1, fine_points, 8.0 * (2 * m * m + mc * mc), [&]
+                                          { solver::tiled::prolong_bilinear(tiled_coarse, tiled_fine); }));
+            }
+            if (selected("layout/convert_" + suffix))
+            {
+                results.push_back(measure(options, "layout/convert_" + suffix, n, 1, all, 4.0 * 8 * all, [&]
+                                          {
+                    tiled_grid.from_natural(grid.data());
+                    tiled_grid.to_natural(next.data()); }));
+            }
+        }
+
+        // Residual norm between two grids
+        std::vector<double> previous(grid);
+        if (selected("residual/serial"))
+        {
+            results.push_back(measure(options, "residual/serial", n, 1, all, 2.0 * 8 * all, [&]
+                                      {
+                volatile double sum = solver::kernels::squared_difference(grid.data(), previous.data(), n * n);
+                (void)sum; }));
+        }
+        for (unsigned threads : options.threads)
+        {
+            if (!selected("residual/threads"))
+                break;
+            std::vector<double> partial(threads);
+            results.push_back(measure(options, "residual/threads", n, threads, all, 2.0 * 8 * all, [&]
+                                      {
+                parallel(threads, [&](unsigned id, unsigned team)
+                         {
+                size_t first, last;
+                solver::kernels::strip_bounds(0, n, id, team, first, last);
+                partial[id] = solver::kernels::squared_difference(&grid[first * n], &previous[first * n], (last - first) * n); });
+                volatile double sum = std::accumulate(partial.begin(), partial.end(), 0.0);
+                (void)sum; }));
+        }
+
+        // Halo pack (boundary rows to send buffers) and unpack (receive buffers to ghost rows)
+        if (selected("halo/pack_unpack"))
+        {
+            std::vector<double> send_top(n), send_bottom(n), recv_top(n, 1.0), recv_bottom(n, 1.0);
+            results.push_back(measure(options, "halo/pack_unpack", n, 1, 4.0 * n, 4.0 * 2 * 8 * n, [&]
+                                      {
+                std::copy(grid.begin() + n, grid.begin() + 2 * n, send_top.begin());
+                std::copy(grid.begin() + (n - 2) * n, grid.begin() + (n - 1) * n, send_bottom.begin());
+                std::copy(recv_top.begin(), recv_top.end(), grid.begin());
+                std::copy(recv_bottom.begin(), recv_bottom.end(), grid.begin() + (n - 1) * n); }));
+        }
+
+        // Precompute of h^2 f on the whole grid
+        std::vector<double> precomputed(n * n);
+        for (unsigned threads : options.threads)
+        {
+            if (!selected("rhs/precompute"))
+                break;
+            results.push_back(measure(options, "rhs/precompute", n, threads, all, 8.0 * all, [&]
+                                      { parallel(threads, [&](unsigned id, unsigned team)
+                                                 {
+                size_t first, last;
+                solver::kernels::strip_bounds(0, n, id, team, first, last);
+                for (size_t i = first; i < last; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                        precomputed[i * n + j] = h * h * f({static_cast<double>(i) * h, static_cast<double>(j) * h}); }); }));
+        }
+
+        // Boundary fill, in the same order as the solvers
+        if (selected("boundary/fill"))
+        {
+            std::function<double(std::vector<double>)> bc = [](std::vector<double> x)
+            { return x[0] * (1.0 - x[1]); };
+            results.push_back(measure(options, "boundary/fill", n, 1, 4.0 * n, 4.0 * 8 * n, [&]
+                                      {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    grid[i] = bc({0.0, i * h});
+                    grid[i * n + (n - 1)] = bc({i * h, 1.0});
+                    grid[(n - 1) * n + i] = bc({1.0, i * h});
+                    grid[i * n] = bc({i * h, 0.0});
+                } }));
+        }
+
+        // Evaluation of the forcing term on one row of the grid
+        if (selected("expr/lambda"))
+        {
+            results.push_back(measure(options, "expr/lambda", n, 1, static_cast<double>(n), 8.0 * n, [&]
+                                      {
+                for (size_t j = 0; j < n; ++j)
+                    precomputed[j] = f({0.25, j * h}); }));
+        }
+        if (selected("expr/muparserx"))
+        {
+            muparser::muParserXInterface parsed("8 * pi * pi * sin(2 * pi * x[0]) * sin(2 * pi * x[1])", 2);
+            results.push_back(measure(options, "expr/muparserx", n, 1, static_cast<double>(n), 8.0 * n, [&]
+                                      {
+                for (size_t j = 0; j < n; ++j)
+                    precomputed[j] = parsed({0.25, j * h}); }));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc)
+            options.sizes = parse_list<size_t>(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            options.threads = parse_list<unsigned>(argv[++i]);
+        else if (arg == "--samples" && i + 1 < argc)
+            options.samples = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--min-time" && i + 1 < argc)
+            options.min_time = std::stod(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc)
+            options.filter = argv[++i];
+        else if (arg == "--csv" && i + 1 < argc)
+            options.csv = argv[++i];
+        else
+        {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::setw(22) << std::left << "benchmark" << std::right
+              << std::setw(8) << "n"
+              << std::setw(9) << "threads"
+              << std::setw(14) << "ns/point"
+              << std::setw(14) << "min ns/point"
+              << std::setw(10) << "MAD %"
+              << std::setw(10) << "GB/s"
+              << std::setw(13) << "L1 miss/pt"
+              << std::setw(13) << "LLC miss/pt" << "\n";
+    std::cout << std::string(113, '-') << "\n";
+
+    std::vector<Result> results;
+    for (size_t n : options.sizes)
+    {
+        if (n < 3)
+            continue;
+        const size_t first = results.size();
+        run_size(options, n, results);
+        for (size_t k = first; k < results.size(); ++k)
+        {
+            const Result &r = results[k];
+            std::cout << std::setw(22) << std::left << r.name << std::right
+                      << std::setw(8) << r.n
+                      << std::setw(9) << r.threads
+                      << std::setw(14) << std::fixed << std::setprecision(3) << r.median_ns_point
+                      << std::setw(14) << std::fixed << std::setprecision(3) << r.min_ns_point
+                      << std::setw(10) << std::fixed << std::setprecision(1) << r.mad_percent
+                      << std::setw(10) << std::fixed << std::setprecision(2) << r.gb_per_s;
+            for (double misses : {r.l1_misses_point, r.llc_misses_point})
+            {
+                if (misses >= 0.0)
+                    std::cout << std::setw(13) << std::fixed << std::setprecision(4) << misses;
+                else
+                    std::cout << std::setw(13) << "n/a";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    if (!options.csv.empty())
+    {
+        std::ofstream ofs(options.csv);
+        ofs << "benchmark,n,threads,ns_per_point,min_ns_per_point,mad_percent,gb_per_s,l1_misses_per_point,llc_misses_per_point\n";
+        for (const Result &r : results)
+            ofs << r.name << "," << r.n << "," << r.threads << "," << r.median_ns_point << ","
+                << r.min_ns_point << "," << r.mad_percent << "," << r.gb_per_s << ","
+                << r.l1_misses_point << "," << r.llc_misses_point << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file batch.hpp
+ * @brief Throughput mode for many small independent problems
+ *
+ * For ensembles of small problems (n <= 64) parallelizing a single solve does not pay off:
+ * a grid of a few kilobytes is too small to amortize the OpenMP barriers and the MPI
+ * messages of every iteration. The BatchSolver instead assigns whole problems to ranks
+ * and threads (problem-level parallelism), balancing the load with a work-stealing queue,
+ * and solves each problem serially on an L1/L2-resident grid with compile-time-fixed-size
+ * kernels for the common grid sizes.
+ */
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <functional>
+#include <mpi.h>
+
+namespace solver
+{
+    /**
+     * @brief Definition of one problem of the batch
+     * @note Functions take {x, y} coordinates as in the Solver class.
+     */
+    struct Problem
+    {
+        /// @brief grid size
+        size_t n;
+
+        /// @brief right-hand side of the equation
+        std::function<double(std::vector<double>)> f;
+
+        /// @brief top boundary condition
+        std::function<double(std::vector<double>)> top_bc;
+
+        /// @brief right boundary condition
+        std::function<double(std::vector<double>)> right_bc;
+
+        /// @brief bottom boundary condition
+        std::function<double(std::vector<double>)> bottom_bc;
+
+        /// @brief left boundary condition
+        std::function<double(std::vector<double>)> left_bc;
+
+        /// @brief maximum number of iterations
+        unsigned max_iter = 1000;
+
+        /// @brief tolerance for convergence
+        double tol = 1e-10;
+    };
+
+    /**
+     * @brief Result of one problem of the batch
+     */
+    struct BatchResult
+    {
+        /// @brief computed solution (size n * n)
+        std::vector<double> uh;
+
+        /// @brief number of iterations performed
+        unsigned iter = 0;
+
+        /// @brief residual at the last iteration
+        double residual = 0.0;
+    };
+
+    /**
+     * @brief Throughput statistics of the last batch
+     */
+    struct BatchStats
+    {
+        /// @brief number of problems solved by the whole batch
+        size_t problems = 0;
+
+        /// @brief wall time of the batch (maximum over the ranks)
+        double seconds = 0.0;
+
+        /// @brief problems solved per second
+        double solves_per_second = 0.0;
+
+        /// @brief number of problems stolen from another thread's queue (summed over ranks)
+        size_t steals = 0;
+    };
+
+    /**
+     * @brief Work-stealing queue of problem indices
+     * @details The owner pushes and pops at the back (LIFO, keeping its data warm),
+     *          while idle threads steal from the front. Problems are coarse-grained
+     *          (microseconds to milliseconds each), so a mutex per queue is cheap enough.
+     */
+    class WorkStealingQueue
+    {
+    public:
+        /// @brief push a task at the back of the queue (owner only)
+        void push(size_t task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(task);
+        }
+
+        /// @brief pop a task from the back of the queue (owner only)
+        /// @return false if the queue is empty
+        bool pop(size_t &task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+                return false;
+            task = tasks.back();
+            tasks.pop_back();
+            return true;
+        }
+
+        /// @brief steal a task from the front of the queue (other threads)
+        /// @return false if the queue is empty
+        bool steal(size_t &task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+                return false;
+            task = tasks.front();
+            tasks.pop_front();
+            return true;
+        }
+
+    private:
+        /// @brief indices of the problems still to be solved
+        std::deque<size_t> tasks;
+
+        /// @brief mutex protecting the queue
+        std::mutex mutex;
+    };
+
+    /**
+     * @class BatchSolver
+     * @brief Solve a batch of independent problems maximizing the number of solves per second
+     */
+    class BatchSolver
+    {
+    public:
+        /// @brief constructor
+        /// @param num_threads number of worker threads per rank (0 means all available threads)
+        /// @param comm MPI communicator among which the problems are distributed
+        explicit BatchSolver(unsigned num_threads = 0, MPI_Comm comm = MPI_COMM_WORLD)
+            : num_threads(num_threads), comm(comm)
+        {
+        }
+
+        /// @brief solve all the problems of the batch
+        /// @param problems problems to be solved (the same list on every rank)
+        /// @param root rank that receives all the results
+        /// @return results in the order of the problems on root, only the local ones elsewhere
+        /// @details problems are assigned to ranks balancing their estimated cost,
+        ///          then to threads through work-stealing queues
+        /// @throws std::invalid_argument if a problem has n < 3, before any problem is solved
+        std::vector<BatchResult> solve(const std::vector<Problem> &problems, int root = 0);
+
+        /// @brief solve a single problem serially
+        /// @param problem problem to be solved
+        /// @return result of the problem
+        /// @details uses a compile-time-fixed-size kernel when n is a common grid size
+        /// @throws std::invalid_argument if n < 3 (the grid would have no interior points)
+        static BatchResult solve_one(const Problem &problem);
+
+        /// @brief get the statistics of the last batch
+        const BatchStats &stats() const
+        {
+            return batch_stats;
+        }
+
+    private:
+        /// @brief number of worker threads per rank
+        unsigned num_threads;
+
+        /// @brief MPI communicator
+        MPI_Comm comm;
+
+        /// @brief statistics of the last batch
+        BatchStats batch_stats;
+    };
+} // namespace solver
+#endif // BATCH_HPP
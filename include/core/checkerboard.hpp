@@ -0,0 +1,117 @@
+/**
+ * @file checkerboard.hpp
+ * @brief Red/black (checkerboard) split storage of a grid for red-black Gauss-Seidel
+ *
+ * A red-black Gauss-Seidel sweep updates the points with i + j even (red) and then those with
+ * i + j odd (black): every point of a colour only depends on points of the other colour, so a
+ * colour can be updated in any order, by several threads or in the lanes of a vector. On the
+ * natural i * n + j layout a colour is every other element of a row: half of every cache line
+ * loaded is skipped and the vector loads need a shuffle or a gather. The grid below stores each
+ * colour in its own array, row by row, with the points of a colour of a row contiguous. The
+ * four neighbours of a point are then at the same index in the rows above and below of the
+ * other colour, and at two consecutive indices in the same row of the other colour, so the
+ * update of a colour is a unit-stride loop over three rows of the other colour, the rows of
+ * the updated colour and of the right-hand side. A colour sweep moves half of the grid
+ * instead of all of it. Converters split a grid in the natural layout and merge it back.
+ */
+#ifndef CHECKERBOARD_HPP
+#define CHECKERBOARD_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "huge_page_allocator.hpp"
+
+/**
+ * @namespace solver::checkerboard
+ * @brief Red/black split grids
+ */
+namespace solver::checkerboard
+{
+    /// @brief colour of the point (i, j): red if i + j is even, black otherwise
+    enum class Colour : size_t
+    {
+        Red = 0,
+        Black = 1
+    };
+
+    /// @brief the other colour
+    inline Colour other(Colour colour)
+    {
+        return (colour == Colour::Red) ? Colour::Black : Colour::Red;
+    }
+
+    /// @brief column of the first point of a colour in row i (point q of the row is at column 2 q + offset)
+    inline size_t offset(Colour colour, size_t i)
+    {
+        return (i + static_cast<size_t>(colour)) & 1;
+    }
+
+    /**
+     * @brief n x n grid stored as two arrays, one per colour
+     * @details row i of a colour holds the points of that colour of row i of the grid, the point of
+     *          column j at index j / 2. The (n + 1) / 2 values of a row are padded to an odd number
+     *          of cache lines, and the black values start one row into their buffer: with huge pages
+     *          both buffers start on a 2 MB boundary, and row i of both colours, read together by a
+     *          colour sweep, would otherwise map to the same cache sets.
+     */
+    class Grid
+    {
+    public:
+        /// @brief build a grid of zeros
+        /// @param n number of rows and columns
+        explicit Grid(size_t n = 0);
+
+        /// @brief number of rows and columns
+        size_t size() const { return n; };
+
+        /// @brief number of values of a row of a colour (padding included)
+        size_t width() const { return half; };
+
+        /// @brief row i of a colour
+        double *row(Colour colour, size_t i) { return data(colour) + i * half; };
+        const double *row(Colour colour, size_t i) const { return data(colour) + i * half; };
+
+        /// @brief values of a colour
+        double *data(Colour colour) { return (colour == Colour::Red) ? red.data() : black.data() + half; };
+        const double *data(Colour colour) const { return (colour == Colour::Red) ? red.data() : black.data() + half; };
+
+        /// @brief value of the point (i, j)
+        double at(size_t i, size_t j) const { return row(static_cast<Colour>((i + j) & 1), i)[j / 2]; };
+
+        /// @brief copy a grid in the natural layout
+        /// @param natural n * n values, point (i, j) at i * n + j
+        void split(const double *natural);
+
+        /// @brief copy the grid to the natural layout
+        /// @param natural n * n values, point (i, j) at i * n + j
+        void merge(double *natural) const;
+
+    private:
+        /// @brief number of rows and columns
+        size_t n;
+
+        /// @brief stride between the rows of a colour (values)
+        size_t half;
+
+        /// @brief values of the red and of the black points (after a row of padding)
+        std::vector<double, memory::HugePageAllocator<double>> red, black;
+    };
+
+    /// @brief Gauss-Seidel update of the interior points of a colour on the rows [first, last)
+    /// @param u grid to be updated, the boundary is Dirichlet data
+    /// @param rhs h^2 f at every grid point, in the same layout
+    /// @param colour colour of the points updated
+    /// @param first first row (at least 1)
+    /// @param last one past the last row (at most n - 1)
+    /// @return sum of the squared differences between the new and the old values
+    /// @details the points of a colour are independent, so disjoint row ranges can be updated concurrently
+    double sweep(Grid &u, const Grid &rhs, Colour colour, size_t first, size_t last);
+
+    /// @brief red-black Gauss-Seidel sweep over the interior: the red points, then the black ones
+    /// @param u grid to be updated, the boundary is Dirichlet data
+    /// @param rhs h^2 f at every grid point, in the same layout
+    /// @return sum of the squared differences between the new and the old values
+    double sweep(Grid &u, const Grid &rhs);
+} // namespace solver::checkerboard
+#endif // CHECKERBOARD_HPP
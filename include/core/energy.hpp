@@ -0,0 +1,110 @@
+/**
+ * @file energy.hpp
+ * @brief Energy-to-solution from the RAPL counters of the Linux powercap interface
+ *
+ * Comparing configurations on time alone ignores that a run is billed for energy as well:
+ * four processes may finish sooner than two threads and still cost more joules. The
+ * processors of Intel and AMD count the energy of every package (RAPL); Linux exposes the
+ * counters in /sys/class/powercap/intel-rapl:<k>/energy_uj. The measurement below reads the
+ * counters of all the packages of the node at the start and at the end of a solve, and
+ * handles their wrap-around. The counters are updated about every millisecond, which is
+ * longer than most phases of an iteration, so the energy of a phase is not read around it
+ * but attributed in proportion to the time spent in it by all the threads of the team. The counters cover the whole node:
+ * the processes of a node measure the same energy, which must be counted once per node.
+ * When the counters are missing or not readable (often root only), the energy is reported
+ * as unavailable and only the time is measured.
+ */
+#ifndef ENERGY_HPP
+#define ENERGY_HPP
+
+#include <vector>
+#include <string>
+
+#include "trace.hpp"
+
+/**
+ * @namespace solver::energy
+ * @brief RAPL energy measurements
+ */
+namespace solver::energy
+{
+    /// @brief powercap zone of a RAPL domain
+    struct Zone
+    {
+        /// @brief name of the domain (package-0, ...)
+        std::string name;
+
+        /// @brief file of the energy counter (microjoules)
+        std::string counter;
+
+        /// @brief value at which the counter wraps around (microjoules)
+        double max_range;
+    };
+
+    /// @brief RAPL domains measured: the packages of the node, or the platform (psys) if there is no
+    ///        package; empty if the counters are not available. Discovered on the first call.
+    const std::vector<Zone> &zones();
+
+    /// @brief whether the energy can be measured
+    bool available();
+
+    /// @brief current value of the counter of every zone (microjoules)
+    std::vector<double> read();
+
+    /// @brief energy between two readings of the counters (joules), assuming at most one wrap-around
+    double joules(const std::vector<double> &begin, const std::vector<double> &end);
+
+    /// @brief energy and time of a solve
+    struct Report
+    {
+        /// @brief energy of the node during the solve (joules), negative if unavailable
+        double joules = -1.0;
+
+        /// @brief duration of the solve (seconds)
+        double seconds = 0.0;
+
+        /// @brief time spent in each phase by the threads of the process, summed (thread-seconds, indexed by trace::Phase)
+        double phase_seconds[trace::phase_count] = {};
+
+        /// @brief energy attributed to each phase in proportion to its share of the time of the team
+        ///        (joules, 0 if unavailable)
+        double phase_joules[trace::phase_count] = {};
+
+        /// @brief average power of the node during the solve (watts, 0 if unavailable)
+        double watts() const { return (joules >= 0.0 && seconds > 0.0) ? joules / seconds : 0.0; };
+    };
+
+    /**
+     * @brief RAII measurement of the energy and the time from its construction to its destruction
+     * @details the phases are timed by the trace scopes of every thread of the process, which read the
+     *          clock while a measurement is alive (and the counters are available); a solve on a team
+     *          of threads has seconds x threads of thread time to share among the phases
+     */
+    class Measurement
+    {
+    public:
+        /// @brief start measuring
+        /// @param report written when the measurement ends
+        /// @param threads number of threads of the team of the solve
+        explicit Measurement(Report &report, unsigned threads = 1);
+
+        /// @brief stop measuring and write the report
+        ~Measurement();
+
+        Measurement(const Measurement &) = delete;
+        Measurement &operator=(const Measurement &) = delete;
+
+    private:
+        /// @brief report of the measurement
+        Report &report;
+
+        /// @brief number of threads of the team
+        unsigned threads;
+
+        /// @brief counters, time and phase times at the start
+        std::vector<double> begin_counters;
+        double begin_time;
+        double begin_phase[trace::phase_count];
+    };
+} // namespace solver::energy
+#endif // ENERGY_HPP
@@ -0,0 +1,129 @@
+/**
+ * @file footprint.hpp
+ * @brief Memory footprint of the solves: measurement and prediction
+ *
+ * Large grids run out of memory before they run out of time. Every MPI method keeps the
+ * full n x n grid on every rank, as source of the scatter and target of the gather, on top
+ * of the local slab; the direct method adds the previous slab and the sparse factorization,
+ * and CG its work vectors. The functions below measure the memory of a solve in two ways:
+ * - the bytes reserved by the grid buffers, counted by the grid allocator (exact, but
+ *   blind to the other allocations, such as the Eigen factorization);
+ * - the high-water mark of the resident set of the process (VmHWM of /proc/self/status),
+ *   which sees everything but counts the pages actually touched only. It is restarted at
+ *   the start of every solve through /proc/self/clear_refs when the kernel allows it.
+ * A predictor gives the bytes a method will need on a rank from the size of its slab, and
+ * the processes of a node compare their total with the available memory of the node, so
+ * that a configuration that would not fit is reported before it allocates.
+ * The measurement and the check cost procfs accesses and collectives on every solve, so the
+ * Solver only runs them on request (Solver::set_memory_check); the prediction is always made.
+ */
+#ifndef FOOTPRINT_HPP
+#define FOOTPRINT_HPP
+
+#include <cstddef>
+#include <string>
+#include <mpi.h>
+
+/**
+ * @namespace solver::footprint
+ * @brief Memory accounting of the solves
+ */
+namespace solver::footprint
+{
+    /// @brief high-water mark of the resident set of the process (bytes, 0 if unknown)
+    size_t rss_high_water();
+
+    /// @brief restart the high-water mark of the resident set from the current resident set
+    /// @return whether the kernel accepted the reset
+    bool reset_rss_high_water();
+
+    /// @brief memory available for new allocations on the node (MemAvailable, bytes, 0 if unknown)
+    size_t available_memory();
+
+    /// @brief memory needed by a solve on a rank
+    struct Prediction
+    {
+        /// @brief bytes of the grid buffers (counted by the grid allocator)
+        size_t grid_bytes = 0;
+
+        /// @brief bytes of the other buffers: row buffers, work vectors, sparse factorization
+        size_t work_bytes = 0;
+
+        /// @brief total bytes
+        size_t total() const { return grid_bytes + work_bytes; };
+    };
+
+    /// @brief predict the memory of a solve on a rank
+    /// @param method name of the method (jacobi_serial, jacobi_mpi, direct_mpi, cg_mpi, ...)
+    /// @param n size of the grid
+    /// @param local_rows rows of the slab of the rank, ghost rows included (n for the shared-memory methods)
+    /// @param threads number of threads (row buffers of each thread)
+    /// @param recycle number of vectors recycled by CG
+    /// @details the factorization of the direct method is estimated from the fill of the AMD ordering
+    ///          of a grid, an approximation: the resident set of the solve shows the actual memory
+    Prediction predict(const std::string &method, size_t n, size_t local_rows, unsigned threads = 1, size_t recycle = 0);
+
+    /// @brief warn if the processes of a node would exceed the available memory (collective over comm)
+    /// @param method name of the method, for the message
+    /// @param prediction memory of the solve on the calling rank
+    /// @param comm communicator of the solve, or MPI_COMM_NULL for a solve of this process alone
+    /// @return whether the memory still needed on the node fits in the available memory
+    /// @details the bytes already reserved by the grid buffers (the global grid) are not needed again.
+    ///          The warning is printed on std::cerr by the first rank of the node. The communicator
+    ///          of the node is built on the first check on comm and cached on it as an attribute.
+    bool check(const std::string &method, const Prediction &prediction, MPI_Comm comm);
+
+    /// @brief memory of a solve
+    struct Report
+    {
+        /// @brief bytes predicted for the calling rank
+        Prediction predicted;
+
+        /// @brief whether the fields below were measured
+        bool measured = false;
+
+        /// @brief high-water mark of the bytes reserved by the grid buffers during the solve
+        size_t grid_peak_bytes = 0;
+
+        /// @brief high-water mark of the resident set (0 if unknown)
+        size_t rss_peak_bytes = 0;
+
+        /// @brief whether rss_peak_bytes covers the solve only (otherwise the whole life of the process)
+        bool rss_of_solve = false;
+    };
+
+    /**
+     * @brief RAII measurement of the memory from its construction to its destruction
+     * @details measurements nest: a solve calling another solve (solve_lifting calls solve_jacobi_omp)
+     *          only measures in the outermost scope, so the inner one does not restart the high-water
+     *          marks nor overwrite the report
+     */
+    class Measurement
+    {
+    public:
+        /// @brief restart the high-water marks and clear the report (outermost scope only)
+        /// @param report written when the measurement ends (the prediction is set by the solve)
+        /// @param enabled whether to measure; otherwise the report is only cleared
+        explicit Measurement(Report &report, bool enabled = true);
+
+        /// @brief read the high-water marks into the report (outermost scope only)
+        ~Measurement();
+
+        Measurement(const Measurement &) = delete;
+        Measurement &operator=(const Measurement &) = delete;
+
+    private:
+        /// @brief report of the measurement
+        Report &report;
+
+        /// @brief whether this is the outermost measurement of the calling thread
+        bool outermost;
+
+        /// @brief whether to measure
+        bool enabled;
+    };
+
+    /// @brief whether the calling thread is inside a measurement nested in another one
+    bool nested();
+} // namespace solver::footprint
+#endif // FOOTPRINT_HPP
@@ -0,0 +1,341 @@
+/**
+ * @file huge_page_allocator.hpp
+ * @brief Allocator for the grid buffers with optional huge page backing
+ *
+ * For large grids the three-row access pattern of the stencil touches a new
+ * 4 KB page every few hundred points, so the TLB misses constantly. This header
+ * provides a standard-conforming allocator that backs large buffers with huge pages:
+ * - hugetlbfs pages (2 MB or 1 GB) through mmap with MAP_HUGETLB,
+ * - transparent huge pages through madvise(MADV_HUGEPAGE),
+ * - regular pages as a fallback.
+ *
+ * Every buffer is prefixed by a small header that records how it was obtained,
+ * so that the backing and the resulting page size can be queried at any time.
+ * The bytes reserved by the live buffers and their high-water mark are counted,
+ * so the memory of the grids of a solve can be measured (see footprint.hpp).
+ */
+#ifndef HUGE_PAGE_ALLOCATOR_HPP
+#define HUGE_PAGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <fstream>
+#include <atomic>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @namespace solver::memory
+ * @brief Memory management utilities for the grid buffers
+ */
+namespace solver::memory
+{
+    /// @brief how large buffers should be backed
+    enum class PagePolicy
+    {
+        Standard,    ///< regular pages, allocated on the heap
+        Transparent, ///< anonymous mapping with madvise(MADV_HUGEPAGE)
+        HugeTLB2M,   ///< hugetlbfs 2 MB pages, falling back to transparent huge pages
+        HugeTLB1G    ///< hugetlbfs 1 GB pages, falling back to 2 MB pages
+    };
+
+    /// @brief how a buffer has actually been backed
+    enum class Backing : int
+    {
+        Heap,        ///< operator new, regular pages
+        Mapped,      ///< anonymous mapping with regular pages (huge pages unavailable)
+        Transparent, ///< anonymous mapping advised to use transparent huge pages
+        HugeTLB      ///< hugetlbfs pages
+    };
+
+    /// @brief information about the backing of a buffer
+    struct PageInfo
+    {
+        /// @brief page size backing the buffer in bytes
+        size_t page_size = 0;
+
+        /// @brief how the buffer has been obtained
+        Backing backing = Backing::Heap;
+
+        /// @brief true if the requested policy could not be satisfied
+        bool fallback = false;
+
+        /// @brief human readable description of the backing
+        std::string describe() const
+        {
+            std::string name;
+            switch (backing)
+            {
+            case Backing::Heap:
+                name = "heap";
+                break;
+            case Backing::Mapped:
+                name = "mmap";
+                break;
+            case Backing::Transparent:
+                name = "THP";
+                break;
+            case Backing::HugeTLB:
+                name = "hugetlbfs";
+                break;
+            }
+            const size_t kb = page_size / 1024;
+            std::string size = (kb >= 1024 * 1024) ? std::to_string(kb / (1024 * 1024)) + " GB"
+                               : (kb >= 1024)      ? std::to_string(kb / 1024) + " MB"
+                                                   : std::to_string(kb) + " KB";
+            return name + " (" + size + " pages" + (fallback ? ", fallback" : "") + ")";
+        }
+    };
+
+    /// @brief buffers smaller than this are always allocated on the heap
+    inline constexpr size_t huge_page_threshold = size_t{2} << 20;
+
+    /// @brief size of the header in front of each buffer (keeps 64-byte alignment)
+    inline constexpr size_t header_size = 64;
+
+    /// @brief header stored in front of each buffer
+    struct Header
+    {
+        /// @brief start of the mapping (or of the heap block)
+        void *base;
+        /// @brief length of the mapping in bytes
+        size_t length;
+        /// @brief backing information
+        PageInfo info;
+    };
+    static_assert(sizeof(Header) <= header_size, "header does not fit in front of the buffer");
+
+    /// @brief policy used for new allocations
+    inline std::atomic<PagePolicy> page_policy{PagePolicy::Transparent};
+
+    /// @brief set the policy used for new large allocations
+    /// @param policy page policy
+    inline void set_page_policy(PagePolicy policy)
+    {
+        page_policy.store(policy);
+    }
+
+    /// @brief get the policy used for new large allocations
+    inline PagePolicy get_page_policy()
+    {
+        return page_policy.load();
+    }
+
+    /// @brief bytes reserved by the live buffers (headers and rounding to the pages included)
+    inline std::atomic<size_t> allocated_bytes{0};
+
+    /// @brief high-water mark of allocated_bytes since the last reset_peak
+    inline std::atomic<size_t> peak_allocated_bytes{0};
+
+    /// @brief bytes currently reserved by the grid buffers
+    inline size_t allocated()
+    {
+        return allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    /// @brief high-water mark of the bytes reserved by the grid buffers
+    inline size_t peak_allocated()
+    {
+        return peak_allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    /// @brief restart the high-water mark from the bytes currently reserved
+    inline void reset_peak()
+    {
+        peak_allocated_bytes.store(allocated(), std::memory_order_relaxed);
+    }
+
+    /// @brief record a reservation of length bytes
+    inline void account(size_t length)
+    {
+        const size_t now = allocated_bytes.fetch_add(length, std::memory_order_relaxed) + length;
+        size_t peak = peak_allocated_bytes.load(std::memory_order_relaxed);
+        while (now > peak && !peak_allocated_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+            ;
+    }
+
+    /// @brief size of a regular page in bytes
+    inline size_t base_page_size()
+    {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    /// @brief check whether the kernel honours madvise(MADV_HUGEPAGE)
+    /// @details reads /sys/kernel/mm/transparent_hugepage/enabled, where the active
+    ///          mode is enclosed in square brackets
+    inline bool transparent_huge_pages_available()
+    {
+        static const bool available = []
+        {
+            std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+            std::string line;
+            if (!std::getline(file, line))
+                return false;
+            return line.find("[never]") == std::string::npos;
+        }();
+        return available;
+    }
+
+    /// @brief round size up to a multiple of alignment
+    inline size_t round_up(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    /// @brief bytes reserved by allocate for a buffer of the given size with the current policy
+    /// @details the length of the mapping if huge pages are obtained; a hugetlbfs 1 GB request
+    ///          that falls back to smaller pages reserves less
+    inline size_t reserved_bytes(size_t bytes)
+    {
+        const size_t total = bytes + header_size;
+        const PagePolicy policy = get_page_policy();
+        if (policy == PagePolicy::Standard || total < huge_page_threshold)
+            return total;
+        return round_up(total, (policy == PagePolicy::HugeTLB1G) ? size_t{1} << 30 : huge_page_threshold);
+    }
+
+    /// @brief try to map length bytes with hugetlbfs pages of the given size
+    /// @return start of the mapping, or nullptr if no huge pages are available
+    inline void *map_hugetlb(size_t length, size_t page_size)
+    {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+        int log2_size = 0;
+        while ((size_t{1} << log2_size) < page_size)
+            ++log2_size;
+        void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2_size << MAP_HUGE_SHIFT), -1, 0);
+        return (ptr == MAP_FAILED) ? nullptr : ptr;
+#else
+        (void)length;
+        (void)page_size;
+        return nullptr;
+#endif
+    }
+
+    /// @brief map length bytes aligned to alignment with regular pages
+    /// @return start of the mapping, or nullptr on failure
+    inline void *map_aligned(size_t length, size_t alignment)
+    {
+        // Over-allocate and trim, so that the buffer starts on a huge page boundary
+        const size_t padded = length + alignment;
+        void *raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            return nullptr;
+        const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (start + alignment - 1) / alignment * alignment;
+        if (aligned > start)
+            munmap(raw, aligned - start);
+        const size_t tail = padded - (aligned - start) - length;
+        if (tail > 0)
+            munmap(reinterpret_cast<void *>(aligned + length), tail);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    /// @brief allocate bytes according to the current page policy
+    /// @param bytes number of bytes requested
+    /// @return pointer to a 64-byte aligned buffer
+    inline void *allocate(size_t bytes)
+    {
+        const size_t total = bytes + header_size;
+        const PagePolicy policy = get_page_policy();
+
+        Header header{nullptr, 0, {}};
+
+        if (policy == PagePolicy::Standard || total < huge_page_threshold)
+        {
+            header.base = ::operator new(total, std::align_val_t{header_size});
+            header.length = total;
+            header.info = {base_page_size(), Backing::Heap, false};
+        }
+        else
+        {
+            // Try hugetlbfs first, from the largest requested page size down to 2 MB
+            if (policy == PagePolicy::HugeTLB1G)
+            {
+                const size_t length = round_up(total, size_t{1} << 30);
+                if ((header.base = map_hugetlb(length, size_t{1} << 30)) != nullptr)
+                    header = {header.base, length, {size_t{1} << 30, Backing::HugeTLB, false}};
+            }
+            if (header.base == nullptr && (policy == PagePolicy::HugeTLB1G || policy == PagePolicy::HugeTLB2M))
+            {
+                const size_t length = round_up(total, huge_page_threshold);
+                if ((header.base = map_hugetlb(length, huge_page_threshold)) != nullptr)
+                    header = {header.base, length, {huge_page_threshold, Backing::HugeTLB, policy == PagePolicy::HugeTLB1G}};
+            }
+            // Then transparent huge pages, finally regular pages
+            if (header.base == nullptr)
+            {
+                const size_t length = round_up(total, huge_page_threshold);
+                header.base = map_aligned(length, huge_page_threshold);
+                if (header.base == nullptr)
+                    throw std::bad_alloc();
+                header.length = length;
+                if (transparent_huge_pages_available() && madvise(header.base, length, MADV_HUGEPAGE) == 0)
+                    header.info = {huge_page_threshold, Backing::Transparent, policy != PagePolicy::Transparent};
+                else
+                    header.info = {base_page_size(), Backing::Mapped, true};
+            }
+        }
+
+        new (header.base) Header(header);
+        account(header.length);
+        return static_cast<char *>(header.base) + header_size;
+    }
+
+    /// @brief release a buffer obtained with allocate
+    /// @param ptr pointer returned by allocate
+    inline void deallocate(void *ptr)
+    {
+        if (ptr == nullptr)
+            return;
+        Header *header = reinterpret_cast<Header *>(static_cast<char *>(ptr) - header_size);
+        const Header copy = *header;
+        header->~Header();
+        allocated_bytes.fetch_sub(copy.length, std::memory_order_relaxed);
+        if (copy.info.backing == Backing::Heap)
+            ::operator delete(copy.base, std::align_val_t{header_size});
+        else
+            munmap(copy.base, copy.length);
+    }
+
+    /// @brief query how a buffer obtained with allocate is backed
+    /// @param ptr pointer returned by allocate (nullptr gives a default PageInfo)
+    inline PageInfo page_info(const void *ptr)
+    {
+        if (ptr == nullptr)
+            return {};
+        return reinterpret_cast<const Header *>(static_cast<const char *>(ptr) - header_size)->info;
+    }
+
+    /**
+     * @brief Allocator for grid buffers, backed by huge pages when they are large enough
+     * @tparam T value type
+     */
+    template <typename T>
+    struct HugePageAllocator
+    {
+        using value_type = T;
+
+        HugePageAllocator() noexcept = default;
+
+        template <typename U>
+        HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+        T *allocate(size_t count)
+        {
+            return static_cast<T *>(memory::allocate(count * sizeof(T)));
+        }
+
+        void deallocate(T *ptr, size_t) noexcept
+        {
+            memory::deallocate(ptr);
+        }
+
+        template <typename U>
+        bool operator==(const HugePageAllocator<U> &) const noexcept { return true; }
+    };
+} // namespace solver::memory
+#endif // HUGE_PAGE_ALLOCATOR_HPP
@@ -0,0 +1,237 @@
+/**
+ * @file kernels.hpp
+ * @brief Low-level stencil kernels shared by the Solver implementations
+ *
+ * The kernels work on flattened row-major grids with n columns and only
+ * take raw buffers and a callable for the right-hand side, so that they can be
+ * reused by every parallelization strategy (serial, OpenMP, MPI and hybrid).
+ */
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @namespace solver::kernels
+ * @brief Stencil kernels operating on raw grid buffers
+ */
+namespace solver::kernels
+{
+    /// @brief split the rows [begin, end) into nparts contiguous strips
+    /// @param begin first row
+    /// @param end one past the last row
+    /// @param part index of the strip
+    /// @param nparts number of strips
+    /// @param first first row of the strip (output)
+    /// @param last one past the last row of the strip (output)
+    inline void strip_bounds(size_t begin, size_t end, size_t part, size_t nparts, size_t &first, size_t &last)
+    {
+        const size_t rows = end - begin;
+        const size_t count = rows / nparts;
+        const size_t remainder = rows % nparts;
+        first = begin + part * count + std::min(part, remainder);
+        last = first + count + (part < remainder ? 1 : 0);
+    }
+
+    /// @brief in-place Jacobi sweep over the rows [first, last) of a grid with n columns
+    /// @details Jacobi only needs the old values of the neighbouring rows, so instead of
+    ///          copying the whole grid we keep a rolling buffer with the old values of
+    ///          the row above and of the row being updated.
+    ///          Columns 0 and n - 1 are treated as Dirichlet data and are never written.
+    /// @param grid pointer to the first element of row 0 of the grid
+    /// @param n number of columns
+    /// @param first first row to update
+    /// @param last one past the last row to update
+    /// @param above old values of row first - 1 on input, used as rolling buffer (size n)
+    /// @param current rolling buffer (size n)
+    /// @param below old values of row last; it must not alias a row updated concurrently
+    /// @param rhs callable such that rhs(i, j) returns h^2 f at row i and column j
+    /// @return sum of the squared differences between the new and the old values
+    template <typename Rhs>
+    inline double jacobi_sweep_inplace(double *grid, size_t n, size_t first, size_t last,
+                                       std::vector<double> &above, std::vector<double> &current,
+                                       const double *below, Rhs &&rhs)
+    {
+        double diff{0.0};
+        for (size_t i = first; i < last; ++i)
+        {
+            double *row = grid + i * n;
+            std::copy(row, row + n, current.begin());
+
+            // Row i + 1 is still untouched unless it belongs to another strip
+            const double *next = (i + 1 == last) ? below : row + n;
+
+            for (size_t j = 1; j < n - 1; ++j)
+            {
+                const double value = 0.25 * (above[j] + next[j] + current[j - 1] + current[j + 1] + rhs(i, j));
+                const double delta = value - current[j];
+                diff += delta * delta;
+                row[j] = value;
+            }
+
+            // The old values of row i become the old values of the row above
+            std::swap(above, current);
+        }
+        return diff;
+    }
+
+    /// @brief Gauss-Seidel update of the interior point k of a grid with n columns
+    /// @param grid grid to be updated
+    /// @param n number of columns
+    /// @param rhs h^2 f at every grid point
+    /// @param k flat index of the point, which must not lie on the boundary
+    /// @return difference between the new and the old value
+    inline double gauss_seidel_point(double *__restrict grid, size_t n, const double *__restrict rhs, size_t k)
+    {
+        const double value = 0.25 * (grid[k - n] + grid[k + n] + grid[k - 1] + grid[k + 1] + rhs[k]);
+        const double delta = value - grid[k];
+        grid[k] = value;
+        return delta;
+    }
+
+    /// @brief lexicographic Gauss-Seidel sweep over the interior of an n x n grid
+    /// @details unlike Jacobi, the new values of the row above and of the point on the
+    ///          left are used as soon as they are available, so no buffer is needed
+    /// @param grid grid to be updated (size n * n), the boundary is Dirichlet data
+    /// @param n number of rows and columns
+    /// @param rhs h^2 f at every grid point (size n * n)
+    /// @return sum of the squared differences between the new and the old values
+    inline double gauss_seidel_sweep(double *__restrict grid, size_t n, const double *__restrict rhs)
+    {
+        double diff{0.0};
+        for (size_t i = 1; i < n - 1; ++i)
+        {
+            for (size_t j = 1; j < n - 1; ++j)
+            {
+                const double delta = gauss_seidel_point(grid, n, rhs, i * n + j);
+                diff += delta * delta;
+            }
+        }
+        return diff;
+    }
+
+    /// @brief red-black Gauss-Seidel sweep over the interior of an n x n grid in the natural layout
+    /// @details the points with i + j even are updated first, then those with i + j odd; every
+    ///          colour pass reads every other element of the rows (see checkerboard.hpp for the
+    ///          split layout with unit stride)
+    /// @param grid grid to be updated (size n * n), the boundary is Dirichlet data
+    /// @param n number of rows and columns
+    /// @param rhs h^2 f at every grid point (size n * n)
+    /// @return sum of the squared differences between the new and the old values
+    inline double red_black_sweep(double *__restrict grid, size_t n, const double *__restrict rhs)
+    {
+        double diff{0.0};
+        for (size_t colour = 0; colour < 2; ++colour)
+        {
+            for (size_t i = 1; i < n - 1; ++i)
+            {
+                for (size_t j = 2 - ((i + colour) & 1); j < n - 1; j += 2)
+                {
+                    const double delta = gauss_seidel_point(grid, n, rhs, i * n + j);
+                    diff += delta * delta;
+                }
+            }
+        }
+        return diff;
+    }
+
+    /// @brief full-weighting restriction of an n x n grid to a (n + 1) / 2 x (n + 1) / 2 grid (n odd)
+    /// @details coarse point (I, J) lies on fine point (2 I, 2 J) and takes the weights 1/4, 1/2, 1/4
+    ///          of its 3 x 3 fine neighbourhood in each direction; the boundary is injected.
+    ///          See tiled.hpp for the same kernel on tiled grids.
+    /// @param fine fine grid (size n * n)
+    /// @param n number of rows and columns of the fine grid
+    /// @param coarse coarse grid (size ((n + 1) / 2)^2)
+    inline void restrict_full_weighting(const double *__restrict fine, size_t n, double *__restrict coarse)
+    {
+        const size_t nc = (n + 1) / 2;
+        for (size_t I = 0; I < nc; ++I)
+        {
+            const double *above = fine + (2 * I - (I > 0)) * n, *middle = fine + 2 * I * n, *below = middle + (I + 1 < nc) * n;
+            for (size_t J = 0; J < nc; ++J)
+            {
+                const size_t j = 2 * J;
+                if (I == 0 || I == nc - 1 || J == 0 || J == nc - 1)
+                    coarse[I * nc + J] = middle[j];
+                else
+                    coarse[I * nc + J] = 0.0625 * (4.0 * middle[j] + 2.0 * (above[j] + below[j] + middle[j - 1] + middle[j + 1]) +
+                                                   above[j - 1] + above[j + 1] + below[j - 1] + below[j + 1]);
+            }
+        }
+    }
+
+    /// @brief add the bilinear interpolation of a (n + 1) / 2 x (n + 1) / 2 grid to the interior of an n x n grid (n odd)
+    /// @param coarse coarse grid (size ((n + 1) / 2)^2)
+    /// @param n number of rows and columns of the fine grid
+    /// @param fine fine grid (size n * n)
+    inline void prolong_bilinear(const double *__restrict coarse, size_t n, double *__restrict fine)
+    {
+        const size_t nc = (n + 1) / 2;
+        for (size_t i = 1; i < n - 1; ++i)
+        {
+            const double *top = coarse + (i / 2) * nc, *bottom = coarse + ((i + 1) / 2) * nc;
+            double *row = fine + i * n;
+            for (size_t j = 1; j < n - 1; ++j)
+            {
+                const size_t J = j / 2;
+                const double left = 0.5 * (top[J] + bottom[J]);
+                row[j] += (j & 1) ? 0.5 * (left + 0.5 * (top[J + 1] + bottom[J + 1])) : left;
+            }
+        }
+    }
+
+    /// @brief sum of the squared differences between two arrays
+    /// @param a first array
+    /// @param b second array
+    /// @param count number of elements
+    /// @return sum over k of (a[k] - b[k])^2
+    inline double squared_difference(const double *__restrict a, const double *__restrict b, size_t count)
+    {
+        double sum{0.0};
+        for (size_t k = 0; k < count; ++k)
+        {
+            const double delta = a[k] - b[k];
+            sum += delta * delta;
+        }
+        return sum;
+    }
+
+    /// @brief in-place Jacobi sweep on a whole n x n grid whose size is known at compile time
+    /// @details Same update as jacobi_sweep_inplace, but with the loop bounds fixed at compile
+    ///          time and the rolling buffers on the stack, so that small grids stay in L1/L2
+    ///          and the compiler can fully vectorize and unroll the inner loop.
+    /// @tparam N number of rows and columns of the grid
+    /// @param grid grid to be updated (size N * N), rows 0 and N - 1 are Dirichlet data
+    /// @param rhs h^2 f at every grid point (size N * N)
+    /// @return sum of the squared differences between the new and the old values
+    template <size_t N>
+    inline double jacobi_sweep_fixed(double *__restrict grid, const double *__restrict rhs)
+    {
+        static_assert(N >= 3, "the grid must have at least one interior point");
+        double rows[2][N];
+        double *above = rows[0];
+        double *current = rows[1];
+        std::copy(grid, grid + N, above);
+
+        double diff{0.0};
+        for (size_t i = 1; i < N - 1; ++i)
+        {
+            double *row = grid + i * N;
+            const double *next = row + N;
+            const double *f = rhs + i * N;
+            std::copy(row, row + N, current);
+            for (size_t j = 1; j < N - 1; ++j)
+            {
+                const double value = 0.25 * (above[j] + next[j] + current[j - 1] + current[j + 1] + f[j]);
+                const double delta = value - current[j];
+                diff += delta * delta;
+                row[j] = value;
+            }
+            std::swap(above, current);
+        }
+        return diff;
+    }
+} // namespace solver::kernels
+#endif // KERNELS_HPP
@@ -0,0 +1,72 @@
+/**
+ * @file lifting.hpp
+ * @brief Discrete harmonic lifting of Dirichlet data
+ *
+ * The solution of the discrete Poisson problem is the sum of the solution with
+ * homogeneous Dirichlet data and of the discrete harmonic function taking the
+ * boundary values. The latter is known in closed form for the 5-point stencil:
+ * data on the top side with sine coefficients c_p extends to
+ *
+ *     u(i, j) = sum_p c_p s_p(i) sin(p pi j / (n - 1)),   cosh(lambda_p) = 2 - cos(p pi / (n - 1)),
+ *
+ * where s_p(d) = sinh(lambda_p (n - 1 - d)) / sinh(lambda_p (n - 1)) is the response of mode p
+ * at distance d from the side, and similarly for the other sides. The responses only
+ * depend on n, so they are computed once; a new set of boundary conditions then costs
+ * a sine transform per side and one per grid row and column, O(n^2 log n) in total.
+ */
+#ifndef LIFTING_HPP
+#define LIFTING_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace solver
+{
+    /**
+     * @class HarmonicLifting
+     * @brief Discrete harmonic extension of boundary data on an n x n grid, by superposition of sine modes
+     */
+    class HarmonicLifting
+    {
+    public:
+        /// @brief precompute the responses to the sine modes of a side
+        /// @param n number of rows and columns of the grid (n >= 3)
+        explicit HarmonicLifting(size_t n);
+
+        /// @brief number of rows and columns of the grid
+        size_t size() const { return n; }
+
+        /// @brief add to u the discrete harmonic function with the given boundary values
+        /// @param top values on row 0, indexed by column (size n)
+        /// @param right values on column n - 1, indexed by row (size n)
+        /// @param bottom values on row n - 1, indexed by column (size n)
+        /// @param left values on column 0, indexed by row (size n)
+        /// @param u grid of n x n values (row-major); only the interior is updated
+        /// @details the corners do not enter the 5-point stencil, so only the values at
+        ///          the interior points of each side are used
+        void apply(const std::vector<double> &top, const std::vector<double> &right,
+                   const std::vector<double> &bottom, const std::vector<double> &left, double *u) const;
+
+    private:
+        /// @brief number of rows and columns of the grid
+        size_t n;
+
+        /// @brief number of interior points of a side, and of sine modes
+        size_t m;
+
+        /// @brief response of the modes, profile[d * m + p - 1] = s_p(d), for d = 0, ..., n - 1
+        std::vector<double> profile;
+    };
+
+    /// @brief add to u the solution of the 5-point Poisson problem with homogeneous Dirichlet data
+    /// @details solves 4 u(i, j) - u(i - 1, j) - u(i + 1, j) - u(i, j - 1) - u(i, j + 1) = rhs(i, j)
+    ///          on the interior of an n x n grid with a sine transform in each direction, in
+    ///          O(n^2 log n); the rows of rhs that are zero are skipped by the first transform, and
+    ///          with few non-zero rows the transforms along the columns are direct sums over them
+    ///          (for the change of the equations in Solver::solve_incremental)
+    /// @param n number of rows and columns of the grid (n >= 3)
+    /// @param rhs right-hand side (h^2 f) at every grid point, only the interior is read
+    /// @param u grid of n x n values (row-major); only the interior is updated
+    void add_dirichlet_solution(size_t n, const double *rhs, double *u);
+} // namespace solver
+#endif // LIFTING_HPP
@@ -0,0 +1,84 @@
+/**
+ * @file probe.hpp
+ * @brief Interpolation of a grid function at arbitrary points
+ *
+ * Post-processing (sensor locations, line plots) needs the solution at points that are not
+ * grid nodes, often millions of them. The kernels below interpolate a block of rows of the
+ * grid at a batch of points, in a loop without branches that the compiler vectorizes (the
+ * loads of the stencil become gathers). For a grid distributed by rows, each process passes
+ * its own points; they are sent to the process owning their cell, interpolated there and
+ * returned in the order of the caller, so the grid is never collected on a single process.
+ */
+#ifndef PROBE_HPP
+#define PROBE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <mpi.h>
+
+/**
+ * @namespace solver::probe
+ * @brief Interpolation of grid functions at arbitrary points
+ */
+namespace solver::probe
+{
+    /// @brief interpolation method
+    enum class Method
+    {
+        Bilinear, ///< bilinear on the cell of the point, 2 x 2 nodes
+        Bicubic   ///< Catmull-Rom (cubic convolution) on 4 x 4 nodes, C1 across the cells
+    };
+
+    /// @brief number of rows beyond its own that a process must hold for any method
+    constexpr size_t halo = 2;
+
+    /// @brief first row of the cell containing a point
+    /// @param x coordinate along the rows, in [0, 1] (clamped otherwise)
+    /// @param n number of rows and columns of the grid
+    /// @return row i in [0, n - 2] such that i <= x (n - 1) <= i + 1
+    size_t cell_row(double x, size_t n);
+
+    /// @brief interpolate a block of rows of an n x n grid at a batch of points
+    /// @param block rows [first_row, first_row + rows) of the grid (row-major, n columns)
+    /// @param n number of rows and columns of the (global) grid
+    /// @param first_row first global row of block
+    /// @param rows number of rows of block
+    /// @param x coordinates along the rows, with row i at x = i / (n - 1) as in Solver::fun_at
+    /// @param y coordinates along the columns
+    /// @param count number of points
+    /// @param method interpolation method
+    /// @param values interpolated values (output, size count)
+    /// @details points outside [0, 1]^2 are moved to the closest point of the square; the block must
+    ///          contain the rows [cell_row(x) - 1, cell_row(x) + 2] of every point, clipped to the grid.
+    ///          Where the bicubic stencil leaves the grid, the missing nodes are extrapolated (Keys).
+    void interpolate(const double *block, size_t n, size_t first_row, size_t rows,
+                     const double *x, const double *y, size_t count, Method method, double *values);
+
+    /// @brief rows owned by each process for a distribution of n rows among size processes
+    /// @return bounds of size size + 1: process r owns the rows [bounds[r], bounds[r + 1])
+    std::vector<size_t> partition(size_t n, int size);
+
+    /// @brief rows held by a process: its own rows and up to halo rows on each side
+    /// @param bounds rows owned by each process (see partition)
+    /// @param rank process
+    /// @param n number of rows and columns of the grid
+    /// @param first_row first global row held (output)
+    /// @param rows number of rows held (output)
+    void held_rows(const std::vector<size_t> &bounds, int rank, size_t n, size_t &first_row, size_t &rows);
+
+    /// @brief interpolate a grid distributed by rows at the points of every process
+    /// @param block rows held by this process (see held_rows)
+    /// @param n number of rows and columns of the grid
+    /// @param bounds rows owned by each process (see partition)
+    /// @param x coordinates along the rows of the points of this process
+    /// @param y coordinates along the columns of the points of this process
+    /// @param method interpolation method
+    /// @param comm communicator among which the grid is distributed
+    /// @return values at the points of this process, in the same order
+    /// @details collective: every point is sent to the process owning the first row of its cell and
+    ///          its value is sent back, with three all-to-all exchanges (counts, points, values)
+    std::vector<double> interpolate(const double *block, size_t n, const std::vector<size_t> &bounds,
+                                    const std::vector<double> &x, const std::vector<double> &y,
+                                    Method method, MPI_Comm comm);
+} // namespace solver::probe
+#endif // PROBE_HPP
@@ -0,0 +1,53 @@
+/**
+ * @file pyramid.hpp
+ * @brief Multi-resolution (pyramid) output of a grid distributed by rows
+ *
+ * A visualization tool needs seconds to open a grid of 16k x 16k values, most of which are
+ * not visible on a screen anyway. Alongside the full-resolution file, the writer below
+ * produces a pyramid of levels, each downsampled by 2 in both directions, down to a
+ * given size, so a coarse level can be opened first. The levels are built while writing:
+ * every process restricts its own slab of the current level, with one row from each
+ * neighbouring slab, and writes it at its offset in the file of the level with MPI-IO.
+ * Only the current level and the one being built are kept in memory, and the grid is
+ * never collected on a single process.
+ */
+#ifndef PYRAMID_HPP
+#define PYRAMID_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <mpi.h>
+
+/**
+ * @namespace solver::pyramid
+ * @brief Multi-resolution output of distributed grids
+ */
+namespace solver::pyramid
+{
+    /// @brief size of the level below a level of n x n values
+    /// @details node I of the coarse level sits on node min(2 I, n - 1) of the fine level, so
+    ///          the coarse grid covers the same square and keeps its corners
+    size_t coarse_size(size_t n);
+
+    /// @brief name of the file of a level
+    /// @param basename name of the output without extension
+    /// @param level 0 for the full resolution
+    /// @return basename.vtk for level 0, basename_level<level>.vtk otherwise
+    std::string level_name(const std::string &basename, size_t level);
+
+    /// @brief write a grid distributed by rows and its pyramid of downsampled levels
+    /// @param slab rows [bounds[rank], bounds[rank + 1]) of the n x n grid held by this process
+    /// @param n number of rows and columns of the grid
+    /// @param bounds rows owned by each process (size = number of processes + 1)
+    /// @param basename name of the output without extension (see level_name)
+    /// @param min_size the last level is the first one with at most min_size rows
+    /// @param comm communicator among which the grid is distributed
+    /// @return number of levels written, the full resolution included
+    /// @details collective. The files are legacy VTK STRUCTURED_GRID in binary (big-endian floats),
+    ///          with the coordinates x = i / (n - 1) of Solver::fun_at. Each level is obtained by full
+    ///          weighting (1/4, 1/2, 1/4 in each direction) of the one above.
+    size_t write(const double *slab, size_t n, const std::vector<size_t> &bounds,
+                 const std::string &basename, size_t min_size, MPI_Comm comm);
+} // namespace solver::pyramid
+#endif // PYRAMID_HPP
@@ -0,0 +1,24 @@
+/**
+ * @file quiet_cout.hpp
+ * @brief RAII helper silencing std::cout
+ *
+ * The benchmarks run the solvers for a fixed number of iterations, deliberately
+ * stopping before convergence, so the solver warnings about the maximum number
+ * of iterations are expected and only clutter the output.
+ */
+#ifndef QUIET_COUT_HPP
+#define QUIET_COUT_HPP
+
+#include <iostream>
+
+namespace solver
+{
+    /// @brief Silence std::cout while in scope.
+    struct QuietCout
+    {
+        QuietCout() : saved(std::cout.rdbuf(nullptr)) {}
+        ~QuietCout() { std::cout.rdbuf(saved); }
+        std::streambuf *saved;
+    };
+} // namespace solver
+#endif // QUIET_COUT_HPP
@@ -0,0 +1,105 @@
+/**
+ * @file reduction.hpp
+ * @brief Node-aware (two-level) allreduce of small vectors
+ *
+ * Every iteration of the MPI solvers ends with the reduction of a residual: a few bytes,
+ * so its cost is pure latency. A flat MPI_Allreduce over all the ranks of a multi-node
+ * job may send messages across the network at every step of its tree even between ranks
+ * of the same node. The reduction below works in two levels:
+ * - the ranks of a node (MPI_COMM_TYPE_SHARED) write their values in their slot of a
+ *   shared-memory window, and the node leader combines the slots in place;
+ * - the leaders reduce the partial results among themselves with MPI_Allreduce, so only
+ *   one message per node crosses the network at each step;
+ * - the leader writes the result in the window, where the other ranks of the node read it.
+ * The ranks of a node synchronize with two barriers, which on shared memory cost far less
+ * than a network round trip. Vectors longer than the window go through MPI_Reduce and
+ * MPI_Bcast on the node communicator instead.
+ */
+#ifndef REDUCTION_HPP
+#define REDUCTION_HPP
+
+#include <cstddef>
+#include <mpi.h>
+
+/**
+ * @namespace solver::reduction
+ * @brief Hierarchical reductions
+ */
+namespace solver::reduction
+{
+    /// @brief algorithm of an allreduce
+    enum class Algorithm
+    {
+        Automatic,   ///< hierarchical if the ranks span several nodes with several ranks each, flat otherwise
+        Flat,        ///< MPI_Allreduce over all the ranks
+        Hierarchical ///< intra-node through shared memory, inter-node among the node leaders
+    };
+
+    /**
+     * @brief Allreduce of small vectors of doubles on a fixed communicator
+     * @details the constructor and reduce are collective over the communicator. The object owns
+     *          the node and leader communicators and the shared window, so it is meant to be
+     *          built once and reused by the iterations of the solvers.
+     */
+    class Allreduce
+    {
+    public:
+        /// @brief build the communicators and the window
+        /// @param comm communicator of the reduction
+        /// @param algorithm algorithm of the reduction
+        /// @param node_size if positive, group the ranks of a node in blocks of node_size consecutive
+        ///                  ranks, each acting as a node (to emulate a multi-node layout on one node)
+        /// @param capacity number of doubles reduced through the window
+        explicit Allreduce(MPI_Comm comm, Algorithm algorithm = Algorithm::Automatic, int node_size = 0, size_t capacity = 64);
+
+        /// @brief free the communicators and the window
+        ~Allreduce();
+
+        Allreduce(const Allreduce &) = delete;
+        Allreduce &operator=(const Allreduce &) = delete;
+
+        /// @brief reduce a vector in place over the ranks of the communicator
+        /// @param values vector of count doubles (input and output)
+        /// @param count number of doubles
+        /// @param op reduction operation (MPI_SUM, MPI_MAX, ...)
+        /// @details every rank receives the same result, also for the operations that are not
+        ///          associative in floating point (MPI_SUM)
+        void reduce(double *values, int count, MPI_Op op) const;
+
+        /// @brief communicator of the reduction
+        MPI_Comm communicator() const { return comm; };
+
+        /// @brief whether the reduction is hierarchical
+        bool hierarchical() const { return node_comm != MPI_COMM_NULL; };
+
+        /// @brief number of nodes spanned by the communicator (as seen by the reduction)
+        int nodes() const { return node_count; };
+
+    private:
+        /// @brief communicator of the reduction
+        MPI_Comm comm;
+
+        /// @brief ranks of the node of the calling rank (null if flat)
+        MPI_Comm node_comm = MPI_COMM_NULL;
+
+        /// @brief leaders of the nodes (null on the other ranks, and if flat)
+        MPI_Comm leader_comm = MPI_COMM_NULL;
+
+        /// @brief shared window: one slot of capacity doubles per rank of the node, followed by the
+        ///        result of the node (allocated by the leader)
+        MPI_Win window = MPI_WIN_NULL;
+
+        /// @brief slots of the window, in the order of the ranks of the node, and result
+        double *slots = nullptr;
+
+        /// @brief rank of the calling rank in the node, and number of ranks of the node
+        int node_rank = 0, node_ranks = 1;
+
+        /// @brief number of nodes
+        int node_count = 1;
+
+        /// @brief number of doubles reduced through the window
+        size_t capacity;
+    };
+} // namespace solver::reduction
+#endif // REDUCTION_HPP
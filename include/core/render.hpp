@@ -0,0 +1,80 @@
+/**
+ * @file render.hpp
+ * @brief In-situ rendering of heatmaps of a grid distributed by rows
+ *
+ * Glancing at the solution of a long run should not require dumping the whole grid. The
+ * renderer below rasterizes the grid into an image of a chosen size with a perceptual
+ * colour map (viridis). Every process renders the strip of pixel rows that falls in its own
+ * rows, sampling its slab with the bilinear probe kernels; the strips are then composited:
+ * - PPM: every process writes its strip at its offset in the file with MPI-IO;
+ * - PNG: every process encodes its strip as a sequence of stored deflate blocks with its
+ *   Adler-32 checksum, and rank 0 concatenates the pieces, combines the checksums and
+ *   adds the chunks of the PNG format. The blocks are not compressed, which keeps the
+ *   encoder self-contained (no zlib, no gnuplot) and its cost proportional to the image.
+ */
+#ifndef RENDER_HPP
+#define RENDER_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <mpi.h>
+
+/**
+ * @namespace solver::render
+ * @brief Heatmaps of distributed grids
+ */
+namespace solver::render
+{
+    /// @brief image file format
+    enum class Format
+    {
+        PNG, ///< portable network graphics, RGB, uncompressed deflate blocks
+        PPM  ///< binary portable pixmap (P6)
+    };
+
+    /// @brief options of a heatmap
+    struct Options
+    {
+        /// @brief width and height of the image in pixels
+        size_t width = 512, height = 512;
+
+        /// @brief file format (the extension is added to the name of the file)
+        Format format = Format::PNG;
+
+        /// @brief map [low, high] to the colour map instead of the range of the values
+        bool fixed_range = false;
+
+        /// @brief values mapped to the ends of the colour map, if fixed_range
+        double low = 0.0, high = 1.0;
+    };
+
+    /// @brief colour of a value of the viridis colour map
+    /// @param t value in [0, 1] (clamped otherwise)
+    /// @param rgb red, green and blue components (output)
+    void colour(double t, unsigned char rgb[3]);
+
+    /// @brief Adler-32 checksum of the concatenation of two byte sequences
+    /// @param first checksum of the first sequence
+    /// @param second checksum of the second sequence
+    /// @param second_length length of the second sequence
+    /// @details as adler32_combine of zlib; it lets every process checksum its own part of the image
+    std::uint32_t adler32_combine(std::uint32_t first, std::uint32_t second, size_t second_length);
+
+    /// @brief render a heatmap of a grid distributed by rows
+    /// @param block rows [first_row, first_row + rows) of the n x n grid held by this process
+    /// @param n number of rows and columns of the grid
+    /// @param first_row first global row of block
+    /// @param rows number of rows of block
+    /// @param bounds rows owned by each process (size = number of processes + 1); block must hold the
+    ///               own rows and the row below them
+    /// @param options size, format and colour range of the image
+    /// @param basename name of the file without extension
+    /// @param comm communicator among which the grid is distributed
+    /// @details collective. Row 0 of the grid is the top row of the image, and pixel (p, q) samples the
+    ///          grid at x = p / (height - 1), y = q / (width - 1).
+    void heatmap(const double *block, size_t n, size_t first_row, size_t rows, const std::vector<size_t> &bounds,
+                 const Options &options, const std::string &basename, MPI_Comm comm);
+} // namespace solver::render
+#endif // RENDER_HPP
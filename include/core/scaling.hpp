@@ -0,0 +1,128 @@
+/**
+ * @file scaling.hpp
+ * @brief Weak and strong scaling experiments of the MPI solvers
+ *
+ * From a single launch on P processes, the driver runs the selected method on
+ * sub-communicators of 1, 2, 4, ..., P processes and, for each of them, with each
+ * number of threads of the matrix. Every run performs a fixed number of iterations,
+ * so that the work is the same whatever the convergence rate.
+ * - Strong scaling: n is fixed.
+ * - Weak scaling: n grows with the square root of the number of processing elements
+ *   (processes x threads), so that the work per processing element is constant.
+ *
+ * Each run is traced (see trace.hpp) to measure the time spent in communication,
+ * from which the communication fraction is derived, together with the parallel
+ * efficiency and the Karp-Flatt experimentally determined serial fraction. When the
+ * RAPL counters are readable (see energy.hpp), the energy of the nodes of each run is
+ * reported too, so configurations can be compared on energy-to-solution.
+ */
+#ifndef SCALING_HPP
+#define SCALING_HPP
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+/**
+ * @namespace solver::scaling
+ * @brief Scaling experiments of the MPI solvers
+ */
+namespace solver::scaling
+{
+    /// @brief kind of scaling experiment
+    enum class Mode
+    {
+        Strong, ///< fixed problem size
+        Weak    ///< fixed problem size per processing element
+    };
+
+    /**
+     * @brief Options of a scaling experiment
+     */
+    struct Options
+    {
+        /// @brief kind of experiment
+        Mode mode = Mode::Strong;
+
+        /// @brief method to be run: "jacobi_mpi", "jacobi_hybrid", "jacobi_hybrid_tasks", "direct_mpi" or "direct_hybrid"
+        std::string method = "jacobi_hybrid";
+
+        /// @brief grid size (strong scaling) or grid size on one processing element (weak scaling)
+        size_t n = 256;
+
+        /// @brief numbers of processes; empty means 1, 2, 4, ... up to the size of the communicator
+        std::vector<int> ranks;
+
+        /// @brief numbers of threads per process
+        std::vector<unsigned> threads{1};
+
+        /// @brief number of iterations of every run
+        unsigned iterations = 200;
+    };
+
+    /**
+     * @brief Result of one run of the experiment
+     */
+    struct Point
+    {
+        /// @brief number of processes
+        int ranks;
+
+        /// @brief number of threads per process
+        unsigned threads;
+
+        /// @brief grid size
+        size_t n;
+
+        /// @brief wall time of the run (maximum over the processes)
+        double seconds;
+
+        /// @brief time spent in halo exchanges and reductions (maximum over the processes)
+        double comm_seconds;
+
+        /// @brief speedup (scaled speedup for weak scaling) with respect to 1 process and 1 thread
+        double speedup;
+
+        /// @brief parallel efficiency
+        double efficiency;
+
+        /// @brief Karp-Flatt serial fraction (0 for one processing element)
+        double karp_flatt;
+
+        /// @brief fraction of the wall time spent in communication
+        double comm_fraction;
+
+        /// @brief energy of the nodes running the solve, each node counted once (joules, negative if unavailable)
+        double joules = -1.0;
+    };
+
+    /// @brief grid size of a run
+    /// @param options options of the experiment
+    /// @param pes number of processing elements (processes x threads)
+    size_t grid_size(const Options &options, unsigned pes);
+
+    /// @brief run the experiment (collective over comm)
+    /// @param options options of the experiment
+    /// @param comm processes available to the experiment
+    /// @return results of all the runs on the first process of comm, empty elsewhere
+    std::vector<Point> run(const Options &options, MPI_Comm comm = MPI_COMM_WORLD);
+
+    /// @brief compute speedup, efficiency, Karp-Flatt serial fraction and communication fraction
+    /// @param points runs whose ranks, threads, n, seconds and comm_seconds are known;
+    ///        the run with 1 process and 1 thread is the reference
+    /// @param mode kind of experiment
+    void compute_metrics(std::vector<Point> &points, Mode mode);
+
+    /// @brief write the results as CSV
+    /// @param points results of the experiment
+    /// @param options options of the experiment
+    /// @param filename output file
+    void write_csv(const std::vector<Point> &points, const Options &options, const std::string &filename);
+
+    /// @brief read the results written by write_csv
+    std::vector<Point> read_csv(const std::string &filename);
+
+    /// @brief print the results as a table
+    void print(const std::vector<Point> &points, const Options &options);
+} // namespace solver::scaling
+#endif // SCALING_HPP
@@ -0,0 +1,84 @@
+/**
+ * @file separable.hpp
+ * @brief Detection of separable functions and outer-product construction of grids
+ *
+ * Many forcing terms are products g(x) h(y), like the default 8 pi^2 sin(2 pi x) sin(2 pi y).
+ * For them the grid of the values of f is the outer product of two vectors of length n,
+ * which cost 2n evaluations instead of n^2 and are stored in O(n) memory.
+ * Separability is detected numerically with a rank-1 test on a set of sample points,
+ * which works for any callable (lambdas and muParserX expressions alike), and then
+ * verified on the grid, each rank on its own rows; the expression layer can also provide the factors
+ * directly (see muparser::split_separable).
+ */
+#ifndef SEPARABLE_HPP
+#define SEPARABLE_HPP
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @namespace solver::separable
+ * @brief Separable functions of {x, y}
+ */
+namespace solver::separable
+{
+    /// @brief type of the functions of {x, y} used by the Solver
+    using function_type = std::function<double(std::vector<double>)>;
+
+    /// @brief number of sample points per direction of the rank-1 test
+    constexpr size_t samples = 7;
+
+    /**
+     * @brief Factors of a separable function f(x, y) = g(x) h(y)
+     * @note g only reads x[0] and h only reads x[1].
+     */
+    struct Factors
+    {
+        /// @brief factor depending on x
+        function_type g;
+
+        /// @brief factor depending on y
+        function_type h;
+    };
+
+    /// @brief test whether f is separable with a rank-1 test on samples x samples points
+    /// @details the matrix M_ij = f(x_i, y_j) has rank one if and only if
+    ///          M_ij M_pq = M_iq M_pj for every i, j, where (p, q) is the largest entry;
+    ///          then g(x) = f(x, y_q) and h(y) = f(x_p, y) / M_pq.
+    ///          The sample points are irregularly spaced in (0, 1) so that they do not
+    ///          fall on the zeros of periodic functions. A function vanishing on all the
+    ///          samples is reported as not separable.
+    /// @param f function to be tested
+    /// @param factors factors of f, if separable (output)
+    /// @param tol relative tolerance of the test
+    /// @return true if f is separable
+    bool detect(const function_type &f, Factors &factors, double tol = 1e-10);
+
+    /// @brief check a factorization of f on every point of the rows [first_row, first_row + rows) of an n x n grid
+    /// @details the rank-1 test only looks at a few points, so it cannot see features of f
+    ///          smaller than the spacing of the samples (a localized source, for example);
+    ///          this check costs rows x n evaluations of f, like a single evaluation of those rows.
+    ///          A distributed solver checks its own slab and combines the results of the ranks.
+    /// @param f function
+    /// @param factors candidate factors of f
+    /// @param n number of rows and columns of the (global) grid
+    /// @param first_row first global row
+    /// @param rows number of rows
+    /// @param tol tolerance relative to the largest value of f on the rows
+    /// @return true if |f(x_i, y_j) - g(x_i) h(y_j)| <= tol max |f| at every point of the rows
+    bool verify(const function_type &f, const Factors &factors, size_t n, size_t first_row, size_t rows, double tol = 1e-10);
+
+    /// @brief values of the factors on the rows [first_row, first_row + rows) of an n x n grid
+    /// @param factors factors of f
+    /// @param n number of rows and columns of the (global) grid
+    /// @param first_row first global row
+    /// @param rows number of rows
+    /// @param scale factor multiplying the values
+    /// @param gx scale * g(x_i) for the rows (output)
+    /// @param hy h(y_j) for all the columns (output)
+    /// @details scale * f(x_i, y_j) = gx[i - first_row] * hy[j], with x_i = i / (n - 1) and
+    ///          y_j = j / (n - 1) as in Solver::fun_at
+    void sample(const Factors &factors, size_t n, size_t first_row, size_t rows, double scale, std::vector<double> &gx, std::vector<double> &hy);
+} // namespace solver::separable
+#endif // SEPARABLE_HPP
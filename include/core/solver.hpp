@@ -21,9 +21,24 @@
 #include <iostream>
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <optional>
+#include <memory>
+#include <stdexcept>
 #include <mpi.h>
 
 #include "vtk.hpp"
+#include "huge_page_allocator.hpp"
+#include "stats.hpp"
+#include "thread_pool.hpp"
+#include "separable.hpp"
+#include "lifting.hpp"
+#include "probe.hpp"
+#include "pyramid.hpp"
+#include "render.hpp"
+#include "telemetry.hpp"
+#include "reduction.hpp"
+#include "footprint.hpp"
 
 /**
  * @namespace solver
@@ -49,6 +64,16 @@
  */
 namespace solver
 {
+    /// @brief type of the grid buffers, backed by huge pages when they are large enough
+    using grid_type = std::vector<double, memory::HugePageAllocator<double>>;
+
+    /// @brief order of the subdomain solves of solve_direct_mpi
+    enum class Schwarz
+    {
+        Additive,      ///< every slab solves with the values of the previous iteration, then all exchange (block Jacobi)
+        Multiplicative ///< the even slabs solve and send, then the odd ones solve with the new rows (red-black block Gauss-Seidel)
+    };
+
     /**
      * @class Solver
      * @brief A numerical solver class for solving 2D Laplace equations using various iterative and direct methods.
@@ -92,6 +117,7 @@ namespace solver
         /// @param n grid size
         /// @param max_iter maximum number of iterations
         /// @param tol tolerance for convergence
+        /// @throws std::invalid_argument if n < 3 (the grid would have no interior points)
         Solver(
             const std::vector<double> &initial_guess,
             std::function<double(std::vector<double>)> f,
@@ -110,13 +136,15 @@ namespace solver
               max_iter(max_iter),
               tol(tol),
               uex(uex),
-              uh(initial_guess),
+              uh(initial_guess.begin(), initial_guess.end()),
               f(f),
               top_bc(top_bc),
               right_bc(right_bc),
               bottom_bc(bottom_bc),
               left_bc(left_bc)
         {
+            if (n < 3)
+                throw std::invalid_argument("The grid size must be at least 3");
         }
 
         /// @brief default destructor
@@ -139,6 +167,15 @@ namespace solver
         /// @details it uses a collapse directive to parallelize the nested loops
         void solve_jacobi_omp();
 
+        /// @brief red-black Gauss-Seidel solver, threaded, on the red/black split layout
+        /// @details the grid and h^2 f are split by colour (checkerboard::Grid) on entry and the grid is
+        ///          merged back on exit. Each iteration updates the red points and then the black ones,
+        ///          every thread on its strip of rows, with unit-stride loops over half of the grid per colour
+        /// @details converges when sqrt(|u_new - u_old|^2 / (n - 1)) < tol, as the Jacobi solvers, in about
+        ///          half of their iterations
+        /// @details the threads and the backend are those of solve_jacobi_omp (set_num_threads, set_thread_backend)
+        void solve_gauss_seidel_rb();
+
         /// @brief implement Jacobi iterative solver for the Laplace equation with MPI
         /// @details it computes the solution of the equation using the Jacobi method
         ///          and checks for convergence using the L2 norm
@@ -153,22 +190,101 @@ namespace solver
         /// @details it uses hybrid parallelism with MPI and OpenMP
         void solve_jacobi_hybrid();
 
+        /// @brief implement Jacobi iterative solver for the Laplace equation with MPI and OpenMP tasks
+        /// @details same iterates as solve_jacobi_hybrid, but the halo exchange overlaps with the computation:
+        ///          the master thread posts non-blocking sends and receives of the boundary rows and creates
+        ///          one task per tile of tile_rows rows (four tiles per thread by default); tiles that do not
+        ///          touch a ghost row start at once, while the others are released through task dependencies
+        ///          when their halos have arrived
+        /// @details the exchange is completed by a task if MPI provides MPI_THREAD_SERIALIZED,
+        ///          otherwise by the master thread itself
+        /// @details tasks require OpenMP, so this method ignores the threading backend;
+        ///          without OpenMP the tiles are updated by the calling thread
+        void solve_jacobi_hybrid_tasks();
+
         /// @brief Schwarz implementation: locally, the equation is solved using Eigen LDLT decomposition
         /// @details for each processor, it computes the local solution of the equation using a direct method
         ///          and checks for convergence using the L2 norm
         /// @details it uses Eigen's SparseMatrix and SimplicialLDLT to solve the local system
         /// @details it uses MPI to divide the domain among the processes
+        /// @details with set_schwarz(Schwarz::Multiplicative), the slabs are coloured by the parity of their rank:
+        ///          in every iteration the even ranks solve and send their boundary rows, then the odd ranks solve
+        ///          with the new rows of their neighbours and send theirs back. Half of the processes wait in each
+        ///          half-iteration, but the new values cross two slabs per iteration instead of one.
         void solve_direct_mpi();
 
+        /// @brief hybrid Schwarz implementation: the slab of each process is split into strips of rows, one per thread,
+        ///        and each strip is solved with its own Eigen LDLT factorization
+        /// @details every thread solves the interior of its strip with the values of the previous iteration on the rows
+        ///          bordering it as Dirichlet data, so the iteration is the additive Schwarz method of solve_direct_mpi
+        ///          on processes x threads subdomains
+        /// @details the matrix of a strip does not change between the iterations: it is assembled and factorized
+        ///          once, concurrently by the threads, and every iteration only builds the right-hand side and solves
+        ///          with the cached factor. The right-hand side, the solves and the residual run in the threads,
+        ///          thread 0 performs the reduction and the halo exchange.
+        /// @details more subdomains need more iterations, which the cheaper iterations have to pay for
+        void solve_direct_hybrid();
+
+        /// @brief solve by superposition of a cached interior solve and of the harmonic lifting of the boundary data
+        /// @details the first call (and the first one after a change of f or of n) solves the problem with
+        ///          homogeneous Dirichlet data with solve_jacobi_omp and caches the result, together with the
+        ///          responses to the sine modes of the sides (see HarmonicLifting); the following calls only
+        ///          add the discrete harmonic function taking the current boundary values, in O(n^2 log n)
+        /// @details meant for sweeps over the boundary conditions: set_bc followed by solve_lifting
+        /// @details get_iter returns the Jacobi iterations of this call, 0 when the cache is reused
+        void solve_lifting();
+
+        /// @brief direct solver of the 5-point system by sine transforms (fast Poisson solver)
+        /// @details the boundary values are moved to the equations of the neighbouring interior points,
+        ///          and the problem with homogeneous Dirichlet data is solved with a sine transform in each
+        ///          direction (add_dirichlet_solution), in O(n^2 log n) whatever f is. Nothing is cached
+        ///          between calls: after a change of f, even a localized one, the solve is repeated.
+        ///          The transforms have length 2 (n - 1): n - 1 should have small prime factors (n = 2^k + 1)
+        /// @details a Gauss-Seidel sweep then checks the residual against tol; get_iter returns 1
+        void solve_fast_poisson();
+
+        /// @brief fast Poisson solver that re-solves incrementally after changes of f or of the boundary data
+        /// @details the equations (h^2 f with the boundary values moved, as in solve_fast_poisson) and the
+        ///          solution of the previous call are cached. Only the difference between the new equations
+        ///          and the cached ones is solved by sine transforms and added to the cached solution: the
+        ///          rows where the difference is zero are skipped, and the transforms along the columns are
+        ///          replaced by direct sums when few rows changed. Warm-started Gauss-Seidel sweeps then
+        ///          bring the residual below tol. A localized change of f thus costs a fraction of a solve
+        ///          from scratch, and an unchanged problem only the sweeps.
+        /// @details the first call (and the first one after reset or a change of n) solves the whole system
+        /// @details get_iter returns the number of Gauss-Seidel sweeps
+        void solve_incremental();
+
+        /// @brief conjugate gradient solver for the 5-point system, matrix-free and distributed over row slabs
+        /// @details converges when sqrt(|r|^2 / (n - 1)) < tol, where r is the residual of the equations
+        ///          scaled by h^2 (the sum runs over all the processes)
+        /// @details with set_recycle(k), it is a deflated CG (def-CG): the k approximate eigenvectors of the
+        ///          smallest eigenvalues harvested from the previous solves are projected out of the search
+        ///          directions, so the slow modes that limit plain CG are removed from the iteration. At the end
+        ///          of each solve the space is refreshed by a Rayleigh-Ritz step on the old vectors and the first
+        ///          search directions of this solve.
+        /// @details the recycled space is kept across solves as long as n and the number of processes do not change
+        void solve_cg_mpi();
+
         // SETTERS
 
         /// @brief set grid size
         /// @param n grid size
         /// @details The grid size is used to define the number of grid points
         ///          and the size of the solution vector
+        /// @throws std::invalid_argument if n < 3 (the grid would have no interior points)
         void set_n(size_t n)
         {
+            if (n < 3)
+                throw std::invalid_argument("The grid size must be at least 3");
             this->n = n;
+            probe_slab.clear();
+            // A factorization of f found numerically has only been checked on the old grid
+            if (!f_given_separable)
+            {
+                f_factors.reset();
+                f_checked = false;
+            }
         };
 
         /// @brief set the number of max iterations
@@ -190,6 +306,108 @@ namespace solver
             this->tol = tol;
         };
 
+        /// @brief set the number of threads used by the threaded solvers
+        /// @param num_threads number of threads of each team
+        void set_num_threads(unsigned num_threads)
+        {
+            this->num_threads = std::max(1u, num_threads);
+        };
+
+        /// @brief set the threading backend of the threaded solvers
+        /// @param backend OpenMP or the native thread pool
+        /// @details OpenMP is only available if the code has been compiled with OpenMP,
+        ///          otherwise the native thread pool is always used
+        void set_thread_backend(ThreadBackend backend)
+        {
+#ifdef _OPENMP
+            this->thread_backend = backend;
+#else
+            this->thread_backend = ThreadBackend::Native;
+#endif
+        };
+
+        /// @brief set the communicator used by the MPI solvers
+        /// @param comm communicator among which the grid is distributed
+        /// @details the default is MPI_COMM_WORLD; a sub-communicator allows running
+        ///          the MPI solvers on a subset of the processes
+        void set_comm(MPI_Comm comm)
+        {
+            this->comm = comm;
+            probe_slab.clear();
+        };
+
+        /// @brief render heatmaps of the iterates of the MPI solvers (solve_jacobi_mpi and solve_cg_mpi)
+        /// @param every interval in iterations between two images (0 for the final image only)
+        /// @param basename name of the images in test/data: basename_<iteration> and basename_final
+        ///                 (an empty name disables the rendering)
+        /// @param options size, format and colour range of the images
+        /// @details each process renders its strip from its own slab, so an image costs about as much
+        ///          as an iteration of a grid of the size of the image, instead of a dump of the grid
+        void set_monitor(size_t every, const std::string &basename, const render::Options &options = {})
+        {
+            this->monitor_every = every;
+            this->monitor_name = basename;
+            this->monitor_options = options;
+        };
+
+        /// @brief publish the progress of the iterative solvers in a shared-memory segment
+        /// @param publisher writer of the segment, or nullptr to stop publishing
+        /// @details the MPI solvers publish from rank 0 of their communicator only, so the other
+        ///          processes may pass nullptr; the publisher can be shared by several solvers
+        void set_telemetry(std::shared_ptr<telemetry::Publisher> publisher)
+        {
+            this->telemetry_publisher = std::move(publisher);
+        };
+
+        /// @brief set the algorithm of the reductions of the MPI solvers (residual norms, dot products)
+        /// @param algorithm flat, hierarchical (through the shared memory of each node) or automatic
+        /// @param node_size if positive, ranks of a node grouped in emulated nodes of node_size ranks
+        void set_reduction(reduction::Algorithm algorithm, int node_size = 0)
+        {
+            this->reduction_algorithm = algorithm;
+            this->reduction_node_size = node_size;
+            this->residual_reduction.reset();
+        };
+
+        /// @brief set the number of vectors recycled by solve_cg_mpi between solves
+        /// @param recycle number of approximate eigenvectors deflated in the next solves (0 for plain CG)
+        void set_recycle(size_t recycle)
+        {
+            this->recycle = recycle;
+            if (recycle == 0)
+                clear_recycle();
+        };
+
+        /// @brief discard the vectors recycled by solve_cg_mpi
+        void clear_recycle()
+        {
+            recycle_W.clear();
+            recycle_AW.clear();
+        };
+
+        /// @brief set the order of the subdomain solves of solve_direct_mpi
+        /// @param schwarz additive (default) or multiplicative with red-black colouring of the slabs
+        void set_schwarz(Schwarz schwarz)
+        {
+            this->schwarz = schwarz;
+        };
+
+        /// @brief set the number of rows of the tiles of the task-based solver
+        /// @param tile_rows number of rows of each task, 0 (default) for four tiles per thread
+        void set_tile_rows(size_t tile_rows)
+        {
+            this->tile_rows = tile_rows;
+        };
+
+        /// @brief set whether the solves measure their memory and check it against the memory of the node
+        /// @param memory_check true to restart and read the high-water marks of every solve (procfs) and to
+        ///                     compare the predictions of each node with its available memory (collective)
+        /// @details off by default: the prediction alone is always reported by stats()
+        void set_memory_check(bool memory_check)
+        {
+            this->memory_check = memory_check;
+        };
+
         /// @brief set the exact solution of the equation
         /// @param uex exact solution of the equation
         /// @details The exact solution is used to compare the computed solution
@@ -205,7 +423,8 @@ namespace solver
         ///          before the iterative solver starts
         void set_initial_guess(const std::vector<double> &initial_guess)
         {
-            this->uh = initial_guess;
+            this->uh.assign(initial_guess.begin(), initial_guess.end());
+            probe_slab.clear();
         }
 
         /// @brief set the exact solution of the equation
@@ -220,6 +439,31 @@ namespace solver
         void set_f(std::function<double(std::vector<double>)> f)
         {
             this->f = f;
+            f_factors.reset();
+            f_checked = false;
+            f_given_separable = false;
+            lifting_interior.clear();
+        };
+
+        /// @brief set a separable right-hand side f(x, y) = g(x) h(y)
+        /// @param g factor depending on x (only x[0] is read)
+        /// @param h factor depending on y (only x[1] is read)
+        /// @details the grid of the values of f is built as the outer product of the
+        ///          values of g and h, without the rank-1 test; the factors are only spot-checked
+        ///          on a coarse grid, which catches a g reading y or an h reading x
+        /// @throws std::invalid_argument if g(x) h(x) differs from g(x, 0) h(0, y) on the coarse grid
+        void set_f_separable(std::function<double(std::vector<double>)> g, std::function<double(std::vector<double>)> h)
+        {
+            std::function<double(std::vector<double>)> product = [g, h](std::vector<double> x)
+            { return g(x) * h(x); };
+            constexpr size_t coarse = 2 * separable::samples + 1;
+            if (!separable::verify(product, separable::Factors{g, h}, coarse, 0, coarse))
+                throw std::invalid_argument("The factors of a separable f must depend on x only and on y only");
+            this->f = std::move(product);
+            f_factors = separable::Factors{g, h};
+            f_checked = true;
+            f_given_separable = true;
+            lifting_interior.clear();
         };
 
         /// @brief set the boundary conditions of the system
@@ -275,6 +519,28 @@ namespace solver
             vtk::write(uh, "test/data/" + filename + ".vtk");
         };
 
+        /// @brief save the computed solution and its pyramid of downsampled levels to VTK files
+        /// @param filename name of the output files, without extension (see pyramid::level_name)
+        /// @param min_size the coarsest level is the first one with at most min_size rows
+        /// @return number of levels written, the full resolution included
+        /// @details collective on the communicator of the MPI solvers. The solution of rank 0 is scattered
+        ///          by row slabs, and every process builds and writes its part of each level (binary VTK,
+        ///          see pyramid::write), so a coarse level can be opened instead of a huge grid.
+        size_t save_vtk_pyramid(const std::string &filename, size_t min_size = 256) const;
+
+        /// @brief render a heatmap of the computed solution
+        /// @param filename name of the image in test/data, without extension
+        /// @param options size, format and colour range of the image
+        /// @details collective on the communicator of the MPI solvers: the solution of rank 0 is scattered by
+        ///          row slabs and every process renders its strip of the image (see render::heatmap)
+        void save_heatmap(const std::string &filename, const render::Options &options = {}) const;
+
+        /// @brief get the grid size
+        size_t get_n() const
+        {
+            return n;
+        }
+
         /// @brief get the number of iterations tracked during the solver
         /// @return number of iterations
         unsigned get_iter() const
@@ -286,7 +552,7 @@ namespace solver
         /// @return computed solution
         const std::vector<double> get_uh() const
         {
-            return uh;
+            return std::vector<double>(uh.begin(), uh.end());
         };
 
         /// @brief get the exact solution in vector form
@@ -304,6 +570,33 @@ namespace solver
             return temp;
         };
 
+        /// @brief interpolate the computed solution at arbitrary points
+        /// @param x coordinates along the rows (x = 0 on the top row, as in fun_at) of the points of this process
+        /// @param y coordinates along the columns of the points of this process
+        /// @param method bilinear or bicubic interpolation
+        /// @return values at the points, in the order of x and y
+        /// @details collective on the communicator of the MPI solvers, each process with its own points
+        ///          (possibly none). The solution of rank 0 is scattered by row slabs with a halo of
+        ///          probe::halo rows, and each point is interpolated by the process owning its cell, so
+        ///          no process needs a copy of the whole grid.
+        /// @details the slabs are scattered by the first call after a solve (or reset, set_n, set_comm,
+        ///          set_initial_guess) and kept for the following ones, which only route the points
+        std::vector<double> probe(const std::vector<double> &x, const std::vector<double> &y,
+                                  probe::Method method = probe::Method::Bilinear) const;
+
+        /// @brief get the threading backend of the threaded solvers
+        ThreadBackend get_thread_backend() const
+        {
+            return thread_backend;
+        }
+
+        /// @brief get the statistics of the last solve
+        /// @return statistics of the last solve
+        const SolverStats &stats() const
+        {
+            return solver_stats;
+        }
+
         /// @brief reset the solver
         /// @details The reset function clears the solution vector and resets
         ///          the number of iterations to zero
@@ -314,6 +607,9 @@ namespace solver
             iter = 0;
             uh.clear();
             uh.resize(n * n, 0.0);
+            incremental_equations.clear();
+            incremental_uh.clear();
+            probe_slab.clear();
         };
 
     private:
@@ -341,11 +637,85 @@ namespace solver
 
         /// @brief computed approximate solution of the equation
         /// @details uh should have size n*n
-        std::vector<double> uh;
+        grid_type uh;
+
+        /// @brief statistics of the last solve
+        SolverStats solver_stats;
+
+        /// @brief number of threads used by the threaded solvers
+        unsigned num_threads = 2;
+
+        /// @brief number of rows of the tiles of the task-based solver
+        size_t tile_rows = 0;
+
+        /// @brief order of the subdomain solves of solve_direct_mpi
+        Schwarz schwarz = Schwarz::Additive;
+
+        /// @brief communicator used by the MPI solvers
+        MPI_Comm comm = MPI_COMM_WORLD;
+
+        /// @brief threading backend of the threaded solvers
+#ifdef _OPENMP
+        ThreadBackend thread_backend = ThreadBackend::OpenMP;
+#else
+        ThreadBackend thread_backend = ThreadBackend::Native;
+#endif
 
         /// @brief force term of the equation
         std::function<double(std::vector<double>)> f;
 
+        /// @brief factors of f, if f is separable
+        std::optional<separable::Factors> f_factors;
+
+        /// @brief whether f has already been tested for separability
+        bool f_checked = false;
+
+        /// @brief whether the factors of f have been given with set_f_separable
+        bool f_given_separable = false;
+
+        /// @brief responses to the sine modes of the sides, cached by solve_lifting
+        std::optional<HarmonicLifting> lifting;
+
+        /// @brief solution with homogeneous Dirichlet data, cached by solve_lifting (empty if not computed)
+        grid_type lifting_interior;
+
+        /// @brief equations (h^2 f with the boundary values moved) of the last call of solve_incremental (empty if not computed)
+        grid_type incremental_equations;
+
+        /// @brief solution of the last call of solve_incremental (empty if not computed)
+        grid_type incremental_uh;
+
+        /// @brief row slab of uh with its halo, scattered by probe and kept until the solution changes (empty if stale)
+        mutable std::vector<double> probe_slab;
+
+        /// @brief interval in iterations between the heatmaps of the MPI solvers (0 for the final one only)
+        size_t monitor_every = 0;
+
+        /// @brief name of the heatmaps of the MPI solvers (empty if disabled)
+        std::string monitor_name;
+
+        /// @brief options of the heatmaps of the MPI solvers
+        render::Options monitor_options;
+
+        /// @brief writer of the progress of the iterative solvers (none if null)
+        std::shared_ptr<telemetry::Publisher> telemetry_publisher;
+
+        /// @brief algorithm of the reductions of the MPI solvers, and size of the emulated nodes
+        reduction::Algorithm reduction_algorithm = reduction::Algorithm::Automatic;
+        int reduction_node_size = 0;
+
+        /// @brief reduction of the MPI solvers, built on comm by reducer
+        std::shared_ptr<reduction::Allreduce> residual_reduction;
+
+        /// @brief number of vectors recycled by solve_cg_mpi
+        size_t recycle = 0;
+
+        /// @brief whether the solves measure their memory and check it against the node (set_memory_check)
+        bool memory_check = false;
+
+        /// @brief recycled vectors (local slabs, A-orthonormal) and their products with the matrix
+        std::vector<std::vector<double>> recycle_W, recycle_AW;
+
         /// @brief top boundary condition
         std::function<double(std::vector<double>)> top_bc;
 
@@ -364,7 +734,7 @@ namespace solver
         /// @param rows number of rows in the solution
         /// @param cols number of columns in the solution
         /// @return error between the two solutions
-        double compute_error_serial(const std::vector<double> &sol1, const std::vector<double> &sol2, unsigned rows, unsigned cols) const;
+        double compute_error_serial(const grid_type &sol1, const grid_type &sol2, unsigned rows, unsigned cols) const;
 
         /// @brief OPENMP parallel version of the compute_error_serial function
         /// @param sol1 first solution vector
@@ -372,7 +742,7 @@ namespace solver
         /// @param rows number of rows in the solution
         /// @param cols number of columns in the solution
         /// @return error between the two solutions
-        double compute_error_omp(const std::vector<double> &sol1, const std::vector<double> &sol2, unsigned rows, unsigned cols) const;
+        double compute_error_omp(const grid_type &sol1, const grid_type &sol2, unsigned rows, unsigned cols) const;
 
         /// @brief compute the L2 norm of the error between a solution in vector form and one in function form
         /// @param sol1 computed solution vector
@@ -380,7 +750,7 @@ namespace solver
         /// @param rows number of rows in the solution
         /// @param cols number of columns in the solution
         /// @return error between the two solutions
-        double compute_error_serial(const std::vector<double> &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const;
+        double compute_error_serial(const grid_type &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const;
 
         /// @brief OPENMP parallel version of the compute_error_serial function
         /// @param sol1 computed solution vector
@@ -388,7 +758,76 @@ namespace solver
         /// @param rows number of rows in the solution
         /// @param cols number of columns in the solution
         /// @return error between the two solutions
-        double compute_error_omp(const std::vector<double> &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const;
+        double compute_error_omp(const grid_type &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const;
+
+        /// @brief divide the rows of the grid among the processes
+        /// @param mpi_size number of processes
+        /// @param counts number of elements of the local grid of each process, ghost rows included (output)
+        /// @param start_idxs offset of the first element of each local grid in the global grid (output)
+        /// @details every process gets a contiguous slab of rows plus one ghost row towards each neighbour;
+        ///          the result is the same on every process, so no communication is needed
+        void decompose(int mpi_size, std::vector<int> &counts, std::vector<int> &start_idxs) const;
+
+        /// @brief rows owned by each process with the decomposition of decompose
+        /// @param start_idxs offset of the first element of each local grid (from decompose)
+        /// @return bounds of size mpi_size + 1: process r owns the global rows [bounds[r], bounds[r + 1]),
+        ///         that is its local rows without the ghost rows
+        std::vector<size_t> owned_rows(const std::vector<int> &start_idxs) const;
+
+        /// @brief render a heatmap of the iterate of an MPI solver, named after monitor_name
+        /// @param local local grid of this process, with up-to-date ghost rows
+        /// @param start_idxs offset of the first element of each local grid (from decompose)
+        /// @param local_rows number of rows of the local grid, ghost rows included
+        /// @param suffix appended to monitor_name, after an underscore
+        void monitor(const double *local, const std::vector<int> &start_idxs, size_t local_rows, const std::string &suffix) const;
+
+        /// @brief reduction of the MPI solvers on comm (collective on the first call on a communicator)
+        const reduction::Allreduce &reducer();
+
+        /// @brief start publishing the progress of a solve
+        /// @param method name of the solver
+        /// @param rank rank of the calling process in the communicator of the solver (0 for the threaded solvers)
+        /// @param processes number of processes of the solver
+        /// @return the publisher to be fed by the iterations of the solve, or nullptr if no publisher is
+        ///         set or the calling process is not rank 0
+        telemetry::Publisher *start_telemetry(const std::string &method, int rank, int processes) const;
+
+        /// @brief predict the memory of a solve on this rank, record it in the statistics and, with
+        ///        set_memory_check, warn if the processes of the node would exceed the available memory
+        /// @param method name of the solver
+        /// @param local_rows rows of the slab of this rank, ghost rows included (n for the threaded solvers)
+        /// @param comm communicator of the solver (collective over it with set_memory_check), MPI_COMM_NULL
+        ///             for the threaded solvers
+        /// @details does nothing in a solve called by another solve, whose prediction covers it
+        /// @param threads number of sets of row buffers (threads, or tiles of the task-based solver)
+        void check_memory(const std::string &method, size_t local_rows, MPI_Comm comm, size_t threads);
+
+        /// @brief set the boundary values of uh and build the equations of the interior points
+        /// @param rhs_grid h^2 f at every grid point (output)
+        /// @param equations h^2 f plus the boundary values of the neighbouring boundary points, which leaves
+        ///        a problem with homogeneous Dirichlet data for add_dirichlet_solution (output)
+        void dirichlet_equations(grid_type &rhs_grid, grid_type &equations);
+
+        /// @brief values of the factors of h^2 f on the rows [first_row, first_row + rows) of the grid
+        /// @param first_row first global row
+        /// @param rows number of rows
+        /// @param f_x h^2 g(x_i) for the local rows (output)
+        /// @param f_y h(y_j) for all the columns (output)
+        /// @param comm communicator of the ranks sharing the grid, MPI_COMM_NULL if this process holds all of it
+        /// @return true if f is separable, so that h^2 f(x_i, y_j) = f_x[i] * f_y[j]
+        /// @details f is tested for separability on the first call after set_f (or set_n): a rank-1 test
+        ///          on a few samples, confirmed on the rows [first_row, first_row + rows) of every rank.
+        ///          With a communicator the answers of the ranks are combined on every call, so they
+        ///          agree even if some of them already ran a threaded solver. Must then be called by
+        ///          every process of comm
+        bool rhs_factors(size_t first_row, size_t rows, std::vector<double> &f_x, std::vector<double> &f_y,
+                         MPI_Comm comm = MPI_COMM_NULL);
+
+        /// @brief execute a parallel region on num_threads threads with the selected backend
+        /// @param worker function called as worker(thread_id, team_size, barrier) by every thread,
+        ///               where barrier() synchronizes the threads of the team
+        /// @details thread 0 is the calling thread, so it can perform MPI calls
+        void run_parallel(const std::function<void(unsigned, unsigned, const std::function<void()> &)> &worker) const;
 
         /// @brief get element (i, j) of the computed solution
         /// @param i row index
@@ -0,0 +1,75 @@
+/**
+ * @file stats.hpp
+ * @brief Statistics collected by the Solver during the last solve
+ *
+ * The statistics complement the timings measured by the driver program with
+ * information that is only known inside the solver, such as how the grid
+ * buffers have been backed.
+ */
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <iostream>
+#include <string>
+
+#include "huge_page_allocator.hpp"
+#include "energy.hpp"
+#include "footprint.hpp"
+
+namespace solver
+{
+    /**
+     * @brief Statistics of the last solve
+     */
+    struct SolverStats
+    {
+        /// @brief name of the method used in the last solve
+        std::string method;
+
+        /// @brief backing of the grid updated by the last solve (local grid for MPI methods)
+        memory::PageInfo grid_pages;
+
+        /// @brief whether the right-hand side was built as an outer product (separable f)
+        bool separable_rhs = false;
+
+        /// @brief number of recycled vectors deflated by the last CG solve
+        size_t deflation_vectors = 0;
+
+        /// @brief smallest Ritz value of the recycled space harvested by the last CG solve (0 if none)
+        double smallest_ritz_value = 0.0;
+
+        /// @brief time and energy of the last solve, measured by this process on its node
+        energy::Report energy;
+
+        /// @brief memory of the last solve on this process, predicted and measured
+        footprint::Report footprint;
+
+        /// @brief print the statistics
+        /// @param os output stream
+        void print(std::ostream &os = std::cout) const
+        {
+            os << "Solver stats (" << (method.empty() ? "none" : method) << ")\n";
+            os << "  grid pages: " << grid_pages.describe() << "\n";
+            os << "  rhs: " << (separable_rhs ? "outer product (separable f)" : "evaluated pointwise") << "\n";
+            if (method == "cg_mpi")
+                os << "  deflation: " << deflation_vectors << " recycled vectors, smallest Ritz value " << smallest_ritz_value << "\n";
+            if (energy.joules >= 0.0)
+            {
+                os << "  energy: " << energy.joules << " J in " << energy.seconds << " s (" << energy.watts() << " W, node-wide)";
+                for (auto phase : {trace::Phase::Sweep, trace::Phase::Exchange, trace::Phase::Reduction})
+                    os << ", " << trace::phase_name(phase) << " " << energy.phase_joules[static_cast<size_t>(phase)] << " J";
+                os << "\n";
+            }
+            else
+                os << "  energy: not available (no readable RAPL counters), time " << energy.seconds << " s\n";
+            constexpr double mb = 1024.0 * 1024.0;
+            if (!footprint.measured)
+                os << "  memory: " << footprint.predicted.total() / mb << " MB predicted (not measured, see Solver::set_memory_check)\n";
+            else
+                os << "  memory: grid buffers " << footprint.grid_peak_bytes / mb << " MB at peak (predicted "
+                   << footprint.predicted.grid_bytes / mb << " MB, " << footprint.predicted.total() / mb << " MB with the work buffers), "
+                   << "resident set " << footprint.rss_peak_bytes / mb << " MB at peak" << (footprint.rss_of_solve ? "" : " (since the start)") << "\n";
+        }
+    };
+} // namespace solver
+#endif // STATS_HPP
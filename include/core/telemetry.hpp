@@ -0,0 +1,197 @@
+/**
+ * @file telemetry.hpp
+ * @brief Live progress of the solvers in a shared-memory ring buffer
+ *
+ * A sidecar monitoring a long solve should not have to parse the console output. While a
+ * publisher is set, the solvers write one sample per iteration (iteration, residual, time
+ * spent in each phase and estimated time to convergence) into a ring buffer in a POSIX
+ * shared-memory segment, which any process of the node can map and tail. The buffer has a
+ * single writer and needs no lock: every slot carries a sequence number that is odd while
+ * the slot is being written (a seqlock), so a reader detects the samples that were torn or
+ * overwritten and never slows down the solver. Publishing a sample costs a clock read and a
+ * copy of a few cache lines; the phases are timed by the trace scopes of the solvers, which
+ * read the clock only while a publisher (or the tracer) is active.
+ */
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "trace.hpp"
+
+/**
+ * @namespace solver::telemetry
+ * @brief Shared-memory progress telemetry of the solvers
+ */
+namespace solver::telemetry
+{
+    /// @brief first bytes of a segment ("JACOBITM")
+    constexpr std::uint64_t magic = 0x4d5449424f43414aULL;
+
+    /// @brief version of the layout of a segment
+    constexpr std::uint32_t version = 1;
+
+    /// @brief progress of a solve after an iteration
+    struct Sample
+    {
+        /// @brief number of solves started on the segment before this one
+        std::uint64_t solve;
+
+        /// @brief iterations completed
+        std::uint64_t iteration;
+
+        /// @brief residual after the iteration and tolerance of the solver
+        double residual, tolerance;
+
+        /// @brief seconds since the start of the solve
+        double elapsed;
+
+        /// @brief estimated seconds to convergence, negative if unknown
+        /// @details extrapolates the mean rate of decrease of log(residual) since the first sample
+        double eta;
+
+        /// @brief seconds spent by the publishing thread in each phase (indexed by trace::Phase)
+        ///        since the first sample of the solve
+        double phase_seconds[trace::phase_count];
+
+        /// @brief size of the grid and number of processes of the solver
+        std::uint32_t n, processes;
+
+        /// @brief name of the solver (as in Stats::method), null-terminated
+        char method[32];
+    };
+
+    /// @brief header of a segment, followed by capacity slots
+    struct Header
+    {
+        std::uint64_t magic;
+        std::uint32_t version;
+
+        /// @brief number of slots of the ring buffer
+        std::uint32_t capacity;
+
+        /// @brief size of a slot in bytes
+        std::uint32_t slot_size;
+
+        /// @brief 1 once the publisher has closed the segment
+        std::atomic<std::uint32_t> closed;
+
+        /// @brief number of samples published; sample k is in slot k % capacity
+        std::atomic<std::uint64_t> head;
+    };
+
+    /// @brief slot of the ring buffer
+    struct Slot
+    {
+        /// @brief 2 k + 1 while sample k is being written, 2 k + 2 once it is complete
+        std::atomic<std::uint64_t> sequence;
+
+        /// @brief sample
+        Sample sample;
+    };
+
+    /// @brief name of a segment, with the leading slash required by shm_open
+    std::string segment_name(const std::string &name);
+
+    /**
+     * @brief Writer of a segment
+     * @details a publisher creates the segment (replacing any segment with the same name), and marks
+     *          it closed and removes its name when destroyed; readers that mapped it keep their view.
+     *          It must be used by one thread at a time.
+     */
+    class Publisher
+    {
+    public:
+        /// @brief create the segment
+        /// @param name name of the segment (see segment_name)
+        /// @param capacity number of samples kept
+        /// @throws std::runtime_error if the segment cannot be created
+        explicit Publisher(const std::string &name, size_t capacity = 4096);
+
+        /// @brief close and remove the segment
+        ~Publisher();
+
+        Publisher(const Publisher &) = delete;
+        Publisher &operator=(const Publisher &) = delete;
+
+        /// @brief start a solve
+        /// @param method name of the solver
+        /// @param n size of the grid
+        /// @param processes number of processes of the solver
+        /// @param tolerance tolerance on the residual
+        void begin(const std::string &method, size_t n, int processes, double tolerance);
+
+        /// @brief publish the progress of the current solve
+        /// @param iteration iterations completed
+        /// @param residual residual after the iteration
+        void publish(size_t iteration, double residual);
+
+        /// @brief name of the segment
+        const std::string &name() const { return segment; };
+
+    private:
+        /// @brief name of the segment
+        std::string segment;
+
+        /// @brief mapping of the segment
+        Header *header = nullptr;
+        Slot *slots = nullptr;
+        size_t bytes = 0;
+
+        /// @brief sample being filled, with the fields constant during a solve
+        Sample current{};
+
+        /// @brief number of solves started
+        std::uint64_t solves = 0;
+
+        /// @brief start of the solve, and time and residual of its first sample
+        double start = 0.0, first_time = -1.0, first_residual = 0.0;
+
+        /// @brief phase_seconds of the publishing thread at the first sample
+        double baseline[trace::phase_count] = {};
+    };
+
+    /**
+     * @brief Reader of a segment
+     */
+    class Reader
+    {
+    public:
+        /// @brief map an existing segment
+        /// @param name name of the segment (see segment_name)
+        /// @throws std::runtime_error if the segment does not exist or is not a telemetry segment
+        explicit Reader(const std::string &name);
+
+        /// @brief unmap the segment
+        ~Reader();
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        /// @brief number of samples published so far
+        std::uint64_t head() const;
+
+        /// @brief number of samples kept by the ring buffer
+        size_t capacity() const;
+
+        /// @brief whether the publisher has closed the segment
+        bool closed() const;
+
+        /// @brief read a sample
+        /// @param index index of the sample, in [head() - capacity(), head())
+        /// @param sample copy of the sample (output)
+        /// @return false if the sample has not been published yet, has been overwritten, or was
+        ///         being overwritten while it was copied
+        bool read(std::uint64_t index, Sample &sample) const;
+
+    private:
+        /// @brief mapping of the segment
+        const Header *header = nullptr;
+        const Slot *slots = nullptr;
+        size_t bytes = 0;
+    };
+} // namespace solver::telemetry
+#endif // TELEMETRY_HPP
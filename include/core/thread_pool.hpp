@@ -0,0 +1,103 @@
+/**
+ * @file thread_pool.hpp
+ * @brief Lightweight pool of persistent threads, used when OpenMP is not available
+ *
+ * The pool mimics the subset of OpenMP used by the threaded solvers: a parallel region
+ * executed by a team of threads (run) and a barrier among the threads of the team.
+ * Workers are created once and sleep on a condition variable between regions,
+ * so the cost of a region is a wake-up and a std::latch, not a thread creation.
+ */
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <barrier>
+#include <latch>
+#include <cstdint>
+
+namespace solver
+{
+    /// @brief threading backend used by the threaded solvers
+    enum class ThreadBackend
+    {
+        OpenMP, ///< OpenMP parallel regions (requires compiling with OpenMP)
+        Native  ///< built-in pool of std::thread workers
+    };
+
+    /**
+     * @class ThreadPool
+     * @brief Pool of persistent std::thread workers executing parallel regions
+     *
+     * The calling thread always takes part in the region as thread 0, so that,
+     * like the OpenMP master thread, it can safely perform MPI calls.
+     */
+    class ThreadPool
+    {
+    public:
+        /// @brief constructor
+        /// @param num_workers number of background workers created upfront
+        explicit ThreadPool(unsigned num_workers = 0);
+
+        /// @brief destructor, joins all the workers
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /// @brief get the pool shared by the whole process
+        static ThreadPool &instance();
+
+        /// @brief execute job(thread_id, num_threads) on num_threads threads and wait for all of them
+        /// @param num_threads number of threads of the team (including the calling thread)
+        /// @param job function executed by every thread of the team
+        /// @note Regions cannot be nested: a region started from inside a job runs on one thread.
+        void run(unsigned num_threads, const std::function<void(unsigned, unsigned)> &job);
+
+        /// @brief barrier among the threads of the current team (only valid inside a job)
+        void barrier();
+
+        /// @brief default number of threads of a team (hardware concurrency)
+        static unsigned default_threads();
+
+    private:
+        /// @brief main loop of a background worker
+        /// @param id index of the worker (the thread id in the team is id + 1)
+        void worker_loop(unsigned id);
+
+        /// @brief background workers
+        std::vector<std::thread> workers;
+
+        /// @brief mutex protecting the fields describing the current region
+        std::mutex mutex;
+
+        /// @brief condition variable used to wake up the workers
+        std::condition_variable wake_up;
+
+        /// @brief job of the current region
+        const std::function<void(unsigned, unsigned)> *job = nullptr;
+
+        /// @brief number of threads of the current team
+        unsigned team_size = 0;
+
+        /// @brief counter of the regions, used by the workers to detect a new one
+        uint64_t generation = 0;
+
+        /// @brief true when the pool is being destroyed
+        bool stopping = false;
+
+        /// @brief barrier among the threads of the current team
+        std::unique_ptr<std::barrier<>> team_barrier;
+
+        /// @brief latch counting the workers that finished the current region
+        std::unique_ptr<std::latch> finished;
+
+        /// @brief serializes regions started by different threads
+        std::mutex region_mutex;
+    };
+} // namespace solver
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,155 @@
+/**
+ * @file tiled.hpp
+ * @brief Tiled storage of a grid, with the tiles in row-major or Z (Morton) order
+ *
+ * In the natural i * n + j layout the points (i, j) and (i + 1, j) are n values apart: a
+ * kernel that walks a block of the grid, such as the restriction and the prolongation of
+ * multigrid (a coarse point reads a 3 x 3 block of fine points) or a sweep over tiles, touches
+ * a different cache line and, for large n, a different page for every row of the block. The
+ * grid below stores the points in square tiles of B x B values (B a power of two), each tile
+ * row-major and contiguous, and the tiles in row-major order or along the Z-order (Morton)
+ * curve, which keeps the 2 x 2 tiles of every level of the quadtree contiguous: the fine
+ * tiles read for a coarse tile are neighbours in memory. The offset of every tile is kept in a
+ * small table, so the index of a point is a table lookup, two shifts and two masks, and the
+ * grid is not padded beyond the last tile. The layout is meant to live for a whole computation:
+ * it is converted from and to the natural layout only at its boundaries (input, output).
+ */
+#ifndef TILED_HPP
+#define TILED_HPP
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "huge_page_allocator.hpp"
+
+/**
+ * @namespace solver::tiled
+ * @brief Tiled grids and their kernels
+ */
+namespace solver::tiled
+{
+    /// @brief order of the tiles in memory
+    enum class Order
+    {
+        RowMajor, ///< tile (I, J) after tile (I, J - 1), rows of tiles one after the other
+        Morton    ///< along the Z-order curve: by the interleaved bits of I and J
+    };
+
+    /// @brief interleave the bits of two coordinates: bit k of i goes to bit 2 k + 1, bit k of j to bit 2 k
+    inline std::uint64_t morton_key(std::uint32_t i, std::uint32_t j)
+    {
+        auto spread = [](std::uint64_t x)
+        {
+            x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+            x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+            x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+            x = (x | (x << 2)) & 0x3333333333333333ull;
+            x = (x | (x << 1)) & 0x5555555555555555ull;
+            return x;
+        };
+        return (spread(i) << 1) | spread(j);
+    }
+
+    /**
+     * @brief n x n grid stored in tiles of tile x tile values
+     * @details the tiles of the last row and column are complete: the points beyond n - 1 are
+     *          padding and are never read by the kernels. With huge pages every buffer starts on a
+     *          2 MB boundary, so tile t of the grids of a kernel (u, next and rhs of a sweep) would
+     *          map to the same cache sets: the first tile of every grid is skewed by a few cache
+     *          lines, different for consecutively built grids.
+     */
+    class Grid
+    {
+    public:
+        /// @brief build a grid of zeros
+        /// @param n number of rows and columns
+        /// @param tile side of a tile, rounded up to a power of two
+        /// @param order order of the tiles
+        explicit Grid(size_t n = 0, size_t tile = 32, Order order = Order::Morton);
+
+        /// @brief number of rows and columns
+        size_t size() const { return n; };
+
+        /// @brief side of a tile
+        size_t tile() const { return size_t{1} << shift; };
+
+        /// @brief number of tiles of a row (and of a column) of tiles
+        size_t tiles() const { return per_side; };
+
+        /// @brief order of the tiles
+        Order order() const { return tile_order; };
+
+        /// @brief position of the point (i, j) in the values
+        size_t index(size_t i, size_t j) const
+        {
+            return start[(i >> shift) * per_side + (j >> shift)] + ((i & mask) << shift) + (j & mask);
+        };
+
+        /// @brief value of the point (i, j)
+        double &operator()(size_t i, size_t j) { return values[index(i, j)]; };
+        double operator()(size_t i, size_t j) const { return values[index(i, j)]; };
+
+        /// @brief values, tile after tile in storage order, after the skew (point (i, j) at index(i, j))
+        double *data() { return values.data(); };
+        const double *data() const { return values.data(); };
+
+        /// @brief first value of tile (I, J)
+        double *tile_data(size_t I, size_t J) { return values.data() + start[I * per_side + J]; };
+        const double *tile_data(size_t I, size_t J) const { return values.data() + start[I * per_side + J]; };
+
+        /// @brief coordinates (I, J) of the tiles in the order in which they are stored
+        const std::vector<std::pair<std::uint32_t, std::uint32_t>> &storage_order() const { return sequence; };
+
+        /// @brief copy a grid in the natural layout
+        /// @param natural n * n values, point (i, j) at i * n + j
+        void from_natural(const double *natural);
+
+        /// @brief copy the grid to the natural layout
+        /// @param natural n * n values, point (i, j) at i * n + j
+        void to_natural(double *natural) const;
+
+    private:
+        /// @brief number of rows and columns
+        size_t n;
+
+        /// @brief log2 of the side of a tile, and side of a tile minus one
+        size_t shift, mask;
+
+        /// @brief number of tiles of a row of tiles
+        size_t per_side;
+
+        /// @brief order of the tiles
+        Order tile_order;
+
+        /// @brief offset of tile (I, J) at I * per_side + J
+        std::vector<size_t> start;
+
+        /// @brief coordinates of the tiles in storage order
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> sequence;
+
+        /// @brief skew, then the values tile after tile
+        std::vector<double, memory::HugePageAllocator<double>> values;
+    };
+
+    /// @brief Jacobi sweep over the interior, tile after tile in storage order
+    /// @param u current iterate, the boundary is Dirichlet data
+    /// @param next new iterate (same size and tiles as u), its boundary is not written
+    /// @param rhs h^2 f at every grid point (same size and tiles as u)
+    /// @return sum of the squared differences between the new and the old values
+    double jacobi_sweep(const Grid &u, Grid &next, const Grid &rhs);
+
+    /// @brief full-weighting restriction of a fine grid to a coarse one, coarse tile after coarse tile
+    /// @param fine grid of n x n points
+    /// @param coarse grid of (n + 1) / 2 x (n + 1) / 2 points (n odd), coarse point (I, J) on fine point (2 I, 2 J);
+    ///        the boundary is injected. With the same tile side and Morton order, the fine tiles of a coarse tile
+    ///        are the four tiles of a node of the quadtree, one after the other.
+    void restrict_full_weighting(const Grid &fine, Grid &coarse);
+
+    /// @brief add the bilinear interpolation of a coarse grid to the interior of a fine one, fine tile after fine tile
+    /// @param coarse grid of (n + 1) / 2 x (n + 1) / 2 points, with the same tile side as fine
+    /// @param fine grid of n x n points (n odd)
+    void prolong_bilinear(const Grid &coarse, Grid &fine);
+} // namespace solver::tiled
+#endif // TILED_HPP
@@ -0,0 +1,73 @@
+/**
+ * @file topology.hpp
+ * @brief Topology-aware mapping of the row slabs to the processes
+ *
+ * The MPI solvers give the slabs to the ranks of their communicator in order, so rank r
+ * exchanges its ghost rows with ranks r - 1 and r + 1. This keeps the halo traffic inside
+ * the nodes only if the launcher places consecutive ranks on the same node; with a
+ * round-robin placement (--map-by node) every exchange crosses the network. The functions
+ * below find the node of every process (shared-memory sub-communicators) and build a
+ * communicator whose rank order keeps the ranks of a node together, either directly
+ * (node-major order) or by letting the MPI library reorder a Cartesian or a graph
+ * topology. The solvers use the new order through Solver::set_comm. The halo traffic of a
+ * given order can be split into intra- and inter-node bytes to compare the mappings.
+ */
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <mpi.h>
+
+/**
+ * @namespace solver::topology
+ * @brief Placement of the slabs on the nodes
+ */
+namespace solver::topology
+{
+    /// @brief method used to order the ranks
+    enum class Reorder
+    {
+        None,      ///< keep the order of the communicator
+        NodeMajor, ///< the ranks of every node consecutively, nodes in the order of their first rank
+        Cartesian, ///< MPI_Cart_create of a 1-D grid with reorder (the library decides)
+        Graph      ///< MPI_Graph_create of the chain of slabs with reorder (the library decides)
+    };
+
+    /// @brief parse the name of a method: none, node, cart or graph
+    /// @throws std::invalid_argument for an unknown name
+    Reorder parse(const std::string &name);
+
+    /// @brief node of every rank of a communicator (collective)
+    /// @param comm communicator
+    /// @param emulated_nodes if positive, process p of MPI_COMM_WORLD is considered on node p % emulated_nodes
+    ///                       (a round-robin placement, to try the mappings on a single node)
+    /// @return node of each rank of comm, identified by the MPI_COMM_WORLD rank of its first process in comm
+    std::vector<int> nodes(MPI_Comm comm, int emulated_nodes = 0);
+
+    /// @brief communicator with the same processes as comm, ordered for the row slabs (collective)
+    /// @param comm communicator to be reordered
+    /// @param method ordering method
+    /// @param emulated_nodes see nodes (only used by NodeMajor: the library knows the real nodes only)
+    /// @return new communicator, to be freed by the caller with MPI_Comm_free. With NodeMajor rank 0 of
+    ///         comm stays rank 0; with Cartesian and Graph the library may move it.
+    MPI_Comm reorder(MPI_Comm comm, Reorder method, int emulated_nodes = 0);
+
+    /// @brief halo traffic of an iteration of the row-slab solvers
+    struct Traffic
+    {
+        /// @brief bytes exchanged between ranks of the same node and of different nodes
+        double intra_bytes = 0.0, inter_bytes = 0.0;
+
+        /// @brief pairs of neighbouring slabs on different nodes
+        int inter_neighbours = 0;
+    };
+
+    /// @brief halo traffic of an iteration on an n x n grid, with the slabs in the order of comm (collective)
+    /// @param comm communicator of the solver
+    /// @param n size of the grid
+    /// @param emulated_nodes see nodes
+    Traffic halo_traffic(MPI_Comm comm, size_t n, int emulated_nodes = 0);
+} // namespace solver::topology
+#endif // TOPOLOGY_HPP
@@ -0,0 +1,135 @@
+/**
+ * @file trace.hpp
+ * @brief Opt-in per-rank and per-thread event timeline of the solvers
+ *
+ * Aggregate timings do not show when a process waits for its neighbours. When the
+ * tracer is enabled, every phase of an iteration (sweep, exchange, reduction, ...)
+ * is recorded as a begin/end pair in a buffer preallocated for each thread, so that
+ * recording an event costs two clock reads and a store. At the end of the run the
+ * events of all the processes are shifted to the clock of rank 0 (whose offsets are
+ * estimated with MPI ping-pongs when the tracer starts) and written on rank 0 as a
+ * Chrome trace, which can be opened with chrome://tracing or https://ui.perfetto.dev.
+ */
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mpi.h>
+
+/**
+ * @namespace solver::trace
+ * @brief Event timeline of the solvers
+ */
+namespace solver::trace
+{
+    /// @brief phases of the solvers recorded by the tracer
+    enum class Phase : unsigned char
+    {
+        Scatter,   ///< distribution of the initial guess
+        Sweep,     ///< update of (a part of) the grid
+        Exchange,  ///< halo exchange with the neighbouring processes
+        Reduction, ///< reduction of the residual
+        Gather,    ///< collection of the solution on rank 0
+        Solve      ///< whole solve
+    };
+
+    /// @brief number of phases
+    constexpr size_t phase_count = 6;
+
+    /// @brief name of a phase, as shown in the timeline
+    const char *phase_name(Phase phase);
+
+    /// @brief one completed phase
+    struct Event
+    {
+        /// @brief start time (MPI_Wtime of the local process, in seconds)
+        double begin;
+
+        /// @brief end time (MPI_Wtime of the local process, in seconds)
+        double end;
+
+        /// @brief index of the thread in the process (order of the first event)
+        unsigned thread;
+
+        /// @brief recorded phase
+        Phase phase;
+    };
+
+    /// @brief true while the tracer is recording (checked before reading the clock)
+    extern std::atomic<bool> enabled;
+
+    /// @brief number of users of phase_seconds (telemetry publishers, energy measurements); the time
+    ///        spent in each phase is accumulated while it is positive (checked before reading the clock)
+    extern std::atomic<unsigned> accumulating;
+
+    /// @brief time spent by the calling thread in each phase while the clock was read (seconds)
+    /// @details a running total that is never reset: its users keep their own baseline
+    extern thread_local double phase_seconds[phase_count];
+
+    /// @brief time spent by all the threads of the process in each phase while the clock was read (thread-seconds)
+    /// @details a running total that is never reset, like phase_seconds; the threads of a team add up
+    extern std::atomic<double> team_phase_seconds[phase_count];
+
+    /// @brief start recording
+    /// @param comm communicator of the processes to be traced (collective)
+    /// @param capacity maximum number of events per thread; events beyond it are dropped
+    /// @details estimates the offset of the clock of each process with respect to rank 0
+    void start(MPI_Comm comm = MPI_COMM_WORLD, size_t capacity = 1 << 18);
+
+    /// @brief stop recording and write the events of all the processes (collective)
+    /// @param filename output file, written by rank 0 only
+    /// @param comm communicator passed to start
+    /// @return number of events written (on rank 0), zero elsewhere
+    size_t write(const std::string &filename, MPI_Comm comm = MPI_COMM_WORLD);
+
+    /// @brief record a completed phase of the calling thread
+    /// @param phase recorded phase
+    /// @param begin start time (MPI_Wtime)
+    /// @param end end time (MPI_Wtime)
+    void record(Phase phase, double begin, double end);
+
+    /// @brief get the events recorded by the calling process so far
+    std::vector<Event> local_events();
+
+    /**
+     * @brief RAII scope recording a phase from its construction to its destruction
+     */
+    class Scope
+    {
+    public:
+        /// @brief begin a phase
+        /// @param phase recorded phase
+        explicit Scope(Phase phase)
+            : phase(phase), begin((enabled.load(std::memory_order_relaxed) || accumulating.load(std::memory_order_relaxed) > 0)
+                                      ? MPI_Wtime()
+                                      : -1.0)
+        {
+        }
+
+        /// @brief end the phase
+        ~Scope()
+        {
+            if (begin >= 0.0)
+            {
+                const double end = MPI_Wtime();
+                phase_seconds[static_cast<size_t>(phase)] += end - begin;
+                team_phase_seconds[static_cast<size_t>(phase)].fetch_add(end - begin, std::memory_order_relaxed);
+                if (enabled.load(std::memory_order_relaxed))
+                    record(phase, begin, end);
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        /// @brief recorded phase
+        Phase phase;
+
+        /// @brief start time, negative if neither the tracer nor the accumulation was enabled
+        double begin;
+    };
+} // namespace solver::trace
+#endif // TRACE_HPP
@@ -0,0 +1,123 @@
+/**
+ * @file tuner.hpp
+ * @brief Auto-tuning of the parameters of the threaded solvers, with an on-disk cache
+ *
+ * The best number of threads, threading backend, halo exchange strategy and tile size
+ * depend on the machine and on the grid size. The Tuner benchmarks a set of candidate
+ * configurations with a few iterations of the solver and stores the winner in a
+ * tuning cache (a CSV file) keyed by a fingerprint of the hardware, made of the same
+ * fields reported by docs/generate_hw_info.sh. Later runs on the same machine read
+ * the configuration from the cache instead of benchmarking again.
+ */
+#ifndef TUNER_HPP
+#define TUNER_HPP
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+#include "solver.hpp"
+
+namespace solver
+{
+    /**
+     * @brief Tunable parameters of the threaded solvers
+     */
+    struct TuningConfig
+    {
+        /// @brief number of threads of each team
+        unsigned num_threads = 2;
+
+        /// @brief threading backend
+        ThreadBackend backend = ThreadBackend::Native;
+
+        /// @brief true to overlap the halo exchange with computation (solve_jacobi_hybrid_tasks)
+        bool overlap = false;
+
+        /// @brief rows of the tiles of the task-based solver (0 for four tiles per thread)
+        size_t tile_rows = 0;
+
+        /// @brief time of the benchmark of this configuration (seconds)
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Problem a configuration has been tuned for
+     */
+    struct TuningKey
+    {
+        /// @brief tuned method ("jacobi_omp" or "jacobi_hybrid")
+        std::string method;
+
+        /// @brief grid size
+        size_t n = 0;
+
+        /// @brief number of MPI processes
+        int ranks = 1;
+
+        /// @brief maximum number of threads per process allowed to the tuner
+        unsigned threads = 1;
+    };
+
+    /**
+     * @class Tuner
+     * @brief Benchmark candidate configurations and cache the best one for each problem
+     */
+    class Tuner
+    {
+    public:
+        /// @brief constructor
+        /// @param cache_file path of the tuning cache
+        /// @param iterations number of Jacobi iterations of each benchmark
+        explicit Tuner(const std::string &cache_file = "tuning_cache.csv", unsigned iterations = 100)
+            : cache_file(cache_file), iterations(iterations)
+        {
+        }
+
+        /// @brief get the best configuration of a method, benchmarking it if it is not cached
+        /// @param solver solver with the problem set up (it is copied, not modified)
+        /// @param method "jacobi_omp" or "jacobi_hybrid"
+        /// @param max_threads maximum number of threads per process
+        /// @param comm processes running the method (collective over comm)
+        /// @return best configuration, the same on every process
+        TuningConfig tune(const Solver &solver, const std::string &method, unsigned max_threads, MPI_Comm comm = MPI_COMM_WORLD);
+
+        /// @brief apply a configuration to a solver
+        static void apply(Solver &solver, const TuningConfig &config);
+
+        /// @brief hardware fingerprint of the calling process
+        /// @details hash of CPU model, cores, logical processors, cache sizes and memory,
+        ///          i.e. the fields reported by docs/generate_hw_info.sh
+        static std::string hardware_fingerprint();
+
+        /// @brief true if the last call to tune read the configuration from the cache
+        bool cache_hit() const
+        {
+            return last_hit;
+        }
+
+    private:
+        /// @brief look up a configuration in the cache
+        /// @return true if found
+        bool lookup(const std::string &fingerprint, const TuningKey &key, TuningConfig &config) const;
+
+        /// @brief append a configuration to the cache
+        void store(const std::string &fingerprint, const TuningKey &key, const TuningConfig &config) const;
+
+        /// @brief candidate configurations of a method
+        std::vector<TuningConfig> candidates(const std::string &method, unsigned max_threads) const;
+
+        /// @brief time a few iterations of a method with a configuration (maximum over comm)
+        double benchmark(const Solver &solver, const std::string &method, const TuningConfig &config, MPI_Comm comm) const;
+
+        /// @brief path of the tuning cache
+        std::string cache_file;
+
+        /// @brief number of Jacobi iterations of each benchmark
+        unsigned iterations;
+
+        /// @brief true if the last call to tune read the configuration from the cache
+        bool last_hit = false;
+    };
+} // namespace solver
+#endif // TUNER_HPP
@@ -34,6 +34,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <iterator>
+#include <cctype>
 #include <mpParser.h>
 
 
@@ -205,5 +208,106 @@ namespace muparser
         /// @brief The number of variables in the expression
         mutable unsigned N;
     }; // class muParserXInterface    
+
+    /*!
+     * Split an expression of x[0] and x[1] into a product g(x[0]) * h(x[1]).
+     *
+     * The expression is split at the top-level multiplications and divisions; it is
+     * separable if every factor depends on x[0] only, on x[1] only or on neither
+     * (constants go into g). Parenthesized factors are split recursively, so
+     * "2 * (sin(x[0]) * x[1])" is separable while "sin(x[0] * x[1])" or
+     * "x[0] + x[1]" are not. The test is purely syntactic: an expression that is
+     * separable only after simplification is reported as not separable.
+     *
+     * @param expression the muParserX expression
+     * @param g expression of the factor depending on x[0] (output)
+     * @param h expression of the factor depending on x[1] (output)
+     * @return true if the expression has been split
+     */
+    inline bool split_separable(const string_type &expression, string_type &g, string_type &h)
+    {
+        string_type e;
+        std::remove_copy_if(expression.begin(), expression.end(), std::back_inserter(e), [](char c)
+                            { return c == ' ' || c == '\t'; });
+
+        // Remove the parentheses enclosing the whole expression
+        auto enclosed = [](const string_type &text)
+        {
+            if (text.size() < 2 || text.front() != '(' || text.back() != ')')
+                return false;
+            int depth = 0;
+            for (size_t k = 0; k + 1 < text.size(); ++k)
+            {
+                depth += (text[k] == '(') - (text[k] == ')');
+                if (depth == 0)
+                    return false;
+            }
+            return true;
+        };
+        while (enclosed(e))
+            e = e.substr(1, e.size() - 2);
+        if (e.empty())
+            return false;
+
+        // Split at the top-level '*' and '/', rejecting top-level '+' and binary '-'
+        std::vector<std::pair<char, string_type>> factors;
+        int depth = 0;
+        size_t begin = 0;
+        char op = '*';
+        for (size_t k = 0; k <= e.size(); ++k)
+        {
+            const char c = (k < e.size()) ? e[k] : '\0';
+            if (c == '(' || c == '[')
+                ++depth;
+            else if (c == ')' || c == ']')
+                --depth;
+            else if (depth == 0 && (c == '+' || c == '-') && k > 0)
+            {
+                // Unary signs and exponents of numbers (1e-3) do not split the expression
+                const char prev = e[k - 1];
+                const bool exponent = (prev == 'e' || prev == 'E') && k > 1 && std::isdigit(static_cast<unsigned char>(e[k - 2]));
+                if (string_type("*/^(,+-").find(prev) == string_type::npos && !exponent)
+                {
+                    factors.clear();
+                    break;
+                }
+            }
+            else if (depth == 0 && (c == '*' || c == '/' || c == '\0'))
+            {
+                // '**' is not a muParserX operator, so an empty factor is an error
+                if (k == begin)
+                    return false;
+                factors.emplace_back(op, e.substr(begin, k - begin));
+                op = c;
+                begin = k + 1;
+            }
+        }
+
+        if (factors.size() <= 1)
+        {
+            // A sum or a single factor is separable only if it does not depend on both variables
+            const bool has_x = e.find("x[0]") != string_type::npos, has_y = e.find("x[1]") != string_type::npos;
+            if (has_x && has_y)
+                return false;
+            g = has_y ? "1" : e;
+            h = has_y ? e : "1";
+            return true;
+        }
+
+        string_type g_split = "1", h_split = "1";
+        for (const auto &[factor_op, factor] : factors)
+        {
+            string_type g_factor, h_factor;
+            if (!split_separable(factor, g_factor, h_factor))
+                return false;
+            if (g_factor != "1")
+                g_split += factor_op + ("(" + g_factor + ")");
+            if (h_factor != "1")
+                h_split += factor_op + ("(" + h_factor + ")");
+        }
+        g = g_split;
+        h = h_split;
+        return true;
+    }
 } // namespace muparser
 #endif // MUPARSERX_INTERFACE_HPP
\ No newline at end of file
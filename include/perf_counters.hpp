@@ -0,0 +1,109 @@
+/**
+ * @file perf_counters.hpp
+ * @brief Thin wrapper around Linux perf_event_open for hardware event counting in the benchmarks.
+ *
+ * The counters are optional: if the kernel does not allow perf events (e.g. because of
+ * /proc/sys/kernel/perf_event_paranoid or inside containers), the counter is marked as
+ * unavailable and reads return -1, so that the benchmark can still run and report "n/a".
+ */
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/**
+ * @namespace perf
+ * @brief Hardware performance counters used by the benchmark driver
+ */
+namespace perf
+{
+    /// @brief hardware events that can be counted
+    enum class Event
+    {
+        DTLBLoadMisses, ///< data TLB read misses
+        LLCLoadMisses,  ///< last level cache read misses
+        L1DLoadMisses   ///< L1 data cache read misses
+    };
+
+    /**
+     * @brief RAII hardware counter for the calling thread (and the threads it spawns)
+     */
+    class Counter
+    {
+    public:
+        /// @brief open a counter for the given event
+        /// @param event hardware event to count
+        explicit Counter(Event event)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            switch (event)
+            {
+            case Event::DTLBLoadMisses:
+                attr.config = PERF_COUNT_HW_CACHE_DTLB;
+                break;
+            case Event::LLCLoadMisses:
+                attr.config = PERF_COUNT_HW_CACHE_LL;
+                break;
+            case Event::L1DLoadMisses:
+                attr.config = PERF_COUNT_HW_CACHE_L1D;
+                break;
+            }
+            attr.config |= (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        Counter(const Counter &) = delete;
+        Counter &operator=(const Counter &) = delete;
+
+        ~Counter()
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+
+        /// @brief true if the kernel allowed opening the counter
+        bool available() const
+        {
+            return fd >= 0;
+        }
+
+        /// @brief reset and start counting
+        void start()
+        {
+            if (fd < 0)
+                return;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        /// @brief stop counting and return the number of events (-1 if unavailable)
+        int64_t stop()
+        {
+            if (fd < 0)
+                return -1;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            int64_t count = 0;
+            if (read(fd, &count, sizeof(count)) != sizeof(count))
+                return -1;
+            return count;
+        }
+
+    private:
+        /// @brief file descriptor of the perf event (-1 if unavailable)
+        int fd = -1;
+    };
+}
+
+#endif // PERF_COUNTERS_HPP
@@ -12,7 +12,7 @@
  * - CSVReader: Class for reading and parsing CSV data files
  * - Plotter: Class for creating data files and gnuplot scripts
  * - gridSizeTest(): Function for analyzing performance vs grid size
- * - scalabilityTest(): Function for analyzing scalability across multiple processes
+ * - scalabilityTest(): Function for plotting the results of the scaling experiments
  *
  * The plotting utilities support:
  * - Timing analysis for different parallelization methods (Serial, OMP, MPI, Hybrid)
@@ -37,6 +37,8 @@
 #include <algorithm>
 #include <iomanip>
 
+#include "scaling.hpp"
+
 /**
  * @namespace plot
  * @brief Namespace containing utilities for data visualization and plotting of computational results.
@@ -407,78 +409,76 @@ namespace plot
     }
 
     /**
-     * @brief Function to perform scalability tests and generate plots.
-     * This function reads data from CSV files in the specified directory,
-     * extracts timing data for different grid sizes, and generates a plot
-     * showing how the execution time scales with the number of processes.
+     * @brief Function to plot the results of the scaling experiments.
+     * This function reads the structured output of the scaling driver
+     * (test/data/scaling/strong.csv and test/data/scaling/weak.csv, see scaling.hpp)
+     * and, for each experiment found, plots time and parallel efficiency against the
+     * number of processes, with one series per number of threads.
      */
     void scalabilityTest()
     {
-        std::vector<int> processes = {1, 2, 4};
-        std::vector<int> grid_sizes = {56, 64};
+        fs::create_directories("test/plots");
 
-        std::vector<double> proc_double;
-        for (int p : processes)
+        for (const std::string mode : {"strong", "weak"})
         {
-            proc_double.push_back(static_cast<double>(p));
-        }
-
-        std::vector<std::vector<double>> scalability_data;
-        std::vector<std::string> scalability_labels;
-
-        namespace fs = std::filesystem;
+            const std::string filename = "test/data/scaling/" + mode + ".csv";
+            if (!fs::exists(filename))
+                continue;
 
-        std::vector<fs::directory_entry> entries;
+            std::vector<solver::scaling::Point> points = solver::scaling::read_csv(filename);
 
-        // Collect entries
-        for (const auto &entry : fs::directory_iterator("test/data"))
-        {
-            if (entry.path().extension() == ".csv")
+            // Processes on the x axis, one series per number of threads
+            std::vector<int> ranks;
+            std::vector<unsigned> threads;
+            for (const auto &point : points)
             {
-                entries.push_back(entry);
+                if (std::find(ranks.begin(), ranks.end(), point.ranks) == ranks.end())
+                    ranks.push_back(point.ranks);
+                if (std::find(threads.begin(), threads.end(), point.threads) == threads.end())
+                    threads.push_back(point.threads);
             }
-        }
-
-        // Sort entries alphabetically by filename
-        std::sort(entries.begin(), entries.end(),
-                  [](const fs::directory_entry &a, const fs::directory_entry &b)
-                  {
-                      return a.path().filename() < b.path().filename();
-                  });
-
-        for (int n : grid_sizes)
-        {
-            std::vector<double> timings;
+            std::sort(ranks.begin(), ranks.end());
+            std::sort(threads.begin(), threads.end());
 
-            // Read all CSV files in data directory
-            // Iterate in sorted order
-            for (const auto &entry : entries)
+            std::vector<double> proc_double(ranks.begin(), ranks.end());
+            std::vector<std::vector<double>> time_data, efficiency_data;
+            std::vector<std::string> labels;
+            for (unsigned t : threads)
             {
-                std::vector<DataRow> data = CSVReader::readCSV(entry.path().string());
-
-                for (const auto &row : data)
+                std::vector<double> times, efficiencies;
+                for (int r : ranks)
                 {
-                    if (row.n == n)
+                    for (const auto &point : points)
                     {
-                        timings.push_back(row.hybrid);
-                        break;
+                        if (point.ranks == r && point.threads == t)
+                        {
+                            times.push_back(point.seconds);
+                            efficiencies.push_back(point.efficiency);
+                        }
                     }
                 }
+                // Only complete series can be written next to the others
+                if (times.size() == ranks.size())
+                {
+                    time_data.push_back(times);
+                    efficiency_data.push_back(efficiencies);
+                    labels.push_back(std::to_string(t) + " threads");
+                }
             }
 
-            if (timings.size() == processes.size())
-            {
-                scalability_data.push_back(timings);
-                scalability_labels.push_back("n=" + std::to_string(n));
-            }
+            const std::string base = "test/plots/scaling_" + mode;
+            Plotter::writeDataFile(base + "_time.dat", proc_double, time_data, labels);
+            Plotter::createGnuplotScript(base + "_time.gp", base + "_time.dat",
+                                         "Scaling (" + mode + ")",
+                                         "Number of Processes", "Time (s)",
+                                         labels, true, true, base + "_time.png");
+            Plotter::writeDataFile(base + "_efficiency.dat", proc_double, efficiency_data, labels);
+            Plotter::createGnuplotScript(base + "_efficiency.gp", base + "_efficiency.dat",
+                                         "Parallel efficiency (" + mode + ")",
+                                         "Number of Processes", "Efficiency",
+                                         labels, true, false, base + "_efficiency.png");
+            Plotter::printDataSummary("Parallel efficiency (" + mode + ")", proc_double, efficiency_data, labels);
         }
-
-        Plotter::writeDataFile("test/plots/scalability.dat", proc_double, scalability_data, scalability_labels);
-        Plotter::createGnuplotScript("test/plots/scalability.gp", "test/plots/scalability.dat",
-                                     "Scalability Test",
-                                     "Number of Processes", "Time (s)",
-                                     scalability_labels, true, false);
-        Plotter::printDataSummary("Scalability Test", proc_double, scalability_data, scalability_labels);
     }
 
     /// @brief Function to plot results after all computations are done.
@@ -25,11 +25,13 @@ namespace vtk
      * This function exports a flattened 2D grid of size n x n to a VTK file,
      * allowing visualization with tools that support the VTK format.
      *
+     * @tparam Allocator allocator of the grid vector.
      * @param grid      Flattened 2D grid data of size n x n (row-major order).
      * @param n         The dimension of the grid (number of rows and columns).
      * @param filename  Output VTK file name (default is "output.vtk").
      */
-    inline void write(const std::vector<double> &grid, const std::string &filename = "output.vtk")
+    template <typename Allocator>
+    inline void write(const std::vector<double, Allocator> &grid, const std::string &filename = "output.vtk")
     {
         int n = std::sqrt(grid.size());
         std::cout << "Writing VTK file: " << filename << std::endl;        
@@ -0,0 +1,282 @@
+/// @file batch.cpp
+/// @brief This file contains the implementation of the BatchSolver class.
+/// @details Problems are distributed among the MPI processes balancing their estimated
+///          cost, and among the threads of each process through work-stealing queues.
+///          Each problem is solved serially with an in-place Jacobi kernel.
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <omp.h>
+#include <mpi.h>
+
+#include "batch.hpp"
+#include "kernels.hpp"
+#include "thread_pool.hpp"
+
+namespace solver
+{
+    namespace
+    {
+        /// @brief set the boundary conditions and h^2 f of a problem
+        /// @param problem problem definition
+        /// @param grid grid of size n * n, zero in the interior
+        /// @param rhs h^2 f at every grid point (size n * n)
+        void setup(const Problem &problem, double *grid, double *rhs)
+        {
+            const size_t n = problem.n;
+            const double h = 1.0 / (n - 1);
+            auto at = [n](const std::function<double(std::vector<double>)> &fun, size_t i, size_t j)
+            { return fun({static_cast<double>(i) / (n - 1), static_cast<double>(j) / (n - 1)}); };
+
+            // Same order as in the Solver class, so that the corners are identical
+            for (size_t i = 0; i < n; ++i)
+            {
+                grid[i] = at(problem.top_bc, 0, i);                      // Top boundary
+                grid[i * n + (n - 1)] = at(problem.right_bc, i, n - 1);  // Right boundary
+                grid[(n - 1) * n + i] = at(problem.bottom_bc, n - 1, i); // Bottom boundary
+                grid[i * n] = at(problem.left_bc, i, 0);                 // Left boundary
+            }
+
+            // The force term is evaluated once instead of at every iteration
+            for (size_t i = 1; i < n - 1; ++i)
+                for (size_t j = 1; j < n - 1; ++j)
+                    rhs[i * n + j] = h * h * at(problem.f, i, j);
+        }
+
+        /// @brief Jacobi iterations with a compile-time-fixed-size kernel
+        /// @return number of iterations performed
+        template <size_t N>
+        unsigned iterate_fixed(double *grid, const double *rhs, unsigned max_iter, double tol, double &residual)
+        {
+            for (unsigned iteration = 0; iteration < max_iter; ++iteration)
+            {
+                residual = std::sqrt(1.0 / (N - 1) * kernels::jacobi_sweep_fixed<N>(grid, rhs));
+                if (residual < tol)
+                    return iteration + 1;
+            }
+            return max_iter;
+        }
+
+        /// @brief Jacobi iterations for any grid size
+        /// @return number of iterations performed
+        unsigned iterate(size_t n, double *grid, const double *rhs, unsigned max_iter, double tol, double &residual)
+        {
+            std::vector<double> above(n), current(n);
+            auto f = [rhs, n](size_t i, size_t j)
+            { return rhs[i * n + j]; };
+            for (unsigned iteration = 0; iteration < max_iter; ++iteration)
+            {
+                std::copy(grid, grid + n, above.begin());
+                double diff = kernels::jacobi_sweep_inplace(grid, n, 1, n - 1, above, current, grid + (n - 1) * n, f);
+                residual = std::sqrt(1.0 / (n - 1) * diff);
+                if (residual < tol)
+                    return iteration + 1;
+            }
+            return max_iter;
+        }
+    }
+
+    BatchResult BatchSolver::solve_one(const Problem &problem)
+    {
+        const size_t n = problem.n;
+        if (n < 3)
+            throw std::invalid_argument("The grid size of a problem must be at least 3");
+        BatchResult result;
+        result.uh.assign(n * n, 0.0);
+
+        // Scratch buffer for h^2 f, reused by all the problems solved by this thread
+        thread_local std::vector<double> rhs;
+        rhs.assign(n * n, 0.0);
+
+        setup(problem, result.uh.data(), rhs.data());
+
+        double *grid = result.uh.data();
+        switch (n)
+        {
+        case 8:
+            result.iter = iterate_fixed<8>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 16:
+            result.iter = iterate_fixed<16>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 24:
+            result.iter = iterate_fixed<24>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 32:
+            result.iter = iterate_fixed<32>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 40:
+            result.iter = iterate_fixed<40>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 48:
+            result.iter = iterate_fixed<48>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 56:
+            result.iter = iterate_fixed<56>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        case 64:
+            result.iter = iterate_fixed<64>(grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        default:
+            result.iter = iterate(n, grid, rhs.data(), problem.max_iter, problem.tol, result.residual);
+            break;
+        }
+        return result;
+    }
+
+    std::vector<BatchResult> BatchSolver::solve(const std::vector<Problem> &problems, int root)
+    {
+        int mpi_rank, mpi_size;
+        MPI_Comm_rank(comm, &mpi_rank);
+        MPI_Comm_size(comm, &mpi_size);
+
+        // The workers cannot report an error: check every problem before they start
+        for (const Problem &problem : problems)
+            if (problem.n < 3)
+                throw std::invalid_argument("The grid size of a problem must be at least 3");
+
+        const double start = MPI_Wtime();
+
+        // Estimated cost of each problem: Jacobi needs O(n^2) iterations of O(n^2) updates
+        std::vector<double> cost(problems.size());
+        for (size_t p = 0; p < problems.size(); ++p)
+        {
+            const double n = static_cast<double>(problems[p].n);
+            cost[p] = n * n * std::min(n * n, static_cast<double>(problems[p].max_iter));
+        }
+
+        // Assign problems to ranks with the longest-processing-time-first rule
+        // (deterministic, so every rank computes the same assignment)
+        std::vector<size_t> order(problems.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return cost[a] > cost[b]; });
+        std::vector<int> owner(problems.size());
+        std::vector<double> load(mpi_size, 0.0);
+        for (size_t p : order)
+        {
+            int target = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+            owner[p] = target;
+            load[target] += cost[p];
+        }
+
+        // Number of worker threads
+#ifdef _OPENMP
+        const unsigned threads = (num_threads > 0) ? num_threads : static_cast<unsigned>(omp_get_max_threads());
+#else
+        const unsigned threads = (num_threads > 0) ? num_threads : ThreadPool::default_threads();
+#endif
+
+        // Deal the local problems to the queues, the most expensive first
+        std::vector<WorkStealingQueue> queues(threads);
+        size_t local_count = 0;
+        for (size_t p : order)
+        {
+            if (owner[p] == mpi_rank)
+                queues[local_count++ % threads].push(p);
+        }
+
+        std::vector<BatchResult> results(problems.size());
+        std::atomic<size_t> remaining{local_count};
+        std::atomic<size_t> steals{0};
+
+        // Each thread solves the problems of its queue, then steals from the others
+        auto worker = [&](unsigned thread_id)
+        {
+            size_t task;
+            while (remaining.load() > 0)
+            {
+                bool found = queues[thread_id].pop(task);
+
+                // Own queue is empty: try to steal from the other threads
+                for (unsigned k = 1; !found && k < threads; ++k)
+                {
+                    found = queues[(thread_id + k) % threads].steal(task);
+                    if (found)
+                        ++steals;
+                }
+
+                if (found)
+                {
+                    results[task] = solve_one(problems[task]);
+                    --remaining;
+                }
+                else
+                {
+                    // Everything has been taken, the last problems are still running
+                    std::this_thread::yield();
+                }
+            }
+        };
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+        worker(omp_get_thread_num());
+#else
+        ThreadPool::instance().run(threads, [&](unsigned thread_id, unsigned)
+                                   { worker(thread_id); });
+#endif
+
+        // Gather the results on root: for each problem iter, residual and the n * n values
+        auto packed_size = [&](size_t p)
+        { return static_cast<int>(2 + problems[p].n * problems[p].n); };
+
+        std::vector<int> counts(mpi_size, 0), displs(mpi_size, 0);
+        for (size_t p = 0; p < problems.size(); ++p)
+            counts[owner[p]] += packed_size(p);
+        for (int r = 1; r < mpi_size; ++r)
+            displs[r] = displs[r - 1] + counts[r - 1];
+
+        std::vector<double> send_buffer;
+        send_buffer.reserve(counts[mpi_rank]);
+        for (size_t p = 0; p < problems.size(); ++p)
+        {
+            if (owner[p] != mpi_rank)
+                continue;
+            send_buffer.push_back(static_cast<double>(results[p].iter));
+            send_buffer.push_back(results[p].residual);
+            send_buffer.insert(send_buffer.end(), results[p].uh.begin(), results[p].uh.end());
+        }
+
+        std::vector<double> recv_buffer;
+        if (mpi_rank == root)
+            recv_buffer.resize(displs[mpi_size - 1] + counts[mpi_size - 1]);
+
+        MPI_Gatherv(send_buffer.data(), counts[mpi_rank], MPI_DOUBLE,
+                    recv_buffer.data(), counts.data(), displs.data(), MPI_DOUBLE, root, comm);
+
+        if (mpi_rank == root)
+        {
+            // Unpack in the same order the owners packed them
+            std::vector<int> offset = displs;
+            for (size_t p = 0; p < problems.size(); ++p)
+            {
+                const double *data = recv_buffer.data() + offset[owner[p]];
+                offset[owner[p]] += packed_size(p);
+                if (owner[p] == root)
+                    continue;
+                const size_t values = problems[p].n * problems[p].n;
+                results[p].iter = static_cast<unsigned>(data[0]);
+                results[p].residual = data[1];
+                results[p].uh.assign(data + 2, data + 2 + values);
+            }
+        }
+
+        // Throughput statistics
+        double elapsed = MPI_Wtime() - start;
+        unsigned long local_steals = steals.load(), total_steals = 0;
+        MPI_Allreduce(&elapsed, &batch_stats.seconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+        MPI_Allreduce(&local_steals, &total_steals, 1, MPI_UNSIGNED_LONG, MPI_SUM, comm);
+        batch_stats.problems = problems.size();
+        batch_stats.steals = total_steals;
+        batch_stats.solves_per_second = (batch_stats.seconds > 0.0) ? problems.size() / batch_stats.seconds : 0.0;
+
+        return results;
+    }
+}
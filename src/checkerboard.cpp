@@ -0,0 +1,93 @@
+/// @file checkerboard.cpp
+/// @brief This file contains the implementation of the red/black split grids.
+
+#include "checkerboard.hpp"
+
+namespace solver::checkerboard
+{
+    namespace
+    {
+        /// @brief values of a cache line
+        constexpr size_t line = 64 / sizeof(double);
+
+        /// @brief stride of the rows of a colour: (n + 1) / 2 values rounded up to an odd number of cache lines
+        size_t row_stride(size_t n)
+        {
+            const size_t lines = ((n + 1) / 2 + line - 1) / line;
+            return (lines | 1) * line;
+        }
+    }
+
+    Grid::Grid(size_t n)
+        : n(n), half(row_stride(n)), red(n * half, 0.0), black((n + 1) * half, 0.0)
+    {
+    }
+
+    void Grid::split(const double *natural)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double *source = natural + i * n;
+            for (Colour colour : {Colour::Red, Colour::Black})
+            {
+                double *target = row(colour, i);
+                for (size_t j = offset(colour, i), q = 0; j < n; j += 2, ++q)
+                    target[q] = source[j];
+            }
+        }
+    }
+
+    void Grid::merge(double *natural) const
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            double *target = natural + i * n;
+            for (Colour colour : {Colour::Red, Colour::Black})
+            {
+                const double *source = row(colour, i);
+                for (size_t j = offset(colour, i), q = 0; j < n; j += 2, ++q)
+                    target[j] = source[q];
+            }
+        }
+    }
+
+    double sweep(Grid &u, const Grid &rhs, Colour colour, size_t first, size_t last)
+    {
+        const size_t n = u.size();
+        const Colour neighbour = other(colour);
+        double diff{0.0};
+        for (size_t i = first; i < last; ++i)
+        {
+            // Point q of the row is at column j = 2 q + s: its neighbours (i -/+ 1, j) are point q
+            // of the rows above and below, (i, j -/+ 1) are points q + s - 1 and q + s of the row
+            const size_t s = offset(colour, i);
+            double *__restrict x = u.row(colour, i);
+            const double *__restrict up = u.row(neighbour, i - 1);
+            const double *__restrict down = u.row(neighbour, i + 1);
+            const double *__restrict side = u.row(neighbour, i) + s;
+            const double *__restrict f = rhs.row(colour, i);
+
+            // Interior columns 1 <= 2 q + s <= n - 2
+            const size_t begin = 1 - s, end = (n - 2 - s) / 2 + 1;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : diff)
+#endif
+            for (size_t q = begin; q < end; ++q)
+            {
+                const double value = 0.25 * (up[q] + down[q] + side[q - 1] + side[q] + f[q]);
+                const double delta = value - x[q];
+                diff += delta * delta;
+                x[q] = value;
+            }
+        }
+        return diff;
+    }
+
+    double sweep(Grid &u, const Grid &rhs)
+    {
+        const size_t n = u.size();
+        if (n < 3)
+            return 0.0;
+        return sweep(u, rhs, Colour::Red, 1, n - 1) + sweep(u, rhs, Colour::Black, 1, n - 1);
+    }
+} // namespace solver::checkerboard
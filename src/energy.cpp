@@ -0,0 +1,125 @@
+/// @file energy.cpp
+/// @brief This file contains the implementation of the RAPL energy measurements.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "energy.hpp"
+
+namespace solver::energy
+{
+    namespace
+    {
+        /// @brief directory of the powercap zones
+        const std::filesystem::path powercap_root = "/sys/class/powercap";
+
+        /// @brief first line of a file, empty if it cannot be read
+        std::string read_line(const std::filesystem::path &file)
+        {
+            std::ifstream ifs(file);
+            std::string line;
+            std::getline(ifs, line);
+            return line;
+        }
+
+        /// @brief value of a counter file, negative if it cannot be read
+        double read_counter(const std::string &file)
+        {
+            std::ifstream ifs(file);
+            double value = -1.0;
+            if (!(ifs >> value))
+                return -1.0;
+            return value;
+        }
+
+        /// @brief top-level RAPL zones with a readable counter
+        std::vector<Zone> discover()
+        {
+            std::vector<Zone> packages, platform;
+            std::error_code error;
+            for (const auto &entry : std::filesystem::directory_iterator(powercap_root, error))
+            {
+                // intel-rapl:<k> are the top-level zones (AMD processors use the same driver);
+                // intel-rapl:<k>:<j> are their subzones (core, dram, ...), already counted in them
+                const std::string id = entry.path().filename().string();
+                if (id.rfind("intel-rapl:", 0) != 0 || std::count(id.begin(), id.end(), ':') != 1)
+                    continue;
+                Zone zone{read_line(entry.path() / "name"), (entry.path() / "energy_uj").string(),
+                          read_counter((entry.path() / "max_energy_range_uj").string())};
+                if (read_counter(zone.counter) < 0.0)
+                    continue;
+                (zone.name == "psys" ? platform : packages).push_back(zone);
+            }
+
+            // The platform domain includes the packages: it is only used on its own
+            auto by_name = [](const Zone &a, const Zone &b)
+            { return a.name < b.name; };
+            std::sort(packages.begin(), packages.end(), by_name);
+            return packages.empty() ? platform : packages;
+        }
+    }
+
+    const std::vector<Zone> &zones()
+    {
+        static const std::vector<Zone> discovered = discover();
+        return discovered;
+    }
+
+    bool available()
+    {
+        return !zones().empty();
+    }
+
+    std::vector<double> read()
+    {
+        std::vector<double> counters;
+        counters.reserve(zones().size());
+        for (const Zone &zone : zones())
+            counters.push_back(read_counter(zone.counter));
+        return counters;
+    }
+
+    double joules(const std::vector<double> &begin, const std::vector<double> &end)
+    {
+        double microjoules = 0.0;
+        for (size_t z = 0; z < std::min(begin.size(), end.size()); ++z)
+        {
+            double delta = end[z] - begin[z];
+            if (delta < 0.0)
+                delta += zones()[z].max_range;
+            microjoules += delta;
+        }
+        return 1e-6 * microjoules;
+    }
+
+    Measurement::Measurement(Report &report, unsigned threads)
+        : report(report), threads(std::max(1u, threads))
+    {
+        if (available())
+        {
+            trace::accumulating.fetch_add(1, std::memory_order_relaxed);
+            for (size_t p = 0; p < trace::phase_count; ++p)
+                begin_phase[p] = trace::team_phase_seconds[p].load(std::memory_order_relaxed);
+            begin_counters = read();
+        }
+        begin_time = MPI_Wtime();
+    }
+
+    Measurement::~Measurement()
+    {
+        report = Report{};
+        report.seconds = MPI_Wtime() - begin_time;
+        if (begin_counters.empty())
+            return;
+
+        report.joules = joules(begin_counters, read());
+        trace::accumulating.fetch_sub(1, std::memory_order_relaxed);
+        for (size_t p = 0; p < trace::phase_count; ++p)
+        {
+            report.phase_seconds[p] = trace::team_phase_seconds[p].load(std::memory_order_relaxed) - begin_phase[p];
+            if (report.seconds > 0.0)
+                report.phase_joules[p] = report.joules * report.phase_seconds[p] / (report.seconds * threads);
+        }
+    }
+} // namespace solver::energy
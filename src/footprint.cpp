@@ -0,0 +1,245 @@
+/// @file footprint.cpp
+/// @brief This file contains the implementation of the memory accounting of the solves.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "footprint.hpp"
+#include "huge_page_allocator.hpp"
+
+namespace solver::footprint
+{
+    namespace
+    {
+        /// @brief value in kB of a field of a /proc file ("VmHWM:   1234 kB"), in bytes (0 if missing)
+        size_t read_field(const std::string &file, const std::string &field)
+        {
+            std::ifstream ifs(file);
+            std::string line;
+            while (std::getline(ifs, line))
+            {
+                if (line.compare(0, field.size(), field) != 0 || line.size() <= field.size() || line[field.size()] != ':')
+                    continue;
+                std::istringstream iss(line.substr(field.size() + 1));
+                size_t kb = 0;
+                iss >> kb;
+                return kb * 1024;
+            }
+            return 0;
+        }
+
+        /// @brief measurements alive on the calling thread
+        thread_local unsigned depth = 0;
+
+        /// @brief delete callback of the node communicators cached on the communicators of the solves
+        int free_node(MPI_Comm, int, void *value, void *)
+        {
+            MPI_Comm *node = static_cast<MPI_Comm *>(value);
+            MPI_Comm_free(node);
+            delete node;
+            return MPI_SUCCESS;
+        }
+
+        /// @brief communicator of the ranks of comm on the node of the calling rank, built on the first
+        ///        call and freed with comm
+        MPI_Comm node_of(MPI_Comm comm)
+        {
+            static int keyval = MPI_KEYVAL_INVALID;
+            if (keyval == MPI_KEYVAL_INVALID)
+                MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, free_node, &keyval, nullptr);
+
+            MPI_Comm *node = nullptr;
+            int found = 0;
+            MPI_Comm_get_attr(comm, keyval, &node, &found);
+            if (!found)
+            {
+                node = new MPI_Comm;
+                MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, node);
+                MPI_Comm_set_attr(comm, keyval, node);
+            }
+            return *node;
+        }
+
+        /// @brief bytes in MB, for the messages
+        std::string megabytes(size_t bytes)
+        {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MB";
+            return oss.str();
+        }
+    }
+
+    size_t rss_high_water()
+    {
+        return read_field("/proc/self/status", "VmHWM");
+    }
+
+    bool reset_rss_high_water()
+    {
+        // Writing 5 to clear_refs resets the peak resident set size (Linux 4.0 and later)
+        std::ofstream ofs("/proc/self/clear_refs");
+        ofs << "5";
+        ofs.flush();
+        return static_cast<bool>(ofs);
+    }
+
+    size_t available_memory()
+    {
+        return read_field("/proc/meminfo", "MemAvailable");
+    }
+
+    Prediction predict(const std::string &method, size_t n, size_t local_rows, unsigned threads, size_t recycle)
+    {
+        constexpr size_t word = sizeof(double);
+        auto grid = [](size_t points)
+        { return memory::reserved_bytes(points * word); };
+        const size_t slab = local_rows * n;
+
+        // Triplets, the matrix and its permuted copy (value and index per entry), b, x, and the factor
+        // of the system of the interior points of a block of rows. With the AMD ordering of Eigen the
+        // factor of a grid has about 3 m log2 m entries for m unknowns, and never more than a band
+        // matrix whose bandwidth is the smaller side of the block.
+        auto factorization = [](size_t rows, size_t cols)
+        {
+            const size_t unknowns = rows * cols;
+            const size_t fill = std::min<size_t>(std::min(rows, cols), 3 * std::log2(std::max<size_t>(2, unknowns)));
+            return unknowns * (5 * (2 * sizeof(int) + word) + 2 * 5 * (word + sizeof(int)) + 2 * word) +
+                   unknowns * fill * (word + sizeof(int));
+        };
+        const size_t interior_rows = (local_rows > 2) ? local_rows - 2 : 0, interior_cols = (n > 2) ? n - 2 : 0;
+
+        // Every method holds the global grid; the right-hand side factors take a row and a column
+        Prediction prediction;
+        prediction.grid_bytes = grid(n * n);
+        prediction.work_bytes = (local_rows + n) * word;
+
+        if (method == "jacobi_serial")
+            prediction.work_bytes += 2 * n * word;
+        else if (method == "jacobi_omp")
+            prediction.work_bytes += 3 * n * threads * word;
+        else if (method == "gauss_seidel_rb")
+        {
+            // The grid and h^2 f split by colour, two buffers each with rows of (n + 1) / 2 values padded
+            // by at most two cache lines, and h^2 f in the natural layout before the split
+            const size_t half = (n + 1) / 2 + 16;
+            prediction.grid_bytes += 4 * grid((n + 1) * half);
+            prediction.work_bytes += n * n * word;
+        }
+        else if (method == "jacobi_mpi")
+        {
+            prediction.grid_bytes += grid(slab);
+            prediction.work_bytes += 2 * n * word;
+        }
+        else if (method == "jacobi_hybrid" || method == "jacobi_hybrid_tasks")
+        {
+            // Rows of every thread (of every tile for the tasks), and the send buffers
+            prediction.grid_bytes += grid(slab);
+            prediction.work_bytes += (3 * threads + 2) * n * word;
+        }
+        else if (method == "direct_mpi")
+        {
+            // The slab and its previous value, and the system of the slab
+            prediction.grid_bytes += 2 * grid(slab);
+            prediction.work_bytes += factorization(interior_rows, interior_cols);
+        }
+        else if (method == "direct_hybrid")
+        {
+            // The slab, and the system of the strip of every thread, with its cached right-hand side
+            // and the two rows bordering it
+            prediction.grid_bytes += grid(slab);
+            const size_t strip_rows = (interior_rows + threads - 1) / std::max(1u, threads);
+            prediction.work_bytes += threads * (factorization(strip_rows, interior_cols) +
+                                                (strip_rows * interior_cols + 2 * n) * word);
+        }
+        else if (method == "cg_mpi")
+        {
+            // r, A u, p, A p and the previous A p, plus the recycled vectors and their products with A
+            prediction.grid_bytes += grid(slab);
+            prediction.work_bytes += (5 + 4 * recycle) * slab * word;
+        }
+        else if (method == "lifting")
+        {
+            prediction.grid_bytes += grid(n * n);
+            prediction.work_bytes += 3 * n * threads * word;
+        }
+        else if (method == "fast_poisson")
+        {
+            // The grid, h^2 f and the equations with the boundary values moved, and the coefficients of the transforms
+            prediction.grid_bytes += 3 * grid(n * n);
+            prediction.work_bytes += n * n * word;
+        }
+        else if (method == "incremental")
+        {
+            // As fast_poisson, plus the cached equations and solution
+            prediction.grid_bytes += 5 * grid(n * n);
+            prediction.work_bytes += n * n * word;
+        }
+
+        return prediction;
+    }
+
+    bool check(const std::string &method, const Prediction &prediction, MPI_Comm comm)
+    {
+        // The global grid is already allocated when the solve starts
+        const size_t resident = std::min(memory::allocated(), prediction.grid_bytes);
+        unsigned long long needed = prediction.total() - resident;
+
+        int node_rank = 0, node_ranks = 1;
+        MPI_Comm node = MPI_COMM_NULL;
+        if (comm != MPI_COMM_NULL)
+        {
+            node = node_of(comm);
+            MPI_Comm_rank(node, &node_rank);
+            MPI_Comm_size(node, &node_ranks);
+            unsigned long long node_needed = 0;
+            MPI_Reduce(&needed, &node_needed, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, node);
+            needed = node_needed;
+        }
+
+        int fits = 1;
+        if (node_rank == 0)
+        {
+            const size_t available = available_memory();
+            fits = (available == 0 || needed <= available) ? 1 : 0;
+            if (!fits)
+                std::cerr << "Warning from memory predictor: " << method << " needs " << megabytes(needed) << " more on this node ("
+                          << node_ranks << " process(es), " << megabytes(prediction.total()) << " on the first), but only "
+                          << megabytes(available) << " are available." << std::endl;
+        }
+
+        if (node != MPI_COMM_NULL)
+            MPI_Bcast(&fits, 1, MPI_INT, 0, node);
+        return fits != 0;
+    }
+
+    Measurement::Measurement(Report &report, bool enabled)
+        : report(report), outermost(depth++ == 0), enabled(enabled)
+    {
+        if (!outermost)
+            return;
+        report = Report{};
+        if (!enabled)
+            return;
+        report.measured = true;
+        report.rss_of_solve = reset_rss_high_water();
+        memory::reset_peak();
+    }
+
+    Measurement::~Measurement()
+    {
+        --depth;
+        if (!outermost || !enabled)
+            return;
+        report.grid_peak_bytes = memory::peak_allocated();
+        report.rss_peak_bytes = rss_high_water();
+    }
+
+    bool nested()
+    {
+        return depth > 1;
+    }
+} // namespace solver::footprint
@@ -0,0 +1,192 @@
+/// @file lifting.cpp
+/// @brief This file contains the implementation of the HarmonicLifting class and of the
+///        sine-transform Poisson solver.
+/// @details The sine transforms are computed with the FFT module of Eigen, through the
+///          odd extension of the data to a sequence of length 2 (m + 1).
+
+#include <cmath>
+#include <numbers>
+#include <complex>
+#include <algorithm>
+#include <unsupported/Eigen/FFT>
+
+#include "lifting.hpp"
+
+namespace solver
+{
+    namespace
+    {
+        /// @brief add_dirichlet_solution sums directly over the non-zero rows when there are fewer than
+        ///        direct_rows_factor log2(n - 1) of them (measured crossover with the FFT of Eigen)
+        constexpr double direct_rows_factor = 5.0;
+
+        /// @brief sine transform X_p = sum_{j=1}^{m} x_j sin(pi p j / (m + 1)), p = 1, ..., m
+        /// @param fft FFT engine (it caches the plans)
+        /// @param x input, x[j - 1] = x_j
+        /// @param X output, X[p - 1] = X_p
+        /// @param extended work buffer of size 2 (m + 1)
+        /// @param spectrum work buffer
+        void sine_transform(Eigen::FFT<double> &fft, const std::vector<double> &x, std::vector<double> &X,
+                            std::vector<double> &extended, std::vector<std::complex<double>> &spectrum)
+        {
+            const size_t m = x.size();
+            extended.assign(2 * (m + 1), 0.0);
+            for (size_t j = 0; j < m; ++j)
+            {
+                extended[j + 1] = x[j];
+                extended[2 * (m + 1) - 1 - j] = -x[j];
+            }
+            fft.fwd(spectrum, extended);
+
+            // The transform of an odd sequence is -2i times the sine transform
+            X.resize(m);
+            for (size_t p = 0; p < m; ++p)
+                X[p] = -0.5 * spectrum[p + 1].imag();
+        }
+    }
+
+    HarmonicLifting::HarmonicLifting(size_t n) : n(n), m(n - 2), profile(n * (n - 2))
+    {
+        const double N = static_cast<double>(n - 1);
+        for (size_t p = 1; p <= m; ++p)
+        {
+            const double lambda = std::acosh(2.0 - std::cos(std::numbers::pi * p / N));
+
+            // sinh(lambda (N - d)) / sinh(lambda N), written so that it does not overflow
+            const double denominator = -std::expm1(-2.0 * lambda * N);
+            for (size_t d = 0; d < n; ++d)
+                profile[d * m + p - 1] = std::exp(-lambda * d) * -std::expm1(-2.0 * lambda * (N - d)) / denominator;
+        }
+    }
+
+    void HarmonicLifting::apply(const std::vector<double> &top, const std::vector<double> &right,
+                                const std::vector<double> &bottom, const std::vector<double> &left, double *u) const
+    {
+        if (m == 0)
+            return;
+
+        Eigen::FFT<double> fft;
+        std::vector<double> extended, in(m), out(m);
+        std::vector<std::complex<double>> spectrum;
+
+        // Sine coefficients of the interior values of each side
+        auto coefficients = [&](const std::vector<double> &side)
+        {
+            std::copy(side.begin() + 1, side.begin() + 1 + m, in.begin());
+            std::vector<double> c;
+            sine_transform(fft, in, c, extended, spectrum);
+            for (double &value : c)
+                value *= 2.0 / (m + 1);
+            return c;
+        };
+        const std::vector<double> c_top = coefficients(top), c_bottom = coefficients(bottom);
+        const std::vector<double> c_left = coefficients(left), c_right = coefficients(right);
+
+        // Top and bottom data: one synthesis along each interior row
+        for (size_t i = 1; i <= m; ++i)
+        {
+            const double *near = &profile[i * m], *far = &profile[(n - 1 - i) * m];
+            for (size_t p = 0; p < m; ++p)
+                in[p] = c_top[p] * near[p] + c_bottom[p] * far[p];
+            sine_transform(fft, in, out, extended, spectrum);
+            for (size_t j = 1; j <= m; ++j)
+                u[i * n + j] += out[j - 1];
+        }
+
+        // Left and right data: one synthesis along each interior column
+        for (size_t j = 1; j <= m; ++j)
+        {
+            const double *near = &profile[j * m], *far = &profile[(n - 1 - j) * m];
+            for (size_t p = 0; p < m; ++p)
+                in[p] = c_left[p] * near[p] + c_right[p] * far[p];
+            sine_transform(fft, in, out, extended, spectrum);
+            for (size_t i = 1; i <= m; ++i)
+                u[i * n + j] += out[i - 1];
+        }
+    }
+
+    void add_dirichlet_solution(size_t n, const double *rhs, double *u)
+    {
+        const size_t m = n - 2;
+        if (m == 0)
+            return;
+
+        Eigen::FFT<double> fft;
+        std::vector<double> extended, in(m), out(m);
+        std::vector<std::complex<double>> spectrum;
+
+        // Transform along the rows: coefficients[i * m + q] for interior row i + 1 and mode q + 1
+        std::vector<double> coefficients(m * m, 0.0);
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < m; ++i)
+        {
+            const double *row = rhs + (i + 1) * n + 1;
+            if (std::all_of(row, row + m, [](double value)
+                            { return value == 0.0; }))
+                continue;
+            rows.push_back(i);
+            std::copy(row, row + m, in.begin());
+            sine_transform(fft, in, out, extended, spectrum);
+            std::copy(out.begin(), out.end(), coefficients.begin() + i * m);
+        }
+        if (rows.empty())
+            return;
+
+        // With few non-zero rows, the transforms along the columns are cheaper as direct sums over them
+        const double N = static_cast<double>(n - 1);
+        const bool direct = rows.size() < direct_rows_factor * std::log2(N);
+        std::vector<double> sines;
+        if (direct)
+        {
+            sines.resize(rows.size() * m);
+            for (size_t r = 0; r < rows.size(); ++r)
+                for (size_t p = 0; p < m; ++p)
+                    sines[r * m + p] = std::sin(std::numbers::pi * static_cast<double>((rows[r] + 1) * (p + 1)) / N);
+        }
+
+        // Transform along the columns and divide by the eigenvalues of the 5-point operator
+        std::vector<double> eigenvalue(m);
+        for (size_t p = 0; p < m; ++p)
+            eigenvalue[p] = 2.0 - 2.0 * std::cos(std::numbers::pi * (p + 1) / N);
+        const double scale = (2.0 / N) * (2.0 / N);
+        for (size_t q = 0; q < m; ++q)
+        {
+            if (direct)
+            {
+                std::fill(out.begin(), out.end(), 0.0);
+                for (size_t r = 0; r < rows.size(); ++r)
+                {
+                    const double c = coefficients[rows[r] * m + q];
+                    const double *s = &sines[r * m];
+                    for (size_t p = 0; p < m; ++p)
+                        out[p] += c * s[p];
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < m; ++i)
+                    in[i] = coefficients[i * m + q];
+                sine_transform(fft, in, out, extended, spectrum);
+            }
+            for (size_t p = 0; p < m; ++p)
+                coefficients[p * m + q] = scale * out[p] / (eigenvalue[p] + eigenvalue[q]);
+        }
+
+        // Inverse transforms (the sine transform is its own inverse up to the scale above)
+        for (size_t q = 0; q < m; ++q)
+        {
+            for (size_t p = 0; p < m; ++p)
+                in[p] = coefficients[p * m + q];
+            sine_transform(fft, in, out, extended, spectrum);
+            for (size_t i = 0; i < m; ++i)
+                coefficients[i * m + q] = out[i];
+        }
+        for (size_t i = 0; i < m; ++i)
+        {
+            std::copy(coefficients.begin() + i * m, coefficients.begin() + (i + 1) * m, in.begin());
+            sine_transform(fft, in, out, extended, spectrum);
+            for (size_t j = 0; j < m; ++j)
+                u[(i + 1) * n + j + 1] += out[j];
+        }
+    }
+} // namespace solver
@@ -24,6 +24,39 @@
  *
  * Command Line Options:
  * - --use-datafile or -d: Read parameters from data.txt file (slower due to parser overhead)
+ * - --page-policy <standard|thp|hugetlb-2M|hugetlb-1G>: Page backing of large grid buffers
+ * - --tlb-test: Compare time and data TLB misses of the page policies on a large grid
+ * - --batch <count>: Measure the throughput of the batch mode on an ensemble of small problems
+ * - --threads <k>: Number of threads of the OpenMP and hybrid solvers (default 2)
+ * - --backend-test: Compare the OpenMP and the native thread pool backends
+ * - --hybrid-tasks: Use the task-based hybrid solver, which overlaps the halo exchange with computation
+ * - --direct-hybrid: Use the hybrid Schwarz solver, with one factorized subdomain per thread, in the direct column
+ * - --trace <file>: Record the timeline of the solvers of every rank and thread in a Chrome trace
+ * - --autotune: Tune threads, backend and halo exchange of the threaded solvers (with up to --threads
+ *   threads), caching the best configurations in tuning_cache.csv
+ * - --scaling <strong|weak>: Run a scaling experiment on 1, 2, 4, ... processes and 1, 2, 4, ... --threads
+ *   threads, writing test/data/scaling/<mode>.csv (options: --scaling-n, --scaling-method, --scaling-iter)
+ * - --bc-sweep <count>: Compare re-solving and harmonic lifting on count problems differing only in the boundary data
+ * - --red-black-test <n>: Compare the red-black Gauss-Seidel solver on the split red/black layout with the
+ *   OpenMP Jacobi solver (--threads threads) on an n x n grid
+ * - --fast-poisson-test: Compare the fast Poisson solver with conjugate gradient on a problem with a localized source
+ * - --incremental-test: Compare an incremental re-solve after a localized change of f with a solve from scratch
+ * - --recycle-test <count>: Compare plain and recycled CG on count problems with a moving source
+ * - --probe-test <count>: Measure the interpolation of the solution at count random points per process
+ * - --pyramid-test: Compare the ASCII VTK output with the parallel multi-resolution output
+ * - --render-test: Render heatmaps of the iterates of the CG solver and compare their cost with a VTK dump
+ * - --telemetry <name>: Publish the progress of the solvers in the shared-memory segment /<name>,
+ *   which can be followed with ./telemetry_tail <name>
+ * - --reduction-test <node-size>: Compare the flat and the node-aware reductions of the residual, on the
+ *   nodes of the job and on emulated nodes of node-size ranks (0 to skip them)
+ * - --topology <none|node|cart|graph>: Order the ranks of the MPI solvers so that the neighbouring slabs
+ *   share a node (node-major order, or reordering of a Cartesian or graph topology by the MPI library)
+ * - --topology-test <nodes>: Compare the halo traffic across the nodes and the time of the orderings,
+ *   on the nodes of the job or on nodes emulated by a round-robin placement (0 for the real ones)
+ * - --memory-test <n>: Compare the predicted and the measured memory per rank of every MPI method on
+ *   an n x n grid (peak of the grid buffers and of the resident set)
+ * - --schwarz-test <n>: Compare the iterations, the time and the residual of the additive, the multiplicative
+ *   (red-black coloured) and the hybrid (--threads) Schwarz iterations of the direct solver on an n x n grid
  *
  * Output:
  * - Console table showing execution times, speedups, and errors for all methods
@@ -43,19 +76,977 @@
 #include <iomanip>
 #include <chrono>
 #include <fstream>
+#include <random>
+#include <memory>
+#include <stdexcept>
+#include <set>
+#include <functional>
+#include <algorithm>
+#include <limits>
 #include <omp.h>
 #include <mpi.h>
 #include <GetPot>
 
 #include "muparser_interface.hpp"
 #include "solver.hpp"
+#include "batch.hpp"
 #include "vtk.hpp"
 #include "plot.hpp"
 #include "simulation_parameters.hpp"
+#include "perf_counters.hpp"
+#include "trace.hpp"
+#include "tuner.hpp"
+#include "quiet_cout.hpp"
+#include "scaling.hpp"
+#include "telemetry.hpp"
+#include "topology.hpp"
+
+/// @brief Homogeneous Dirichlet data.
+/// @details The problems of the tests are built from plain functions rather than from lambdas:
+///          copying the empty state of a captureless lambda stored in std::function trips GCC's
+///          -Wmaybe-uninitialized at -O3.
+double zero_bc(std::vector<double>)
+{
+    return 0.0;
+}
+
+/// @brief Right-hand side of the default problem, 8 pi^2 sin(2 pi x) sin(2 pi y).
+double default_f(std::vector<double> x)
+{
+    constexpr auto pi = std::numbers::pi;
+    return 8 * pi * pi * sin(2 * pi * x[0]) * sin(2 * pi * x[1]);
+}
+
+/// @brief Exact solution of the default problem, sin(2 pi x) sin(2 pi y).
+double default_uex(std::vector<double> x)
+{
+    constexpr auto pi = std::numbers::pi;
+    return sin(2 * pi * x[0]) * sin(2 * pi * x[1]);
+}
+
+/// @brief Right-hand side of the default problem plus a source in a small disc around (0.3, 0.6).
+double localized_source_f(std::vector<double> x)
+{
+    const double r2 = (x[0] - 0.3) * (x[0] - 0.3) + (x[1] - 0.6) * (x[1] - 0.6);
+    return default_f(x) + ((r2 < 0.003) ? 50.0 : 0.0);
+}
+
+/// @brief Set up a solver for the default problem.
+/// @details Homogeneous Dirichlet data, default_f and default_uex, and a zero initial guess.
+///          The tests change what they study (f, boundary data, threads, ...) afterwards.
+/// @param solver solver to be set up
+/// @param n grid size
+/// @param max_iter maximum number of iterations
+/// @param tol tolerance (0 to run exactly max_iter iterations)
+void set_default_problem(solver::Solver &solver, size_t n, size_t max_iter, double tol)
+{
+    solver.set_bc(zero_bc, zero_bc, zero_bc, zero_bc);
+    solver.set_f(default_f);
+    solver.set_uex(default_uex);
+    solver.set_n(n);
+    solver.set_max_iter(max_iter);
+    solver.set_tol(tol);
+    solver.reset();
+}
+
+/// @brief Wall time of a piece of work.
+/// @param work function to be timed
+/// @param comm if not null, the processes of comm start together and the maximum time over them is returned
+/// @return seconds
+double timed(const std::function<void()> &work, MPI_Comm comm = MPI_COMM_NULL)
+{
+    if (comm != MPI_COMM_NULL)
+        MPI_Barrier(comm);
+    const double start = MPI_Wtime();
+    work();
+    double seconds = MPI_Wtime() - start;
+    if (comm != MPI_COMM_NULL)
+        MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+    return seconds;
+}
+
+/// @brief Largest absolute difference between two grids of the same size.
+double max_difference(const std::vector<double> &a, const std::vector<double> &b)
+{
+    double difference = 0.0;
+    for (size_t k = 0; k < a.size(); ++k)
+        difference = std::max(difference, std::abs(a[k] - b[k]));
+    return difference;
+}
+
+/// @brief Print the largest difference between the solutions compared by a test.
+void print_max_difference(double difference)
+{
+    std::cout << "Max difference between the solutions: " << std::scientific << difference << std::endl;
+}
+
+/// @brief Compare the page policies of the grid allocator on a large grid.
+/// @details Runs a fixed number of serial Jacobi iterations on a grid that spans
+///          hundreds of megabytes and reports time and data TLB misses for each
+///          page policy, together with the backing actually obtained.
+/// @param n grid size
+/// @param iterations number of Jacobi iterations for each policy
+void tlb_test(size_t n, unsigned iterations)
+{
+    const std::vector<std::pair<std::string, solver::memory::PagePolicy>> policies = {
+        {"standard", solver::memory::PagePolicy::Standard},
+        {"thp", solver::memory::PagePolicy::Transparent},
+        {"hugetlb-2M", solver::memory::PagePolicy::HugeTLB2M},
+        {"hugetlb-1G", solver::memory::PagePolicy::HugeTLB1G}};
+
+    std::cout << "=== TLB test (n = " << n << ", " << iterations << " iterations) ===" << std::endl;
+    std::cout << std::setw(12) << "policy"
+              << std::setw(34) << "backing"
+              << std::setw(12) << "Time(s)"
+              << std::setw(16) << "dTLB misses"
+              << std::setw(12) << "reduction" << "\n";
+
+    const solver::memory::PagePolicy saved_policy = solver::memory::get_page_policy();
+    int64_t reference_misses = -1;
+    for (const auto &[name, policy] : policies)
+    {
+        solver::memory::set_page_policy(policy);
+
+        solver::Solver solver;
+        set_default_problem(solver, n, iterations, 0.0);
+
+        perf::Counter counter(perf::Event::DTLBLoadMisses);
+        int64_t misses = -1;
+        const double seconds = timed([&]
+                                     {
+                                         counter.start();
+                                         {
+                                             solver::QuietCout quiet;
+                                             solver.solve_jacobi_serial();
+                                         }
+                                         misses = counter.stop(); });
+
+        if (policy == solver::memory::PagePolicy::Standard)
+            reference_misses = misses;
+
+        std::cout << std::setw(12) << name
+                  << std::setw(34) << solver.stats().grid_pages.describe()
+                  << std::setw(12) << std::fixed << std::setprecision(4) << seconds;
+        if (misses >= 0)
+            std::cout << std::setw(16) << misses;
+        else
+            std::cout << std::setw(16) << "n/a";
+        if (misses >= 0 && reference_misses > 0)
+            std::cout << std::setw(11) << std::setprecision(1) << 100.0 * (1.0 - static_cast<double>(misses) / reference_misses) << "%";
+        else
+            std::cout << std::setw(12) << "n/a";
+        std::cout << "\n";
+    }
+    solver::memory::set_page_policy(saved_policy);
+}
+
+/// @brief Compare the throughput of the batch mode with a loop of serial solves.
+/// @details Builds an ensemble of small problems (n <= 64) with different amplitudes
+///          of the force term, solves them with the BatchSolver on all processes and threads,
+///          and on rank 0 with a loop of Solver::solve_jacobi_serial calls.
+/// @param count number of problems in the ensemble
+/// @param rank rank of the calling process
+void batch_test(size_t count, int rank)
+{
+    const std::vector<size_t> sizes = {8, 16, 24, 32, 40, 48, 56, 64};
+
+    std::vector<solver::Problem> problems(count);
+    for (size_t p = 0; p < count; ++p)
+    {
+        const double amplitude = 1.0 + static_cast<double>(p % 7);
+        problems[p].n = sizes[p % sizes.size()];
+        problems[p].f = [=](std::vector<double> x)
+        { return amplitude * default_f(x); };
+        problems[p].top_bc = problems[p].right_bc = problems[p].bottom_bc = problems[p].left_bc = zero_bc;
+        problems[p].max_iter = 30000;
+        problems[p].tol = 1e-10;
+    }
+
+    solver::BatchSolver batch;
+    std::vector<solver::BatchResult> results = batch.solve(problems);
+
+    if (rank == 0)
+    {
+        // Reference: the same problems solved one after the other with the Solver class
+        double difference = 0.0;
+        const double seconds = timed([&]
+                                     {
+            for (size_t p = 0; p < count; ++p)
+            {
+                solver::Solver solver;
+                set_default_problem(solver, problems[p].n, problems[p].max_iter, problems[p].tol);
+                solver.set_f(problems[p].f);
+                solver.solve_jacobi_serial();
+                difference = std::max(difference, max_difference(solver.get_uh(), results[p].uh));
+            } });
+
+        std::cout << "=== Batch test (" << count << " problems, n <= 64) ===" << std::endl;
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "Batch solver:  " << batch.stats().seconds << " s, "
+                  << batch.stats().solves_per_second << " solves/s, "
+                  << batch.stats().steals << " steals" << std::endl;
+        std::cout << "Serial loop:   " << seconds << " s, "
+                  << count / seconds << " solves/s" << std::endl;
+        print_max_difference(difference);
+    }
+}
+
+/// @brief Compare the OpenMP and the native thread pool backends of the threaded solver.
+/// @details Runs a fixed number of iterations of Solver::solve_jacobi_omp with both
+///          backends for several grid sizes (the OpenMP column is n/a without OpenMP).
+/// @param num_threads number of threads of each team
+/// @param iterations number of Jacobi iterations for each run
+void backend_test(unsigned num_threads, unsigned iterations)
+{
+    std::cout << "=== Threading backends (" << num_threads << " threads, " << iterations << " iterations) ===" << std::endl;
+    std::cout << std::setw(8) << "n"
+              << std::setw(15) << "OpenMP(s)"
+              << std::setw(15) << "Native(s)" << "\n";
+
+    for (size_t n : {64, 128, 256, 512})
+    {
+        std::cout << std::setw(8) << n;
+        for (solver::ThreadBackend backend : {solver::ThreadBackend::OpenMP, solver::ThreadBackend::Native})
+        {
+            solver::Solver solver;
+            set_default_problem(solver, n, iterations, 0.0);
+            solver.set_num_threads(num_threads);
+            solver.set_thread_backend(backend);
+            if (solver.get_thread_backend() != backend)
+            {
+                std::cout << std::setw(15) << "n/a";
+                continue;
+            }
+
+            const double seconds = timed([&]
+                                         {
+                                             solver::QuietCout quiet;
+                                             solver.solve_jacobi_omp(); });
+            std::cout << std::setw(15) << std::fixed << std::setprecision(6) << seconds;
+        }
+        std::cout << "\n";
+    }
+}
+
+/// @brief Measure the cost of a sweep over the boundary conditions.
+/// @details Solves count problems that only differ in the Dirichlet data, once with
+///          Solver::solve_jacobi_omp for every case and once with Solver::solve_lifting,
+///          which solves the interior problem once and then superposes the harmonic
+///          lifting of the boundary data of each case.
+/// @param count number of boundary conditions
+/// @param n grid size
+/// @param num_threads number of threads of the threaded solver
+void bc_sweep_test(size_t count, size_t n, unsigned num_threads)
+{
+    constexpr auto pi = std::numbers::pi;
+    solver::Solver jacobi, lifting;
+    for (solver::Solver *solver : {&jacobi, &lifting})
+    {
+        set_default_problem(*solver, n, 100000, 1e-12);
+        solver->set_num_threads(num_threads);
+    }
+
+    double jacobi_seconds = 0.0, lifting_seconds = 0.0, difference = 0.0;
+    for (size_t c = 0; c < count; ++c)
+    {
+        // Boundary data of case c: a different amplitude and frequency on each side
+        const double a = 1.0 + static_cast<double>(c);
+        auto top = [=](std::vector<double> x)
+        { return a * x[1] * (1.0 - x[1]); };
+        auto right = [=](std::vector<double> x)
+        { return sin(a * pi * x[0]); };
+        auto bottom = [=](std::vector<double> x)
+        { return a * x[1]; };
+        auto left = [=](std::vector<double> x)
+        { return cos(a * x[0]); };
+        jacobi.set_bc(top, right, bottom, left);
+        lifting.set_bc(top, right, bottom, left);
+
+        jacobi_seconds += timed([&]
+                                {
+                                    solver::QuietCout quiet;
+                                    jacobi.reset();
+                                    jacobi.solve_jacobi_omp(); });
+        lifting_seconds += timed([&]
+                                 { lifting.solve_lifting(); });
+        difference = std::max(difference, max_difference(jacobi.get_uh(), lifting.get_uh()));
+    }
+
+    std::cout << "=== Boundary condition sweep (" << count << " cases, n = " << n << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Jacobi for every case: " << jacobi_seconds << " s" << std::endl;
+    std::cout << "Harmonic lifting:      " << lifting_seconds << " s (first case included)" << std::endl;
+    print_max_difference(difference);
+}
+
+/// @brief Compare the red-black Gauss-Seidel solver on the split layout with the OpenMP Jacobi solver.
+/// @param n grid size
+/// @param num_threads number of threads of both solvers
+void red_black_test(size_t n, unsigned num_threads)
+{
+    struct Variant
+    {
+        std::string name;
+        void (solver::Solver::*solve)();
+    };
+    const Variant variants[] = {{"jacobi_omp", &solver::Solver::solve_jacobi_omp},
+                                {"gauss_seidel_rb", &solver::Solver::solve_gauss_seidel_rb}};
+
+    std::cout << "=== Red-black Gauss-Seidel on the split layout (n = " << n << ", " << num_threads << " threads) ===" << std::endl;
+    std::cout << std::setw(16) << "method" << std::setw(12) << "iterations" << std::setw(12) << "time (s)"
+              << std::setw(16) << "ms/iteration" << std::setw(14) << "L2 error" << std::endl;
+    std::vector<double> solutions[2];
+    for (size_t v = 0; v < 2; ++v)
+    {
+        solver::Solver solver;
+        set_default_problem(solver, n, 1000000, 1e-10);
+        solver.set_num_threads(num_threads);
+        const double seconds = timed([&]
+                                     { (solver.*variants[v].solve)(); });
+        solutions[v] = solver.get_uh();
+        std::cout << std::setw(16) << variants[v].name << std::setw(12) << solver.get_iter()
+                  << std::fixed << std::setprecision(4) << std::setw(12) << seconds
+                  << std::setw(16) << 1e3 * seconds / std::max<size_t>(1, solver.get_iter())
+                  << std::scientific << std::setprecision(3) << std::setw(14) << solver.l2_error() << std::endl;
+    }
+    print_max_difference(max_difference(solutions[0], solutions[1]));
+}
+
+/// @brief Compare the fast Poisson solver with conjugate gradient on a problem with a localized source.
+/// @details Solves the default problem plus a source in a small disc with Solver::solve_fast_poisson
+///          and with Solver::solve_cg_mpi on this process only.
+/// @param n grid size
+void fast_poisson_test(size_t n)
+{
+    solver::Solver fast, cg;
+    for (solver::Solver *solver : {&fast, &cg})
+    {
+        set_default_problem(*solver, n, 200000, 1e-12);
+        solver->set_f(localized_source_f);
+        solver->set_comm(MPI_COMM_SELF);
+    }
+
+    const double fast_seconds = timed([&]
+                                      { fast.solve_fast_poisson(); });
+    const double cg_seconds = timed([&]
+                                    { cg.solve_cg_mpi(); });
+
+    std::cout << "=== Fast Poisson solver (n = " << n << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Sine transforms:    " << fast_seconds << " s" << std::endl;
+    std::cout << "Conjugate gradient: " << cg_seconds << " s, " << cg.get_iter() << " iterations" << std::endl;
+    print_max_difference(max_difference(fast.get_uh(), cg.get_uh()));
+}
+
+/// @brief Compare an incremental re-solve after a localized change of f with a solve from scratch.
+/// @details Solves the default problem with Solver::solve_incremental, adds a source in a small disc
+///          and solves again, incrementally and on a fresh solver (and with conjugate gradient on this
+///          process only); then re-solves the unchanged problem. Each transform solve is repeated on
+///          copies of the solvers and the best time is kept.
+/// @param n grid size
+/// @param repetitions number of timed repetitions of each solve
+void incremental_test(size_t n, unsigned repetitions)
+{
+    solver::Solver design;
+    set_default_problem(design, n, 1000, 1e-12);
+    design.solve_incremental();
+    design.set_f(localized_source_f);
+
+    solver::Solver scratch;
+    set_default_problem(scratch, n, 1000, 1e-12);
+    scratch.set_f(localized_source_f);
+
+    // Best time of a solve started from a copy of the given solver, which is left with the last copy
+    auto best = [&](solver::Solver &solver)
+    {
+        double seconds = std::numeric_limits<double>::max();
+        solver::Solver start = solver;
+        for (unsigned r = 0; r < repetitions; ++r)
+        {
+            solver = start;
+            seconds = std::min(seconds, timed([&]
+                                              { solver.solve_incremental(); }));
+        }
+        return seconds;
+    };
+    const double incremental_seconds = best(design);
+    const size_t incremental_sweeps = design.get_iter();
+    const double scratch_seconds = best(scratch);
+    const size_t scratch_sweeps = scratch.get_iter();
+    const double unchanged_seconds = best(design);
+
+    solver::Solver cg;
+    set_default_problem(cg, n, 200000, 1e-12);
+    cg.set_f(localized_source_f);
+    cg.set_comm(MPI_COMM_SELF);
+    const double cg_seconds = timed([&]
+                                    { cg.solve_cg_mpi(); });
+
+    std::cout << "=== Incremental re-solve after a localized change of f (n = " << n << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "CG from scratch:         " << 1e3 * cg_seconds << " ms, " << cg.get_iter() << " iterations" << std::endl;
+    std::cout << "Transforms from scratch: " << 1e3 * scratch_seconds << " ms, " << scratch_sweeps << " sweeps" << std::endl;
+    std::cout << "Incremental:             " << 1e3 * incremental_seconds << " ms, " << incremental_sweeps << " sweeps ("
+              << std::setprecision(2) << incremental_seconds / scratch_seconds << " x from scratch)" << std::endl;
+    std::cout << std::setprecision(4);
+    std::cout << "Unchanged problem:       " << 1e3 * unchanged_seconds << " ms, " << design.get_iter() << " sweeps" << std::endl;
+    print_max_difference(std::max(max_difference(design.get_uh(), scratch.get_uh()), max_difference(design.get_uh(), cg.get_uh())));
+}
+
+/// @brief Measure the iterations saved by recycling Ritz vectors across a sequence of solves.
+/// @details Solves count problems whose source moves across the domain with Solver::solve_cg_mpi,
+///          once as plain CG and once deflating the recycled vectors of the previous solves.
+///          Must be called by every process.
+/// @param count number of problems
+/// @param n grid size
+/// @param recycle number of recycled vectors
+void recycle_test(size_t count, size_t n, size_t recycle)
+{
+    auto ramp = [](std::vector<double> x)
+    { return x[0]; };
+
+    solver::Solver plain, recycled;
+    for (solver::Solver *solver : {&plain, &recycled})
+    {
+        set_default_problem(*solver, n, 100000, 1e-10);
+        solver->set_bc(zero_bc, ramp, zero_bc, zero_bc);
+    }
+    recycled.set_recycle(recycle);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank == 0)
+        std::cout << "=== Recycled CG (" << count << " solves, n = " << n << ", " << recycle << " vectors) ===" << std::endl;
+
+    unsigned plain_total = 0, recycled_total = 0;
+    double difference = 0.0;
+    for (size_t c = 0; c < count; ++c)
+    {
+        // A Gaussian source moving along the middle of the domain
+        const double a = 0.2 + 0.6 * static_cast<double>(c) / std::max<size_t>(count - 1, 1);
+        auto f = [=](std::vector<double> x)
+        {
+            const double r2 = (x[0] - a) * (x[0] - a) + (x[1] - 0.5) * (x[1] - 0.5);
+            return default_f(x) + 200 * exp(-80 * r2);
+        };
+        for (solver::Solver *solver : {&plain, &recycled})
+        {
+            solver->set_f(f);
+            solver->reset();
+            solver->solve_cg_mpi();
+        }
+        plain_total += plain.get_iter();
+        recycled_total += recycled.get_iter();
+
+        if (rank == 0)
+        {
+            difference = std::max(difference, max_difference(plain.get_uh(), recycled.get_uh()));
+            std::cout << "Solve " << c << ": plain " << plain.get_iter() << " iterations, recycled "
+                      << recycled.get_iter() << " iterations" << std::endl;
+        }
+    }
+
+    if (rank == 0)
+    {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Total: plain " << plain_total << ", recycled " << recycled_total << " ("
+                  << 100.0 * (1.0 - static_cast<double>(recycled_total) / plain_total) << "% fewer iterations)" << std::endl;
+        std::cout << "Smallest Ritz value: " << std::scientific << recycled.stats().smallest_ritz_value << std::endl;
+        print_max_difference(difference);
+    }
+}
+
+/// @brief Measure the throughput and the accuracy of the interpolation of the solution.
+/// @details Solves the default problem with Solver::solve_cg_mpi, then interpolates the solution
+///          at count random points per process with both methods of Solver::probe and compares
+///          the values with the exact solution (the first call includes the scatter of the slabs),
+///          and measures the calls on batches of a few points. Must be called by every process.
+/// @param count number of points per process
+/// @param n grid size
+void probe_test(size_t count, size_t n)
+{
+    solver::Solver solver;
+    set_default_problem(solver, n, 100000, 1e-12);
+    solver.solve_cg_mpi();
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    std::mt19937 generator(rank);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<double> x(count), y(count);
+    for (size_t k = 0; k < count; ++k)
+    {
+        x[k] = distribution(generator);
+        y[k] = distribution(generator);
+    }
+
+    if (rank == 0)
+        std::cout << "=== Probe (" << count << " points per process, " << size << " processes, n = " << n << ") ===" << std::endl;
+    for (solver::probe::Method method : {solver::probe::Method::Bilinear, solver::probe::Method::Bicubic})
+    {
+        std::vector<double> values;
+        const double seconds = timed([&]
+                                     { values = solver.probe(x, y, method); }, MPI_COMM_WORLD);
+
+        double error = 0.0;
+        for (size_t k = 0; k < count; ++k)
+            error = std::max(error, std::abs(values[k] - default_uex({x[k], y[k]})));
+        MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        if (rank == 0)
+        {
+            std::cout << std::fixed << std::setprecision(4);
+            std::cout << ((method == solver::probe::Method::Bilinear) ? "Bilinear: " : "Bicubic:  ") << seconds << " s, "
+                      << std::setprecision(1) << count * size / seconds / 1e6 << " Mpoints/s, max error "
+                      << std::scientific << error << std::endl;
+        }
+    }
+
+    // Small batches reuse the slabs scattered by the first call, so their cost does not grow with n
+    const size_t few = std::min<size_t>(count, 10);
+    const std::vector<double> few_x(x.begin(), x.begin() + few), few_y(y.begin(), y.begin() + few);
+    constexpr unsigned calls = 100;
+    const double seconds = timed([&]
+                                 {
+        for (unsigned c = 0; c < calls; ++c)
+            solver.probe(few_x, few_y); }, MPI_COMM_WORLD);
+    if (rank == 0)
+        std::cout << "Batches of " << few << " points: " << std::fixed << std::setprecision(1)
+                  << 1e6 * seconds / calls << " us per call" << std::endl;
+}
+
+/// @brief Compare the ASCII VTK output with the parallel multi-resolution output.
+/// @details Solves the default problem with Solver::solve_cg_mpi and writes the solution with
+///          Solver::save_vtk (rank 0) and with Solver::save_vtk_pyramid (all processes).
+///          Must be called by every process.
+/// @param n grid size
+void pyramid_test(size_t n)
+{
+    solver::Solver solver;
+    set_default_problem(solver, n, 100000, 1e-10);
+    solver.solve_cg_mpi();
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    const std::string name = "pyramid_n_" + std::to_string(n);
+
+    double ascii_seconds = 0.0;
+    if (rank == 0)
+        ascii_seconds = timed([&]
+                              { solver.save_vtk(name + "_ascii"); });
+
+    size_t levels = 0;
+    const double pyramid_seconds = timed([&]
+                                         { levels = solver.save_vtk_pyramid(name, 64); }, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        std::cout << "=== Pyramid output (n = " << n << ") ===" << std::endl;
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "ASCII, full resolution only: " << ascii_seconds << " s, "
+                  << std::filesystem::file_size("test/data/" + name + "_ascii.vtk") / 1e6 << " MB" << std::endl;
+        std::cout << "Binary pyramid (" << levels << " levels): " << pyramid_seconds << " s" << std::endl;
+        for (size_t level = 0; level < levels; ++level)
+        {
+            const std::string file = solver::pyramid::level_name("test/data/" + name, level);
+            std::cout << "  " << file << ": " << std::filesystem::file_size(file) / 1e6 << " MB" << std::endl;
+        }
+    }
+}
+
+/// @brief Measure the cost of the in-situ heatmaps.
+/// @details Solves a problem with a localized source with Solver::solve_cg_mpi, once without and
+///          once with a heatmap every 100 iterations, and compares the cost of an image with a VTK
+///          dump. Must be called by every process.
+/// @param n grid size
+void render_test(size_t n)
+{
+    solver::Solver solver;
+    set_default_problem(solver, n, 100000, 1e-10);
+    solver.set_f([](std::vector<double> x)
+                 {
+                     const double r2 = (x[0] - 0.3) * (x[0] - 0.3) + (x[1] - 0.6) * (x[1] - 0.6);
+                     return default_f(x) + 200 * exp(-80 * r2); });
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    const size_t every = 100;
+    double seconds[2];
+    for (int monitored = 0; monitored < 2; ++monitored)
+    {
+        solver.set_monitor(every, monitored ? "heatmap_n_" + std::to_string(n) : "");
+        solver.reset();
+        seconds[monitored] = timed([&]
+                                   { solver.solve_cg_mpi(); }, MPI_COMM_WORLD);
+    }
+    solver.set_monitor(0, "");
+
+    if (rank == 0)
+    {
+        const size_t images = solver.get_iter() / every + 1;
+        const double vtk_seconds = timed([&]
+                                         { solver.save_vtk("heatmap_n_" + std::to_string(n)); });
+
+        std::cout << "=== In-situ heatmaps (n = " << n << ", 512 x 512 PNG every " << every << " iterations) ===" << std::endl;
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "Solve without images: " << seconds[0] << " s" << std::endl;
+        std::cout << "Solve with " << images << " images: " << seconds[1] << " s ("
+                  << 1e3 * (seconds[1] - seconds[0]) / images << " ms per image)" << std::endl;
+        std::cout << "VTK dump of the solution: " << vtk_seconds << " s" << std::endl;
+    }
+}
+
+/// @brief Compare the library allreduce with the node-aware reduction.
+/// @details Times the reduction of a residual (1 double, MPI_MAX) and of a packed vector of 9 doubles
+///          (MPI_SUM, as in the recycled CG) with the flat and the hierarchical algorithms, on the nodes
+///          of the job and, if node_size is positive, on emulated nodes of node_size ranks. The results
+///          of the two algorithms are checked against each other, and solve_jacobi_mpi is timed with
+///          each of them. Must be called by every process.
+/// @param node_size size of the emulated nodes (0 for the nodes of the job only)
+/// @param repetitions number of reductions timed
+void reduction_test(int node_size, size_t repetitions)
+{
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    solver::Solver solver;
+    set_default_problem(solver, 128, 2000, 0.0);
+
+    if (rank == 0)
+    {
+        std::cout << "=== Reductions over " << size << " processes (" << repetitions << " repetitions) ===" << std::endl;
+        std::cout << std::setw(10) << "layout"
+                  << std::setw(14) << "algorithm"
+                  << std::setw(7) << "nodes"
+                  << std::setw(14) << "max(1) us"
+                  << std::setw(14) << "sum(9) us"
+                  << std::setw(16) << "Jacobi 2000 it"
+                  << std::setw(10) << "agree" << std::endl;
+    }
+
+    std::vector<int> layouts = {0};
+    if (node_size > 0)
+        layouts.push_back(node_size);
+    for (int layout : layouts)
+    {
+        std::vector<double> reference;
+        for (auto algorithm : {solver::reduction::Algorithm::Flat, solver::reduction::Algorithm::Hierarchical})
+        {
+            const solver::reduction::Allreduce allreduce(MPI_COMM_WORLD, algorithm, layout);
+
+            // Values that differ on every rank, so that a wrong combination shows
+            std::vector<double> values(10);
+            auto fill = [&](size_t k)
+            {
+                for (size_t c = 0; c < values.size(); ++c)
+                    values[c] = std::sin(1.0 + rank * 0.37 + c * 0.11 + k * 1e-3);
+            };
+
+            double seconds[2];
+            const int counts[2] = {1, 9};
+            const MPI_Op ops[2] = {MPI_MAX, MPI_SUM};
+            for (int c = 0; c < 2; ++c)
+            {
+                fill(0);
+                seconds[c] = timed([&]
+                                   {
+                    for (size_t k = 0; k < repetitions; ++k)
+                        allreduce.reduce(values.data() + (c == 0 ? 0 : 1), counts[c], ops[c]); }, MPI_COMM_WORLD);
+            }
+
+            // One reduction of each kind from fresh values, compared across the algorithms
+            fill(1);
+            allreduce.reduce(values.data(), 1, MPI_MAX);
+            allreduce.reduce(values.data() + 1, 9, MPI_SUM);
+            bool agree = true;
+            if (reference.empty())
+                reference = values;
+            for (size_t c = 0; c < values.size(); ++c)
+                agree = agree && std::abs(values[c] - reference[c]) <= 1e-12 * std::abs(reference[c]);
+
+            solver.set_reduction(algorithm, layout);
+            solver.reset();
+            const double jacobi = timed([&]
+                                        {
+                                            solver::QuietCout quiet;
+                                            solver.solve_jacobi_mpi(); }, MPI_COMM_WORLD);
+
+            if (rank == 0)
+            {
+                std::cout << std::setw(10) << ((layout == 0) ? "nodes" : "emulated")
+                          << std::setw(14) << (allreduce.hierarchical() ? "hierarchical" : "flat")
+                          << std::setw(7) << allreduce.nodes()
+                          << std::fixed << std::setprecision(2)
+                          << std::setw(14) << 1e6 * seconds[0] / repetitions
+                          << std::setw(14) << 1e6 * seconds[1] / repetitions
+                          << std::setprecision(4) << std::setw(16) << jacobi
+                          << std::setw(10) << (agree ? "yes" : "NO") << std::endl;
+            }
+        }
+    }
+}
+
+/// @brief Compare the orderings of the ranks for the row slabs.
+/// @details For every ordering, reports the halo traffic of an iteration inside and across the nodes
+///          and times solve_jacobi_mpi on the reordered communicator. With emulated_nodes > 0 the
+///          processes are considered placed round-robin on emulated_nodes nodes, as with a launcher
+///          mapping by node. Must be called by every process.
+/// @param emulated_nodes number of emulated nodes (0 for the nodes of the job)
+/// @param n grid size
+void topology_test(int emulated_nodes, size_t n)
+{
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    const std::vector<int> nodes = solver::topology::nodes(MPI_COMM_WORLD, emulated_nodes);
+    if (rank == 0)
+    {
+        std::cout << "=== Rank orderings on " << size << " processes, "
+                  << std::set<int>(nodes.begin(), nodes.end()).size()
+                  << ((emulated_nodes > 0) ? " emulated round-robin" : "") << " node(s), n = " << n << " ===" << std::endl;
+        std::cout << std::setw(10) << "ordering"
+                  << std::setw(16) << "intra KB/it"
+                  << std::setw(16) << "inter KB/it"
+                  << std::setw(18) << "inter neighbours"
+                  << std::setw(14) << "rank 0 kept"
+                  << std::setw(16) << "Jacobi 1000 it" << std::endl;
+    }
+
+    for (const std::string name : {"none", "node", "cart", "graph"})
+    {
+        MPI_Comm ordered = solver::topology::reorder(MPI_COMM_WORLD, solver::topology::parse(name), emulated_nodes);
+        const solver::topology::Traffic traffic = solver::topology::halo_traffic(ordered, n, emulated_nodes);
+        int ordered_rank;
+        MPI_Comm_rank(ordered, &ordered_rank);
+
+        double seconds;
+        {
+            solver::Solver solver;
+            set_default_problem(solver, n, 1000, 0.0);
+            solver.set_comm(ordered);
+            seconds = timed([&]
+                            {
+                                solver::QuietCout quiet;
+                                solver.solve_jacobi_mpi(); }, MPI_COMM_WORLD);
+        }
+        MPI_Comm_free(&ordered);
+
+        if (rank == 0)
+        {
+            std::cout << std::setw(10) << name
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(16) << traffic.intra_bytes / 1024
+                      << std::setw(16) << traffic.inter_bytes / 1024
+                      << std::setw(18) << traffic.inter_neighbours
+                      << std::setw(14) << ((ordered_rank == 0) ? "yes" : "no")
+                      << std::setprecision(4) << std::setw(16) << seconds << std::endl;
+        }
+    }
+}
+
+/// @brief Compare the predicted and the measured memory of the MPI methods.
+/// @details Runs a few iterations of every MPI method and reports, as the maximum over the ranks, the
+///          predicted bytes, the peak of the bytes reserved by the grid buffers and the peak of the
+///          resident set. Must be called by every process.
+/// @param n grid size
+void memory_test(size_t n)
+{
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    constexpr double mb = 1024.0 * 1024.0;
+
+    if (rank == 0)
+    {
+        std::cout << "=== Memory per rank on " << size << " processes, n = " << n << ", "
+                  << solver::footprint::available_memory() / mb << " MB available on the node of rank 0 ===" << std::endl;
+        std::cout << std::setw(22) << "method"
+                  << std::setw(16) << "grid pred MB"
+                  << std::setw(16) << "grid peak MB"
+                  << std::setw(16) << "total pred MB"
+                  << std::setw(14) << "RSS peak MB" << std::endl;
+    }
+
+    const std::vector<std::pair<std::string, void (solver::Solver::*)()>> methods = {
+        {"jacobi_mpi", &solver::Solver::solve_jacobi_mpi},
+        {"jacobi_hybrid", &solver::Solver::solve_jacobi_hybrid},
+        {"jacobi_hybrid_tasks", &solver::Solver::solve_jacobi_hybrid_tasks},
+        {"direct_mpi", &solver::Solver::solve_direct_mpi},
+        {"direct_hybrid", &solver::Solver::solve_direct_hybrid},
+        {"cg_mpi", &solver::Solver::solve_cg_mpi}};
+    for (const auto &[name, solve] : methods)
+    {
+        solver::footprint::Report report;
+        {
+            solver::Solver solver;
+            set_default_problem(solver, n, 5, 0.0);
+            solver.set_memory_check(true);
+
+            solver::QuietCout quiet;
+            (solver.*solve)();
+            report = solver.stats().footprint;
+        }
+
+        double values[4] = {static_cast<double>(report.predicted.grid_bytes), static_cast<double>(report.grid_peak_bytes),
+                            static_cast<double>(report.predicted.total()), static_cast<double>(report.rss_peak_bytes)};
+        MPI_Allreduce(MPI_IN_PLACE, values, 4, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        if (rank == 0)
+        {
+            std::cout << std::setw(22) << name << std::fixed << std::setprecision(2);
+            for (size_t k = 0; k < 4; ++k)
+                std::cout << std::setw((k == 3) ? 14 : 16) << values[k] / mb;
+            std::cout << (report.rss_of_solve ? "" : "  (RSS since the start)") << std::endl;
+        }
+    }
+}
+
+/// @brief Largest residual of the 5-point equations on the interior of a solution.
+/// @param u solution (n x n, row-major), boundary included
+/// @param n grid size
+/// @param f right-hand side of the equation
+/// @return max |4 u(i, j) - u(i - 1, j) - u(i + 1, j) - u(i, j - 1) - u(i, j + 1) - h^2 f(x_i, y_j)|
+double max_residual(const std::vector<double> &u, size_t n, double (*f)(std::vector<double>))
+{
+    const double h = 1.0 / (n - 1);
+    double residual = 0.0;
+    for (size_t i = 1; i < n - 1; ++i)
+    {
+        for (size_t j = 1; j < n - 1; ++j)
+        {
+            const size_t k = i * n + j;
+            const double r = 4 * u[k] - u[k - n] - u[k + n] - u[k - 1] - u[k + 1] - h * h * f({i * h, j * h});
+            residual = std::max(residual, std::abs(r));
+        }
+    }
+    return residual;
+}
+
+/// @brief Compare the additive and the multiplicative Schwarz iterations of the direct solver.
+/// @details Solves the default problem with Solver::solve_direct_mpi, with the slabs solved all at once
+///          and with the even and odd slabs solved one after the other, and with
+///          Solver::solve_direct_hybrid. Reports the iterations, the time (maximum over the ranks), the
+///          L2 error and the largest residual of the 5-point equations of every variant.
+///          Must be called by every process.
+/// @param n grid size
+/// @param num_threads number of threads of the hybrid solver
+void schwarz_test(size_t n, unsigned num_threads)
+{
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (rank == 0)
+    {
+        std::cout << "=== Schwarz iterations of the direct solver on " << size << " processes, n = " << n << " ===" << std::endl;
+        std::cout << std::setw(16) << "variant"
+                  << std::setw(12) << "iterations"
+                  << std::setw(12) << "time (s)"
+                  << std::setw(16) << "ms/iteration"
+                  << std::setw(14) << "L2 error"
+                  << std::setw(14) << "residual" << std::endl;
+    }
+
+    struct Variant
+    {
+        std::string name;
+        solver::Schwarz schwarz;
+        void (solver::Solver::*solve)();
+    };
+    const Variant variants[3] = {{"additive", solver::Schwarz::Additive, &solver::Solver::solve_direct_mpi},
+                                 {"multiplicative", solver::Schwarz::Multiplicative, &solver::Solver::solve_direct_mpi},
+                                 {"hybrid", solver::Schwarz::Additive, &solver::Solver::solve_direct_hybrid}};
+    std::vector<double> solutions[3];
+    size_t iterations[3];
+    double times[3];
+    for (size_t v = 0; v < 3; ++v)
+    {
+        solver::Solver solver;
+        set_default_problem(solver, n, 100000, 1e-10);
+        solver.set_num_threads(num_threads);
+        solver.set_schwarz(variants[v].schwarz);
+
+        times[v] = timed([&]
+                         {
+                             solver::QuietCout quiet;
+                             (solver.*variants[v].solve)(); }, MPI_COMM_WORLD);
+        iterations[v] = solver.get_iter();
+
+        if (rank == 0)
+        {
+            // The converged iterate must satisfy the discrete equations, not only stop changing
+            solutions[v] = solver.get_uh();
+            std::cout << std::setw(16) << variants[v].name
+                      << std::setw(12) << iterations[v]
+                      << std::fixed << std::setprecision(4)
+                      << std::setw(12) << times[v]
+                      << std::setw(16) << 1e3 * times[v] / std::max<size_t>(1, iterations[v])
+                      << std::scientific << std::setprecision(3)
+                      << std::setw(14) << solver.l2_error()
+                      << std::setw(14) << max_residual(solutions[v], n, default_f) << std::endl;
+        }
+    }
+
+    if (rank == 0)
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Multiplicative / additive: " << static_cast<double>(iterations[1]) / iterations[0] << " x iterations, "
+                  << times[1] / times[0] << " x time" << std::endl;
+        std::cout << "Max difference from the additive solution: " << std::scientific << max_difference(solutions[0], solutions[1])
+                  << " (multiplicative), " << max_difference(solutions[0], solutions[2]) << " (hybrid)" << std::endl;
+    }
+}
+
+/// @brief Run a weak or strong scaling experiment and write test/data/scaling/<mode>.csv.
+/// @details Must be called by every process.
+/// @param options problem of the experiment (grid size, method, iterations)
+/// @param mode strong or weak
+/// @param num_threads largest number of threads (1, 2, 4, ... up to num_threads are run)
+/// @param rank rank of the process in MPI_COMM_WORLD
+void scaling_experiment(solver::scaling::Options options, const std::string &mode, unsigned num_threads, int rank)
+{
+    if (mode != "strong" && mode != "weak")
+    {
+        if (rank == 0)
+            std::cerr << "Unknown scaling mode: " << mode << std::endl;
+        return;
+    }
+
+    options.mode = (mode == "strong") ? solver::scaling::Mode::Strong : solver::scaling::Mode::Weak;
+    options.threads.clear();
+    for (unsigned t = 1; t < num_threads; t *= 2)
+        options.threads.push_back(t);
+    options.threads.push_back(num_threads);
+
+    std::vector<solver::scaling::Point> points = solver::scaling::run(options, MPI_COMM_WORLD);
+    if (rank == 0)
+    {
+        solver::scaling::print(points, options);
+        std::filesystem::create_directories("test/data/scaling");
+        solver::scaling::write_csv(points, options, "test/data/scaling/" + mode + ".csv");
+        plot::scalabilityTest();
+    }
+}
+
+/// @brief A test that replaces the benchmark when its flag is given.
+/// @details If several tests are requested, the first one of the table runs.
+struct Test
+{
+    std::string flag;                              ///< command line flag
+    bool takes_value;                              ///< whether the flag is followed by a value
+    bool root_only;                                ///< whether only rank 0 runs the test
+    std::function<void(const std::string &)> run; ///< runs the test with the value of the flag
+};
 
 int main(int argc, char **argv)
 {
-    MPI_Init(&argc, &argv);
+    // The task-based hybrid solver completes the halo exchange from any thread,
+    // one at a time, so MPI_THREAD_SERIALIZED is requested
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -64,13 +1055,143 @@ int main(int argc, char **argv)
     // Possibility to read the parameters from a file but the test runs a lot slower
     // because of the overhead of muparserx interface.
     bool use_datafile = false;
-    if (argc > 1)
+    // Number of threads of the threaded solvers
+    unsigned num_threads = 2;
+    // Possibility to run the task-based hybrid solver in the hybrid column
+    bool hybrid_tasks = false;
+    // Possibility to run the hybrid Schwarz solver (threaded subdomain solves) in the direct column
+    bool direct_hybrid = false;
+    // Possibility to record the timeline of the solvers in a Chrome trace
+    std::string trace_file;
+    // Possibility to auto-tune the threaded solvers (configurations are cached in tuning_cache.csv)
+    bool autotune = false;
+    // Problem of the scaling experiment
+    solver::scaling::Options scaling;
+    // Possibility to publish the progress of the solvers in a shared-memory segment
+    std::string telemetry_name;
+    // Possibility to order the ranks of the MPI solvers by node
+    std::string topology_method = "none";
+
+    // Possibility to run one of the tests instead of the benchmark
+    const std::vector<Test> tests = {
+        {"--tlb-test", false, true, [](const std::string &)
+         { tlb_test(2048, 10); }},
+        {"--backend-test", false, true, [&](const std::string &)
+         { backend_test(num_threads, 200); }},
+        {"--bc-sweep", true, true, [&](const std::string &count)
+         { bc_sweep_test(std::stoul(count), 64, num_threads); }},
+        {"--red-black-test", true, true, [&](const std::string &n)
+         { red_black_test(std::stoul(n), num_threads); }},
+        {"--fast-poisson-test", false, true, [](const std::string &)
+         { fast_poisson_test(129); }},
+        {"--incremental-test", false, true, [](const std::string &)
+         { incremental_test(257, 10); }},
+        {"--recycle-test", true, false, [](const std::string &count)
+         { recycle_test(std::stoul(count), 96, 8); }},
+        {"--probe-test", true, false, [](const std::string &count)
+         { probe_test(std::stoul(count), 257); }},
+        {"--pyramid-test", false, false, [](const std::string &)
+         { pyramid_test(513); }},
+        {"--render-test", false, false, [](const std::string &)
+         { render_test(513); }},
+        {"--reduction-test", true, false, [](const std::string &node_size)
+         { reduction_test(std::stoi(node_size), 20000); }},
+        {"--topology-test", true, false, [](const std::string &nodes)
+         { topology_test(std::stoi(nodes), 256); }},
+        {"--memory-test", true, false, [](const std::string &n)
+         { memory_test(std::stoul(n)); }},
+        {"--schwarz-test", true, false, [&](const std::string &n)
+         { schwarz_test(std::stoul(n), num_threads); }},
+        {"--scaling", true, false, [&](const std::string &mode)
+         { scaling_experiment(scaling, mode, num_threads, rank); }},
+        {"--batch", true, false, [&](const std::string &count)
+         { batch_test(std::stoul(count), rank); }},
+    };
+    // Position in the table of the requested test (tests.size() if none) and value of its flag
+    size_t requested = tests.size();
+    std::string requested_value;
+
+    for (int i = 1; i < argc; ++i)
     {
-        std::string arg = argv[1];
-        if (arg == "--use-datafile" || arg == "-d")
+        std::string arg = argv[i];
+        auto test = std::find_if(tests.begin(), tests.end(), [&](const Test &t)
+                                 { return t.flag == arg && (!t.takes_value || i + 1 < argc); });
+        if (test != tests.end())
+        {
+            std::string value = test->takes_value ? argv[++i] : "";
+            if (static_cast<size_t>(test - tests.begin()) < requested)
+            {
+                requested = test - tests.begin();
+                requested_value = value;
+            }
+        }
+        else if (arg == "--use-datafile" || arg == "-d")
         {
             use_datafile = true;
         }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            num_threads = std::stoul(argv[++i]);
+        }
+        else if (arg == "--hybrid-tasks")
+        {
+            hybrid_tasks = true;
+        }
+        else if (arg == "--direct-hybrid")
+        {
+            direct_hybrid = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            trace_file = argv[++i];
+        }
+        else if (arg == "--autotune")
+        {
+            autotune = true;
+        }
+        else if (arg == "--scaling-n" && i + 1 < argc)
+        {
+            scaling.n = std::stoul(argv[++i]);
+        }
+        else if (arg == "--scaling-method" && i + 1 < argc)
+        {
+            scaling.method = argv[++i];
+        }
+        else if (arg == "--scaling-iter" && i + 1 < argc)
+        {
+            scaling.iterations = std::stoul(argv[++i]);
+        }
+        else if (arg == "--telemetry" && i + 1 < argc)
+        {
+            telemetry_name = argv[++i];
+        }
+        else if (arg == "--topology" && i + 1 < argc)
+        {
+            topology_method = argv[++i];
+        }
+        else if (arg == "--page-policy" && i + 1 < argc)
+        {
+            // Page policy for the grid buffers: standard, thp (default), hugetlb-2M, hugetlb-1G
+            std::string policy = argv[++i];
+            if (policy == "standard")
+                solver::memory::set_page_policy(solver::memory::PagePolicy::Standard);
+            else if (policy == "thp")
+                solver::memory::set_page_policy(solver::memory::PagePolicy::Transparent);
+            else if (policy == "hugetlb-2M")
+                solver::memory::set_page_policy(solver::memory::PagePolicy::HugeTLB2M);
+            else if (policy == "hugetlb-1G")
+                solver::memory::set_page_policy(solver::memory::PagePolicy::HugeTLB1G);
+            else if (rank == 0)
+                std::cerr << "Unknown page policy: " << policy << std::endl;
+        }
+    }
+
+    if (requested < tests.size())
+    {
+        if (!tests[requested].root_only || rank == 0)
+            tests[requested].run(requested_value);
+        MPI_Finalize();
+        return 0;
     }
 
     solver::SimulationParameters params;
@@ -117,13 +1238,64 @@ int main(int argc, char **argv)
         std::cout << "---------------------------------------------------------------------------------------------------------------------------------------------\n";
     }
 
+    if (!trace_file.empty())
+        solver::trace::start(MPI_COMM_WORLD);
+
+    // Tuner of the threaded solvers, used with --autotune
+    solver::Tuner tuner;
+
+    // Communicator of the MPI solvers, ordered by node with --topology. The table is printed by
+    // rank 0 of MPI_COMM_WORLD, so an ordering that moves it is replaced by the node-major one.
+    MPI_Comm solver_comm = MPI_COMM_WORLD;
+    if (topology_method != "none")
+    {
+        solver::topology::Reorder method = solver::topology::Reorder::NodeMajor;
+        try
+        {
+            method = solver::topology::parse(topology_method);
+        }
+        catch (const std::invalid_argument &error)
+        {
+            if (rank == 0)
+                std::cerr << error.what() << std::endl;
+        }
+        solver_comm = solver::topology::reorder(MPI_COMM_WORLD, method);
+        int solver_rank;
+        MPI_Comm_rank(solver_comm, &solver_rank);
+        int moved = (rank == 0 && solver_rank != 0) ? 1 : 0;
+        MPI_Bcast(&moved, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (moved)
+        {
+            if (rank == 0)
+                std::cerr << "The " << topology_method << " ordering moved rank 0, using the node-major one" << std::endl;
+            MPI_Comm_free(&solver_comm);
+            solver_comm = solver::topology::reorder(MPI_COMM_WORLD, solver::topology::Reorder::NodeMajor);
+        }
+    }
+
+    // Writer of the progress of the solvers, created by rank 0 (which publishes for all the processes)
+    std::shared_ptr<solver::telemetry::Publisher> telemetry;
+    if (!telemetry_name.empty() && rank == 0)
+    {
+        try
+        {
+            telemetry = std::make_shared<solver::telemetry::Publisher>(telemetry_name);
+        }
+        catch (const std::runtime_error &error)
+        {
+            std::cerr << error.what() << std::endl;
+        }
+    }
+
     for (int n : ns)
     {
 
         // Possibility to read the parameters from a file but the test runs a lot slower
         // because of the overhead of muparserx interface.
         solver::Solver solver;
-        constexpr auto pi = std::numbers::pi;
+        solver.set_num_threads(num_threads);
+        solver.set_telemetry(telemetry);
+        solver.set_comm(solver_comm);
         if (use_datafile)
         {
             // Create muParserX interfaces
@@ -137,26 +1309,19 @@ int main(int argc, char **argv)
             solver.set_initial_guess(std::vector<double>(n * n, 0.0)); // Initial guess
             solver.set_f(f);                                           // Set right-hand side function
             solver.set_uex(uex);                                       // Set exact solution function
+
+            // A product of a function of x[0] and a function of x[1] is evaluated as an outer product
+            std::string f_x_str, f_y_str;
+            if (muparser::split_separable(params.f_str, f_x_str, f_y_str))
+                solver.set_f_separable(muparser::muParserXInterface(f_x_str, 2), muparser::muParserXInterface(f_y_str, 2));
+
             solver.set_n(n);                                           // Set grid size
             solver.set_max_iter(params.max_iter);                      // Set maximum iterations
             solver.set_tol(params.tol);                                // Set tolerance for convergence
         }
         else
         {
-
-            solver.set_bc([=](std::vector<double> x)
-                          { return 0.0; }, [=](std::vector<double> x)
-                          { return 0.0; }, [=](std::vector<double> x)
-                          { return 0.0; }, [=](std::vector<double> x)
-                          { return 0.0; });                            // Set boundary conditions
-            solver.set_initial_guess(std::vector<double>(n * n, 0.0)); // Initial guess
-            solver.set_f([=](std::vector<double> x)
-                         { return 8 * pi * pi * sin(2 * pi * x[0]) * sin(2 * pi * x[1]); }); // Set right-hand side function
-            solver.set_uex([=](std::vector<double> x)
-                           { return sin(2 * pi * x[0]) * sin(2 * pi * x[1]); }); // Set exact solution function
-            solver.set_n(n);                                                     // Set grid size
-            solver.set_max_iter(30000);                                          // Set maximum iterations
-            solver.set_tol(1e-15);                                               // Set tolerance for convergence
+            set_default_problem(solver, n, 30000, 1e-15);
         }
 
         double serial_time = 0.0, omp_time = 0.0, mpi_time = 0.0, hybrid_time = 0.0, direct_time = 0.0;
@@ -176,6 +1341,10 @@ int main(int argc, char **argv)
             // Reset the solver for OMP run
             solver.reset();
 
+            // Tune the OpenMP solver (or read its configuration from the cache)
+            if (autotune)
+                solver::Tuner::apply(solver, tuner.tune(solver, "jacobi_omp", num_threads, MPI_COMM_SELF));
+
             // OpenMP test
             start = std::chrono::high_resolution_clock::now();
             solver.solve_jacobi_omp();
@@ -197,9 +1366,21 @@ int main(int argc, char **argv)
         // Reset solver for hybrid run
         solver.reset();
 
+        // Tune the hybrid solver (or read its configuration from the cache)
+        bool overlap = hybrid_tasks;
+        if (autotune)
+        {
+            solver::TuningConfig config = tuner.tune(solver, "jacobi_hybrid", num_threads);
+            solver::Tuner::apply(solver, config);
+            overlap = config.overlap;
+        }
+
         // Hybrid OpenMP+MPI test (all processes participate)
         auto start_hybrid = std::chrono::high_resolution_clock::now();
-        solver.solve_jacobi_hybrid();
+        if (overlap)
+            solver.solve_jacobi_hybrid_tasks();
+        else
+            solver.solve_jacobi_hybrid();
         auto end_hybrid = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> hybrid_elapsed = end_hybrid - start_hybrid;
         hybrid_time = hybrid_elapsed.count();
@@ -209,7 +1390,10 @@ int main(int argc, char **argv)
 
         // Mpi test with direct local solver
         auto direct_start = std::chrono::high_resolution_clock::now();
-        solver.solve_direct_mpi();
+        if (direct_hybrid)
+            solver.solve_direct_hybrid();
+        else
+            solver.solve_direct_mpi();
         auto direct_end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> direct_elapsed = direct_end - direct_start;
         direct_time = direct_elapsed.count();
@@ -246,10 +1430,16 @@ int main(int argc, char **argv)
                       << std::setw(15) << std::scientific << std::setprecision(3) << serial_l2 << "\n";
 
             if (n == 64)
+            {
                 solver.save_vtk("solution_" + std::to_string(size) + "_n_" + std::to_string(n));
+                solver.stats().print();
+            }
         }
     }
 
+    if (!trace_file.empty())
+        solver::trace::write(trace_file, MPI_COMM_WORLD);
+
     // Only write results file on rank 0
     if (rank == 0)
     {
@@ -271,6 +1461,8 @@ int main(int argc, char **argv)
         plot::plot();
     }
 
+    if (solver_comm != MPI_COMM_WORLD)
+        MPI_Comm_free(&solver_comm);
     MPI_Finalize();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+/// @file probe.cpp
+/// @brief This file contains the implementation of the interpolation kernels and of the
+///        routing of the points among the processes.
+
+#include <cmath>
+#include <algorithm>
+
+#include "probe.hpp"
+
+namespace solver::probe
+{
+    namespace
+    {
+        /// @brief value clamped to [low, high]
+        /// @details unlike std::clamp it works on values, not references, so that the compiler turns
+        ///          it into selects and the loops of the kernels stay free of branches
+        template <typename T>
+        inline T bound(T value, T low, T high)
+        {
+            value = (value < low) ? low : value;
+            return (value > high) ? high : value;
+        }
+
+        /// @brief position of a coordinate on the grid
+        /// @param x coordinate, clamped to [0, 1]
+        /// @param n number of nodes in the direction
+        /// @param i index of the first node of the cell, in [0, n - 2] (output)
+        /// @return offset of the point in the cell, in [0, 1]
+        /// @details the index is an int: the conversion from double to a 64-bit integer has no vector
+        ///          instruction before AVX-512, and it would prevent the vectorization of the kernels
+        inline double locate(double x, int n, int &i)
+        {
+            const double s = bound(x * (n - 1), 0.0, n - 1.0);
+            i = bound(static_cast<int>(s), 0, n - 2);
+            return s - i;
+        }
+
+        /// @brief weights of the nodes i - 1, i, i + 1, i + 2 of a cubic stencil
+        /// @details named members rather than an array: arrays declared in a simd loop are
+        ///          privatized per lane, and the vectorizer gives up on them
+        struct Weights
+        {
+            double w0, w1, w2, w3;
+        };
+
+        /// @brief Catmull-Rom weights for the offset t from node i, on a line of n nodes
+        /// @details in the first and last cells the missing node is replaced by the extrapolation of
+        ///          Keys, u(-1) = 3 u(0) - 3 u(1) + u(2), which keeps the interpolation third-order
+        ///          accurate up to the boundary; the weight of the missing node is then zero
+        inline Weights cubic_weights(double t, int i, int n)
+        {
+            const double t2 = t * t, t3 = t2 * t;
+            const double w0 = 0.5 * (-t3 + 2.0 * t2 - t), w3 = 0.5 * (t3 - t2);
+
+            // 1 in the first (last) cell and 0 elsewhere, computed without comparisons so that the
+            // compiler does not turn the products into branches
+            const double first = w0 * (1 - bound(i, 0, 1)), last = w3 * bound(i - n + 3, 0, 1);
+            return {w0 + last - first,
+                    0.5 * (3.0 * t3 - 5.0 * t2 + 2.0) + 3.0 * first - 3.0 * last,
+                    0.5 * (-3.0 * t3 + 4.0 * t2 + t) + 3.0 * last - 3.0 * first,
+                    w3 + first - last};
+        }
+    }
+
+    size_t cell_row(double x, size_t n)
+    {
+        int i;
+        locate(x, static_cast<int>(n), i);
+        return static_cast<size_t>(i);
+    }
+
+    void interpolate(const double *block, size_t n, size_t first_row, size_t rows,
+                     const double *x, const double *y, size_t count, Method method, double *values)
+    {
+        const int first = static_cast<int>(first_row), last = first + static_cast<int>(rows) - 1;
+        const int columns = static_cast<int>(n);
+
+        // The nodes are addressed by index rather than by pointer, so that the loads become gathers
+        if (method == Method::Bilinear)
+        {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+            for (size_t k = 0; k < count; ++k)
+            {
+                int i, j;
+                const double t = locate(x[k], columns, i), u = locate(y[k], columns, j);
+                const long node = static_cast<long>(i - first) * columns + j;
+                values[k] = (1.0 - t) * ((1.0 - u) * block[node] + u * block[node + 1]) +
+                            t * ((1.0 - u) * block[node + columns] + u * block[node + columns + 1]);
+            }
+            return;
+        }
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for (size_t k = 0; k < count; ++k)
+        {
+            int i, j;
+            const double t = locate(x[k], columns, i), u = locate(y[k], columns, j);
+            const Weights wx = cubic_weights(t, i, columns), wy = cubic_weights(u, j, columns);
+
+            // The nodes outside the grid have zero weight, their indices are only kept in range
+            const int c0 = bound(j - 1, 0, columns - 1), c3 = bound(j + 2, 0, columns - 1);
+            auto row = [&](int r)
+            {
+                const long offset = static_cast<long>(bound(r, first, last) - first) * columns;
+                return wy.w0 * block[offset + c0] + wy.w1 * block[offset + j] +
+                       wy.w2 * block[offset + j + 1] + wy.w3 * block[offset + c3];
+            };
+            values[k] = wx.w0 * row(i - 1) + wx.w1 * row(i) + wx.w2 * row(i + 1) + wx.w3 * row(i + 2);
+        }
+    }
+
+    std::vector<size_t> partition(size_t n, int size)
+    {
+        // The first n % size processes get one more row, as in Solver::decompose
+        const size_t count = n / size, remainder = n % size;
+        std::vector<size_t> bounds(size + 1, 0);
+        for (int r = 0; r < size; ++r)
+            bounds[r + 1] = bounds[r] + count + ((static_cast<size_t>(r) < remainder) ? 1 : 0);
+        return bounds;
+    }
+
+    void held_rows(const std::vector<size_t> &bounds, int rank, size_t n, size_t &first_row, size_t &rows)
+    {
+        first_row = (bounds[rank] > halo) ? bounds[rank] - halo : 0;
+        rows = std::min(bounds[rank + 1] + halo, n) - first_row;
+    }
+
+    std::vector<double> interpolate(const double *block, size_t n, const std::vector<size_t> &bounds,
+                                    const std::vector<double> &x, const std::vector<double> &y,
+                                    Method method, MPI_Comm comm)
+    {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        const size_t count = x.size();
+
+        // Owner of every point: the process owning the first row of its cell
+        std::vector<int> owner(count), send_counts(size, 0);
+        for (size_t k = 0; k < count; ++k)
+        {
+            owner[k] = static_cast<int>(std::upper_bound(bounds.begin() + 1, bounds.end(), cell_row(x[k], n)) - (bounds.begin() + 1));
+            ++send_counts[owner[k]];
+        }
+        std::vector<int> recv_counts(size);
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+        // Points grouped by owner, as {x, y} pairs; slot[k] is the position of point k
+        std::vector<int> send_displs(size, 0), recv_displs(size, 0);
+        for (int r = 1; r < size; ++r)
+        {
+            send_displs[r] = send_displs[r - 1] + send_counts[r - 1];
+            recv_displs[r] = recv_displs[r - 1] + recv_counts[r - 1];
+        }
+        const size_t received = recv_displs[size - 1] + recv_counts[size - 1];
+        std::vector<size_t> slot(count);
+        std::vector<double> points(2 * count);
+        {
+            std::vector<int> next = send_displs;
+            for (size_t k = 0; k < count; ++k)
+            {
+                slot[k] = next[owner[k]]++;
+                points[2 * slot[k]] = x[k];
+                points[2 * slot[k] + 1] = y[k];
+            }
+        }
+
+        auto doubled = [](std::vector<int> v)
+        {
+            for (int &value : v)
+                value *= 2;
+            return v;
+        };
+        std::vector<double> owned_points(2 * received);
+        MPI_Alltoallv(points.data(), doubled(send_counts).data(), doubled(send_displs).data(), MPI_DOUBLE,
+                      owned_points.data(), doubled(recv_counts).data(), doubled(recv_displs).data(), MPI_DOUBLE, comm);
+
+        // Interpolate the points of the own rows
+        std::vector<double> owned_x(received), owned_y(received), owned_values(received);
+        for (size_t k = 0; k < received; ++k)
+        {
+            owned_x[k] = owned_points[2 * k];
+            owned_y[k] = owned_points[2 * k + 1];
+        }
+        size_t first_row, rows;
+        held_rows(bounds, rank, n, first_row, rows);
+        interpolate(block, n, first_row, rows, owned_x.data(), owned_y.data(), received, method, owned_values.data());
+
+        // Send the values back and restore the order of the caller
+        std::vector<double> grouped(count), values(count);
+        MPI_Alltoallv(owned_values.data(), recv_counts.data(), recv_displs.data(), MPI_DOUBLE,
+                      grouped.data(), send_counts.data(), send_displs.data(), MPI_DOUBLE, comm);
+        for (size_t k = 0; k < count; ++k)
+            values[k] = grouped[slot[k]];
+        return values;
+    }
+} // namespace solver::probe
@@ -0,0 +1,209 @@
+/// @file pyramid.cpp
+/// @brief This file contains the implementation of the multi-resolution writer.
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "pyramid.hpp"
+
+namespace solver::pyramid
+{
+    namespace
+    {
+        /// @brief node of the fine level below node I of the coarse level
+        size_t parent(size_t I, size_t n_fine)
+        {
+            return std::min(2 * I, n_fine - 1);
+        }
+
+        /// @brief store a value as a big-endian float, as required by binary legacy VTK files
+        void put_float(double value, char *out)
+        {
+            const float single = static_cast<float>(value);
+            std::uint32_t bits;
+            std::memcpy(&bits, &single, sizeof(bits));
+            for (int b = 0; b < 4; ++b)
+                out[b] = static_cast<char>((bits >> (24 - 8 * b)) & 0xff);
+        }
+
+        /// @brief write one level with MPI-IO, each process writing its own rows
+        /// @param filename output file
+        /// @param slab rows [first_row, first_row + rows) of the level
+        /// @param n number of rows and columns of the level
+        /// @param coordinate coordinate of each row (and column) of the level
+        /// @param comm communicator among which the level is distributed
+        void write_level(const std::string &filename, const double *slab, size_t n, size_t first_row, size_t rows,
+                         const std::vector<double> &coordinate, MPI_Comm comm)
+        {
+            int rank;
+            MPI_Comm_rank(comm, &rank);
+
+            const size_t points = n * n;
+            const std::string header = "# vtk DataFile Version 3.0\nvtk output\nBINARY\nDATASET STRUCTURED_GRID\n"
+                                       "DIMENSIONS " + std::to_string(n) + " " + std::to_string(n) + " 1\n"
+                                       "POINTS " + std::to_string(points) + " float\n";
+            const std::string middle = "\nPOINT_DATA " + std::to_string(points) + "\nSCALARS values float\nLOOKUP_TABLE default\n";
+
+            std::vector<char> coordinates(12 * rows * n), values(4 * rows * n);
+            for (size_t i = 0; i < rows; ++i)
+            {
+                for (size_t j = 0; j < n; ++j)
+                {
+                    const size_t k = i * n + j;
+                    put_float(coordinate[first_row + i], &coordinates[12 * k]);
+                    put_float(coordinate[j], &coordinates[12 * k + 4]);
+                    put_float(0.0, &coordinates[12 * k + 8]);
+                    put_float(slab[k], &values[4 * k]);
+                }
+            }
+
+            // Rows as datatypes, so that the counts fit in an int for any grid
+            MPI_Datatype coordinate_row, value_row;
+            MPI_Type_contiguous(static_cast<int>(12 * n), MPI_BYTE, &coordinate_row);
+            MPI_Type_contiguous(static_cast<int>(4 * n), MPI_BYTE, &value_row);
+            MPI_Type_commit(&coordinate_row);
+            MPI_Type_commit(&value_row);
+
+            MPI_File file;
+            MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+            MPI_File_set_size(file, 0);
+            const MPI_Offset values_offset = header.size() + 12 * points + middle.size();
+            if (rank == 0)
+            {
+                MPI_File_write_at(file, 0, header.data(), static_cast<int>(header.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+                MPI_File_write_at(file, header.size() + 12 * points, middle.data(), static_cast<int>(middle.size()),
+                                  MPI_CHAR, MPI_STATUS_IGNORE);
+                MPI_File_write_at(file, values_offset + 4 * points, "\n", 1, MPI_CHAR, MPI_STATUS_IGNORE);
+            }
+            MPI_File_write_at_all(file, header.size() + 12 * first_row * n, coordinates.data(), static_cast<int>(rows),
+                                  coordinate_row, MPI_STATUS_IGNORE);
+            MPI_File_write_at_all(file, values_offset + 4 * first_row * n, values.data(), static_cast<int>(rows),
+                                  value_row, MPI_STATUS_IGNORE);
+            MPI_File_close(&file);
+
+            MPI_Type_free(&coordinate_row);
+            MPI_Type_free(&value_row);
+        }
+
+        /// @brief rows of the fine level that a process needs beyond its own to build its coarse rows
+        /// @param above row above the slab, or n_fine if none (output)
+        /// @param below row below the slab, or n_fine if none (output)
+        void ghost_rows(const std::vector<size_t> &fine_bounds, const std::vector<size_t> &coarse_bounds, int rank,
+                        size_t n_fine, size_t &above, size_t &below)
+        {
+            above = below = n_fine;
+            if (coarse_bounds[rank] == coarse_bounds[rank + 1])
+                return;
+            const size_t low = parent(coarse_bounds[rank], n_fine);
+            const size_t high = parent(coarse_bounds[rank + 1] - 1, n_fine);
+            if (low > 0 && low - 1 < fine_bounds[rank])
+                above = low - 1;
+            if (high + 1 < n_fine && high + 1 >= fine_bounds[rank + 1])
+                below = high + 1;
+        }
+    }
+
+    size_t coarse_size(size_t n)
+    {
+        return n / 2 + 1;
+    }
+
+    std::string level_name(const std::string &basename, size_t level)
+    {
+        return (level == 0) ? basename + ".vtk" : basename + "_level" + std::to_string(level) + ".vtk";
+    }
+
+    size_t write(const double *slab, size_t n, const std::vector<size_t> &bounds,
+                 const std::string &basename, size_t min_size, MPI_Comm comm)
+    {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        // Full resolution
+        std::vector<double> coordinate(n);
+        for (size_t i = 0; i < n; ++i)
+            coordinate[i] = static_cast<double>(i) / (n - 1);
+        write_level(level_name(basename, 0), slab, n, bounds[rank], bounds[rank + 1] - bounds[rank], coordinate, comm);
+
+        // The full resolution is read in place, the coarse levels are built in fine and coarse
+        std::vector<size_t> fine_bounds = bounds;
+        const double *current = slab;
+        std::vector<double> fine, coarse;
+        size_t levels = 1;
+        for (size_t n_fine = n; n_fine > min_size && n_fine > 2; n_fine = coarse_size(n_fine), ++levels)
+        {
+            const size_t n_coarse = coarse_size(n_fine);
+
+            // Coarse row I belongs to the process owning its parent row, so the slabs stay contiguous
+            std::vector<size_t> coarse_bounds(size + 1);
+            for (int r = 0; r <= size; ++r)
+                coarse_bounds[r] = (fine_bounds[r] == n_fine) ? n_coarse : (fine_bounds[r] + 1) / 2;
+
+            // Rows of the neighbouring slabs entering the stencil of the first and last coarse rows
+            auto owner = [&](size_t row)
+            {
+                return static_cast<int>(std::upper_bound(fine_bounds.begin() + 1, fine_bounds.end(), row) - (fine_bounds.begin() + 1));
+            };
+            std::vector<double> ghost_above(n_fine), ghost_below(n_fine);
+            std::vector<MPI_Request> requests;
+            for (int q = 0; q < size; ++q)
+            {
+                size_t above, below;
+                ghost_rows(fine_bounds, coarse_bounds, q, n_fine, above, below);
+                if (q == rank)
+                {
+                    if (above < n_fine)
+                        MPI_Irecv(ghost_above.data(), n_fine, MPI_DOUBLE, owner(above), 0, comm, &requests.emplace_back());
+                    if (below < n_fine)
+                        MPI_Irecv(ghost_below.data(), n_fine, MPI_DOUBLE, owner(below), 1, comm, &requests.emplace_back());
+                    continue;
+                }
+                if (above < n_fine && owner(above) == rank)
+                    MPI_Isend(current + (above - fine_bounds[rank]) * n_fine, n_fine, MPI_DOUBLE, q, 0, comm, &requests.emplace_back());
+                if (below < n_fine && owner(below) == rank)
+                    MPI_Isend(current + (below - fine_bounds[rank]) * n_fine, n_fine, MPI_DOUBLE, q, 1, comm, &requests.emplace_back());
+            }
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+            auto fine_row = [&](size_t row) -> const double *
+            {
+                if (row < fine_bounds[rank])
+                    return ghost_above.data();
+                if (row >= fine_bounds[rank + 1])
+                    return ghost_below.data();
+                return current + (row - fine_bounds[rank]) * n_fine;
+            };
+
+            // Full weighting: vertical pass into a row of the fine width, then horizontal pass
+            const size_t first = coarse_bounds[rank], rows = coarse_bounds[rank + 1] - first;
+            coarse.assign(rows * n_coarse, 0.0);
+            std::vector<double> column_sum(n_fine);
+            for (size_t I = 0; I < rows; ++I)
+            {
+                const size_t r = parent(first + I, n_fine);
+                const double *up = fine_row((r > 0) ? r - 1 : r), *middle = fine_row(r);
+                const double *down = fine_row(std::min(r + 1, n_fine - 1));
+                for (size_t c = 0; c < n_fine; ++c)
+                    column_sum[c] = 0.25 * up[c] + 0.5 * middle[c] + 0.25 * down[c];
+                for (size_t J = 0; J < n_coarse; ++J)
+                {
+                    const size_t c = parent(J, n_fine);
+                    coarse[I * n_coarse + J] = 0.25 * column_sum[(c > 0) ? c - 1 : c] + 0.5 * column_sum[c] +
+                                               0.25 * column_sum[std::min(c + 1, n_fine - 1)];
+                }
+            }
+
+            for (size_t I = 0; I < n_coarse; ++I)
+                coordinate[I] = coordinate[parent(I, n_fine)];
+            coordinate.resize(n_coarse);
+            write_level(level_name(basename, levels), coarse.data(), n_coarse, first, rows, coordinate, comm);
+
+            fine.swap(coarse);
+            current = fine.data();
+            fine_bounds.swap(coarse_bounds);
+        }
+        return levels;
+    }
+} // namespace solver::pyramid
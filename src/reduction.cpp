@@ -0,0 +1,121 @@
+/// @file reduction.cpp
+/// @brief This file contains the implementation of the node-aware allreduce.
+
+#include <algorithm>
+
+#include "reduction.hpp"
+
+namespace solver::reduction
+{
+    Allreduce::Allreduce(MPI_Comm comm, Algorithm algorithm, int node_size, size_t capacity)
+        : comm(comm), capacity(capacity)
+    {
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+
+        // Ranks sharing memory, possibly split into emulated nodes of node_size ranks
+        MPI_Comm shared;
+        MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &shared);
+        if (node_size > 0)
+        {
+            int shared_rank;
+            MPI_Comm_rank(shared, &shared_rank);
+            MPI_Comm_split(shared, shared_rank / node_size, shared_rank, &node_comm);
+            MPI_Comm_free(&shared);
+        }
+        else
+            node_comm = shared;
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_size(node_comm, &node_ranks);
+
+        // The first rank of every node is its leader
+        MPI_Comm_split(comm, (node_rank == 0) ? 0 : MPI_UNDEFINED, rank, &leader_comm);
+        if (leader_comm != MPI_COMM_NULL)
+            MPI_Comm_size(leader_comm, &node_count);
+        MPI_Bcast(&node_count, 1, MPI_INT, 0, node_comm);
+
+        // Two levels pay off only if some node has several ranks and there are several nodes
+        int max_node_ranks;
+        MPI_Allreduce(&node_ranks, &max_node_ranks, 1, MPI_INT, MPI_MAX, comm);
+        const bool two_levels = (algorithm == Algorithm::Hierarchical) ||
+                                (algorithm == Algorithm::Automatic && node_count > 1 && max_node_ranks > 1);
+        if (!two_levels)
+        {
+            MPI_Comm_free(&node_comm);
+            if (leader_comm != MPI_COMM_NULL)
+                MPI_Comm_free(&leader_comm);
+            node_rank = 0;
+            node_ranks = 1;
+            return;
+        }
+
+        // The leader allocates the slots of the whole node and the result, contiguously
+        const MPI_Aint bytes = (node_rank == 0) ? static_cast<MPI_Aint>((node_ranks + 1) * capacity * sizeof(double)) : 0;
+        double *local;
+        MPI_Win_allocate_shared(bytes, sizeof(double), MPI_INFO_NULL, node_comm, &local, &window);
+        MPI_Aint leader_bytes;
+        int displacement;
+        MPI_Win_shared_query(window, 0, &leader_bytes, &displacement, &slots);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+    }
+
+    Allreduce::~Allreduce()
+    {
+        // A solver may outlive MPI, in which case its handles are gone already
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (finalized)
+            return;
+        if (window != MPI_WIN_NULL)
+        {
+            MPI_Win_unlock_all(window);
+            MPI_Win_free(&window);
+        }
+        if (leader_comm != MPI_COMM_NULL)
+            MPI_Comm_free(&leader_comm);
+        if (node_comm != MPI_COMM_NULL)
+            MPI_Comm_free(&node_comm);
+    }
+
+    void Allreduce::reduce(double *values, int count, MPI_Op op) const
+    {
+        if (!hierarchical())
+        {
+            MPI_Allreduce(MPI_IN_PLACE, values, count, MPI_DOUBLE, op, comm);
+            return;
+        }
+
+        if (static_cast<size_t>(count) > capacity)
+        {
+            MPI_Reduce((node_rank == 0) ? MPI_IN_PLACE : values, values, count, MPI_DOUBLE, op, 0, node_comm);
+            if (leader_comm != MPI_COMM_NULL && node_count > 1)
+                MPI_Allreduce(MPI_IN_PLACE, values, count, MPI_DOUBLE, op, leader_comm);
+            MPI_Bcast(values, count, MPI_DOUBLE, 0, node_comm);
+            return;
+        }
+
+        // Every rank publishes its values in its slot
+        double *result = slots + node_ranks * capacity;
+        std::copy(values, values + count, slots + node_rank * capacity);
+        MPI_Win_sync(window);
+        MPI_Barrier(node_comm);
+        MPI_Win_sync(window);
+
+        // The leader combines the slots of the node, then the nodes combine their results
+        if (node_rank == 0)
+        {
+            std::copy(values, values + count, result);
+            for (int r = 1; r < node_ranks; ++r)
+                MPI_Reduce_local(slots + r * capacity, result, count, MPI_DOUBLE, op);
+            if (node_count > 1)
+                MPI_Allreduce(MPI_IN_PLACE, result, count, MPI_DOUBLE, op, leader_comm);
+            MPI_Win_sync(window);
+        }
+
+        // The slots are not written again before every rank has passed this barrier and read
+        // the result, so two barriers per reduction are enough
+        MPI_Barrier(node_comm);
+        MPI_Win_sync(window);
+        std::copy(result, result + count, values);
+    }
+} // namespace solver::reduction
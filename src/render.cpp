@@ -0,0 +1,267 @@
+/// @file render.cpp
+/// @brief This file contains the implementation of the heatmap renderer and of its PNG and
+///        PPM encoders.
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+#include "render.hpp"
+#include "probe.hpp"
+
+namespace solver::render
+{
+    namespace
+    {
+        /// @brief viridis colour map sampled at 0, 1/8, ..., 1
+        constexpr unsigned char viridis[9][3] = {{68, 1, 84}, {71, 44, 122}, {59, 81, 139}, {44, 113, 142}, {33, 144, 141},
+                                                 {39, 173, 129}, {92, 200, 99}, {170, 220, 50}, {253, 231, 37}};
+
+        /// @brief largest payload of a stored deflate block
+        constexpr size_t max_stored_block = 65535;
+
+        /// @brief Adler-32 checksum of a byte sequence (1 for an empty one)
+        std::uint32_t adler32(const unsigned char *data, size_t length)
+        {
+            constexpr std::uint32_t base = 65521;
+            std::uint32_t a = 1, b = 0;
+            while (length > 0)
+            {
+                // 5552 is the largest number of bytes that cannot overflow b before the reduction
+                const size_t chunk = std::min<size_t>(length, 5552);
+                for (size_t k = 0; k < chunk; ++k)
+                {
+                    a += data[k];
+                    b += a;
+                }
+                a %= base;
+                b %= base;
+                data += chunk;
+                length -= chunk;
+            }
+            return (b << 16) | a;
+        }
+
+        /// @brief CRC-32 of a byte sequence, continuing from the CRC of the bytes before it
+        std::uint32_t crc32(const unsigned char *data, size_t length, std::uint32_t crc = 0)
+        {
+            static const auto table = []
+            {
+                std::vector<std::uint32_t> values(256);
+                for (std::uint32_t k = 0; k < 256; ++k)
+                {
+                    std::uint32_t c = k;
+                    for (int bit = 0; bit < 8; ++bit)
+                        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                    values[k] = c;
+                }
+                return values;
+            }();
+
+            crc = ~crc;
+            for (size_t k = 0; k < length; ++k)
+                crc = table[(crc ^ data[k]) & 0xff] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        /// @brief append a 32-bit big-endian integer
+        void put_u32(std::vector<unsigned char> &out, std::uint32_t value)
+        {
+            for (int shift = 24; shift >= 0; shift -= 8)
+                out.push_back(static_cast<unsigned char>(value >> shift));
+        }
+
+        /// @brief append a PNG chunk: length, type, data and CRC of type and data
+        void put_chunk(std::vector<unsigned char> &png, const char *type, const std::vector<unsigned char> &data)
+        {
+            put_u32(png, static_cast<std::uint32_t>(data.size()));
+            const size_t start = png.size();
+            png.insert(png.end(), type, type + 4);
+            png.insert(png.end(), data.begin(), data.end());
+            put_u32(png, crc32(&png[start], png.size() - start));
+        }
+
+        /// @brief write the image with MPI-IO, each process writing its strip of pixel rows
+        void write_ppm(const std::vector<unsigned char> &rgb, size_t first_pixel_row, size_t pixel_rows,
+                       const Options &options, const std::string &filename, MPI_Comm comm)
+        {
+            int rank;
+            MPI_Comm_rank(comm, &rank);
+            const std::string header = "P6\n" + std::to_string(options.width) + " " + std::to_string(options.height) + "\n255\n";
+
+            MPI_Datatype pixel_row;
+            MPI_Type_contiguous(static_cast<int>(3 * options.width), MPI_BYTE, &pixel_row);
+            MPI_Type_commit(&pixel_row);
+
+            MPI_File file;
+            MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+            MPI_File_set_size(file, 0);
+            if (rank == 0)
+                MPI_File_write_at(file, 0, header.data(), static_cast<int>(header.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+            MPI_File_write_at_all(file, header.size() + 3 * options.width * first_pixel_row, rgb.data(),
+                                  static_cast<int>(pixel_rows), pixel_row, MPI_STATUS_IGNORE);
+            MPI_File_close(&file);
+            MPI_Type_free(&pixel_row);
+        }
+
+        /// @brief encode the strips as stored deflate blocks, and assemble the PNG file on rank 0
+        void write_png(const std::vector<unsigned char> &rgb, size_t pixel_rows, const Options &options,
+                       const std::string &filename, MPI_Comm comm)
+        {
+            int rank, size;
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+
+            // Scanlines of the strip, each preceded by its filter type (0, none)
+            const size_t line = 3 * options.width;
+            std::vector<unsigned char> raw(pixel_rows * (line + 1));
+            for (size_t p = 0; p < pixel_rows; ++p)
+            {
+                raw[p * (line + 1)] = 0;
+                std::copy(rgb.begin() + p * line, rgb.begin() + (p + 1) * line, raw.begin() + p * (line + 1) + 1);
+            }
+
+            // Non-final stored blocks: they are byte-aligned, so the pieces of the processes can be concatenated
+            std::vector<unsigned char> blocks;
+            blocks.reserve(raw.size() + 5 * (raw.size() / max_stored_block + 1));
+            for (size_t offset = 0; offset < raw.size(); offset += max_stored_block)
+            {
+                const size_t length = std::min(max_stored_block, raw.size() - offset);
+                blocks.push_back(0);
+                blocks.push_back(static_cast<unsigned char>(length & 0xff));
+                blocks.push_back(static_cast<unsigned char>(length >> 8));
+                blocks.push_back(static_cast<unsigned char>(~length & 0xff));
+                blocks.push_back(static_cast<unsigned char>((~length >> 8) & 0xff));
+                blocks.insert(blocks.end(), raw.begin() + offset, raw.begin() + offset + length);
+            }
+
+            // Compositing: the pieces and their checksums are collected on rank 0
+            const unsigned long long piece[2] = {adler32(raw.data(), raw.size()), raw.size()};
+            std::vector<unsigned long long> pieces(2 * size);
+            MPI_Gather(piece, 2, MPI_UNSIGNED_LONG_LONG, pieces.data(), 2, MPI_UNSIGNED_LONG_LONG, 0, comm);
+
+            const int local_bytes = static_cast<int>(blocks.size());
+            std::vector<int> bytes(size), displs(size, 0);
+            MPI_Gather(&local_bytes, 1, MPI_INT, bytes.data(), 1, MPI_INT, 0, comm);
+            for (int r = 1; r < size; ++r)
+                displs[r] = displs[r - 1] + bytes[r - 1];
+
+            // zlib stream: header, blocks of all the processes, final empty block and checksum
+            std::vector<unsigned char> zlib;
+            if (rank == 0)
+            {
+                zlib.resize(2 + displs[size - 1] + bytes[size - 1]);
+                zlib[0] = 0x78;
+                zlib[1] = 0x01;
+            }
+            MPI_Gatherv(blocks.data(), local_bytes, MPI_UNSIGNED_CHAR, zlib.data() + ((rank == 0) ? 2 : 0),
+                        bytes.data(), displs.data(), MPI_UNSIGNED_CHAR, 0, comm);
+            if (rank != 0)
+                return;
+
+            std::uint32_t adler = 1;
+            for (int r = 0; r < size; ++r)
+                adler = adler32_combine(adler, static_cast<std::uint32_t>(pieces[2 * r]), pieces[2 * r + 1]);
+            zlib.insert(zlib.end(), {0x01, 0x00, 0x00, 0xff, 0xff});
+            put_u32(zlib, adler);
+
+            std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+            std::vector<unsigned char> header;
+            put_u32(header, static_cast<std::uint32_t>(options.width));
+            put_u32(header, static_cast<std::uint32_t>(options.height));
+            header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bits per channel, RGB, deflate, no interlace
+            put_chunk(png, "IHDR", header);
+            put_chunk(png, "IDAT", zlib);
+            put_chunk(png, "IEND", {});
+
+            std::ofstream file(filename, std::ios::binary);
+            file.write(reinterpret_cast<const char *>(png.data()), png.size());
+        }
+    }
+
+    void colour(double t, unsigned char rgb[3])
+    {
+        const double s = std::clamp(t, 0.0, 1.0) * 8.0;
+        const size_t k = std::min<size_t>(static_cast<size_t>(s), 7);
+        const double w = s - static_cast<double>(k);
+        for (int c = 0; c < 3; ++c)
+            rgb[c] = static_cast<unsigned char>((1.0 - w) * viridis[k][c] + w * viridis[k + 1][c] + 0.5);
+    }
+
+    std::uint32_t adler32_combine(std::uint32_t first, std::uint32_t second, size_t second_length)
+    {
+        constexpr std::uint32_t base = 65521;
+        const std::uint32_t remainder = static_cast<std::uint32_t>(second_length % base);
+        std::uint32_t a = first & 0xffff;
+        std::uint32_t b = static_cast<std::uint32_t>((static_cast<std::uint64_t>(remainder) * a) % base);
+        a += (second & 0xffff) + base - 1;
+        b += (first >> 16) + (second >> 16) + base - remainder;
+        if (a >= base)
+            a -= base;
+        if (a >= base)
+            a -= base;
+        if (b >= 2 * base)
+            b -= 2 * base;
+        if (b >= base)
+            b -= base;
+        return (b << 16) | a;
+    }
+
+    void heatmap(const double *block, size_t n, size_t first_row, size_t rows, const std::vector<size_t> &bounds,
+                 const Options &options, const std::string &basename, MPI_Comm comm)
+    {
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+        const size_t width = options.width, height = options.height;
+
+        // Pixel rows whose cell lies in the own rows of the grid
+        auto pixel_x = [&](size_t p)
+        { return (height > 1) ? static_cast<double>(p) / (height - 1) : 0.0; };
+        size_t first_pixel_row = 0, end_pixel_row = 0;
+        for (size_t p = 0; p < height; ++p)
+        {
+            const size_t cell = probe::cell_row(pixel_x(p), n);
+            first_pixel_row += (cell < bounds[rank]) ? 1 : 0;
+            end_pixel_row += (cell < bounds[rank + 1]) ? 1 : 0;
+        }
+        const size_t pixel_rows = end_pixel_row - first_pixel_row;
+
+        // Range of the values: a single reduction of {-min, max}
+        double range[2] = {-options.low, options.high};
+        if (!options.fixed_range)
+        {
+            range[0] = range[1] = -std::numeric_limits<double>::infinity();
+            for (size_t i = bounds[rank]; i < bounds[rank + 1]; ++i)
+            {
+                for (size_t j = 0; j < n; ++j)
+                {
+                    const double value = block[(i - first_row) * n + j];
+                    range[0] = std::max(range[0], -value);
+                    range[1] = std::max(range[1], value);
+                }
+            }
+            MPI_Allreduce(MPI_IN_PLACE, range, 2, MPI_DOUBLE, MPI_MAX, comm);
+        }
+        const double low = -range[0], scale = (range[1] > low) ? 1.0 / (range[1] - low) : 0.0;
+
+        // Rasterize the strip
+        std::vector<double> x(pixel_rows * width), y(pixel_rows * width), values(pixel_rows * width);
+        for (size_t p = 0; p < pixel_rows; ++p)
+        {
+            for (size_t q = 0; q < width; ++q)
+            {
+                x[p * width + q] = pixel_x(first_pixel_row + p);
+                y[p * width + q] = (width > 1) ? static_cast<double>(q) / (width - 1) : 0.0;
+            }
+        }
+        probe::interpolate(block, n, first_row, rows, x.data(), y.data(), values.size(), probe::Method::Bilinear, values.data());
+        std::vector<unsigned char> rgb(3 * values.size());
+        for (size_t k = 0; k < values.size(); ++k)
+            colour((values[k] - low) * scale, &rgb[3 * k]);
+
+        if (options.format == Format::PPM)
+            write_ppm(rgb, first_pixel_row, pixel_rows, options, basename + ".ppm", comm);
+        else
+            write_png(rgb, pixel_rows, options, basename + ".png", comm);
+    }
+} // namespace solver::render
@@ -0,0 +1,279 @@
+/// @file scaling.cpp
+/// @brief This file contains the implementation of the scaling experiments.
+/// @details The processes that do not take part in a run wait at a barrier of the
+///          whole communicator; with Open MPI, run with --mca mpi_yield_when_idle 1
+///          so that they do not compete for the cores with the active ones.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+
+#include "scaling.hpp"
+#include "solver.hpp"
+#include "trace.hpp"
+#include "quiet_cout.hpp"
+
+namespace solver::scaling
+{
+    namespace
+    {
+        /// @brief homogeneous boundary condition
+        /// @details plain functions rather than lambdas: copying the empty state of a captureless
+        ///          lambda stored in std::function trips GCC's -Wmaybe-uninitialized at -O3
+        double zero(std::vector<double>)
+        {
+            return 0.0;
+        }
+
+        /// @brief right-hand side whose solution is sin(2 pi x) sin(2 pi y)
+        double forcing(std::vector<double> x)
+        {
+            constexpr auto pi = std::numbers::pi;
+            return 8 * pi * pi * sin(2 * pi * x[0]) * sin(2 * pi * x[1]);
+        }
+
+        /// @brief run the method once on comm and measure wall and communication time, and energy
+        void measure(const Options &options, size_t n, unsigned threads, MPI_Comm comm, double &seconds, double &comm_seconds,
+                     double &joules)
+        {
+            Solver solver;
+            solver.set_bc(zero, zero, zero, zero);
+            solver.set_f(forcing);
+            solver.set_n(n);
+            solver.reset();
+            solver.set_max_iter(options.iterations);
+            solver.set_tol(0.0);
+            solver.set_num_threads(threads);
+            solver.set_comm(comm);
+
+            trace::start(comm, 16 * (threads + 4) * options.iterations);
+            MPI_Barrier(comm);
+            double start = MPI_Wtime();
+            {
+                QuietCout quiet;
+                if (options.method == "jacobi_mpi")
+                    solver.solve_jacobi_mpi();
+                else if (options.method == "jacobi_hybrid_tasks")
+                    solver.solve_jacobi_hybrid_tasks();
+                else if (options.method == "direct_mpi")
+                    solver.solve_direct_mpi();
+                else if (options.method == "direct_hybrid")
+                    solver.solve_direct_hybrid();
+                else
+                    solver.solve_jacobi_hybrid();
+            }
+            double elapsed = MPI_Wtime() - start;
+            trace::enabled = false;
+
+            // Time spent in halo exchanges and reductions by this process
+            double local_comm = 0.0;
+            for (const trace::Event &event : trace::local_events())
+            {
+                if (event.phase == trace::Phase::Exchange || event.phase == trace::Phase::Reduction)
+                    local_comm += event.end - event.begin;
+            }
+
+            MPI_Allreduce(&elapsed, &seconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+            MPI_Allreduce(&local_comm, &comm_seconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+            // The RAPL counters are node-wide: the first process of every node contributes its
+            // measurement, and the energy is unavailable if any process could not measure it
+            const double measured = solver.stats().energy.joules;
+            MPI_Comm node;
+            int node_rank;
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+            MPI_Comm_rank(node, &node_rank);
+            MPI_Comm_free(&node);
+            double local_energy[2] = {(node_rank == 0 && measured > 0.0) ? measured : 0.0, (measured < 0.0) ? 1.0 : 0.0};
+            double energy[2];
+            MPI_Allreduce(local_energy, energy, 2, MPI_DOUBLE, MPI_SUM, comm);
+            joules = (energy[1] > 0.0) ? -1.0 : energy[0];
+        }
+
+        /// @brief name of a mode
+        const char *mode_name(Mode mode)
+        {
+            return (mode == Mode::Strong) ? "strong" : "weak";
+        }
+    }
+
+    size_t grid_size(const Options &options, unsigned pes)
+    {
+        if (options.mode == Mode::Strong)
+            return options.n;
+        return static_cast<size_t>(std::lround(options.n * std::sqrt(static_cast<double>(pes))));
+    }
+
+    std::vector<Point> run(const Options &options, MPI_Comm comm)
+    {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        std::vector<int> ranks = options.ranks;
+        if (ranks.empty())
+        {
+            for (int r = 1; r < size; r *= 2)
+                ranks.push_back(r);
+            ranks.push_back(size);
+        }
+
+        // The reference run (1 process, 1 thread) is always needed by the metrics
+        std::vector<unsigned> threads = options.threads;
+        if (std::find(threads.begin(), threads.end(), 1u) == threads.end())
+            threads.insert(threads.begin(), 1u);
+        if (std::find(ranks.begin(), ranks.end(), 1) == ranks.end())
+            ranks.insert(ranks.begin(), 1);
+
+        std::vector<Point> points;
+        for (int r : ranks)
+        {
+            if (r > size)
+            {
+                if (rank == 0)
+                    std::cerr << "Warning: skipping " << r << " processes, only " << size << " available." << std::endl;
+                continue;
+            }
+
+            // The first r processes run, the others wait
+            MPI_Comm sub;
+            MPI_Comm_split(comm, (rank < r) ? 0 : MPI_UNDEFINED, rank, &sub);
+
+            for (unsigned t : threads)
+            {
+                Point point{r, t, grid_size(options, r * t), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, -1.0};
+                if (sub != MPI_COMM_NULL)
+                    measure(options, point.n, t, sub, point.seconds, point.comm_seconds, point.joules);
+                if (rank == 0)
+                    points.push_back(point);
+                MPI_Barrier(comm);
+            }
+
+            if (sub != MPI_COMM_NULL)
+                MPI_Comm_free(&sub);
+        }
+
+        if (rank == 0)
+            compute_metrics(points, options.mode);
+        return points;
+    }
+
+    void compute_metrics(std::vector<Point> &points, Mode mode)
+    {
+        auto reference = std::find_if(points.begin(), points.end(), [](const Point &point)
+                                      { return point.ranks == 1 && point.threads == 1; });
+        if (reference == points.end())
+            return;
+        const double t1 = reference->seconds;
+
+        for (Point &point : points)
+        {
+            const double p = static_cast<double>(point.ranks) * point.threads;
+            if (mode == Mode::Strong)
+            {
+                point.speedup = t1 / point.seconds;
+                point.efficiency = point.speedup / p;
+            }
+            else
+            {
+                // The work grows with p, so the ideal time is constant
+                point.efficiency = t1 / point.seconds;
+                point.speedup = p * point.efficiency;
+            }
+            point.karp_flatt = (p > 1.0) ? (1.0 / point.speedup - 1.0 / p) / (1.0 - 1.0 / p) : 0.0;
+            point.comm_fraction = (point.seconds > 0.0) ? point.comm_seconds / point.seconds : 0.0;
+        }
+    }
+
+    void write_csv(const std::vector<Point> &points, const Options &options, const std::string &filename)
+    {
+        std::ofstream ofs(filename);
+        if (!ofs)
+        {
+            std::cerr << "Error: cannot open " << filename << " for writing." << std::endl;
+            return;
+        }
+        ofs << "mode,method,iterations,ranks,threads,pes,n,seconds,comm_seconds,speedup,efficiency,karp_flatt,comm_fraction,joules\n";
+        for (const Point &point : points)
+        {
+            ofs << mode_name(options.mode) << "," << options.method << "," << options.iterations << ","
+                << point.ranks << "," << point.threads << "," << point.ranks * point.threads << "," << point.n << ","
+                << point.seconds << "," << point.comm_seconds << "," << point.speedup << "," << point.efficiency << ","
+                << point.karp_flatt << "," << point.comm_fraction << "," << point.joules << "\n";
+        }
+    }
+
+    std::vector<Point> read_csv(const std::string &filename)
+    {
+        std::vector<Point> points;
+        std::ifstream ifs(filename);
+        std::string line;
+
+        // Skip header line
+        std::getline(ifs, line);
+
+        while (std::getline(ifs, line))
+        {
+            std::stringstream ss(line);
+            std::vector<std::string> cells;
+            std::string cell;
+            while (std::getline(ss, cell, ','))
+                cells.push_back(cell);
+            // Files written before the energy column have 13 cells
+            if (cells.size() != 13 && cells.size() != 14)
+                continue;
+
+            Point point;
+            point.ranks = std::stoi(cells[3]);
+            point.threads = std::stoul(cells[4]);
+            point.n = std::stoul(cells[6]);
+            point.seconds = std::stod(cells[7]);
+            point.comm_seconds = std::stod(cells[8]);
+            point.speedup = std::stod(cells[9]);
+            point.efficiency = std::stod(cells[10]);
+            point.karp_flatt = std::stod(cells[11]);
+            point.comm_fraction = std::stod(cells[12]);
+            point.joules = (cells.size() > 13) ? std::stod(cells[13]) : -1.0;
+            points.push_back(point);
+        }
+        return points;
+    }
+
+    void print(const std::vector<Point> &points, const Options &options)
+    {
+        std::cout << "=== " << (options.mode == Mode::Strong ? "Strong" : "Weak") << " scaling of " << options.method
+                  << " (" << options.iterations << " iterations) ===" << std::endl;
+        std::cout << std::setw(8) << "ranks"
+                  << std::setw(8) << "threads"
+                  << std::setw(8) << "n"
+                  << std::setw(15) << "Time(s)"
+                  << std::setw(15) << "Comm(s)"
+                  << std::setw(10) << "Speedup"
+                  << std::setw(12) << "Efficiency"
+                  << std::setw(12) << "Karp-Flatt"
+                  << std::setw(12) << "Comm frac"
+                  << std::setw(12) << "Energy(J)"
+                  << std::setw(10) << "Power(W)" << "\n";
+        for (const Point &point : points)
+        {
+            std::cout << std::setw(8) << point.ranks
+                      << std::setw(8) << point.threads
+                      << std::setw(8) << point.n
+                      << std::setw(15) << std::fixed << std::setprecision(6) << point.seconds
+                      << std::setw(15) << std::fixed << std::setprecision(6) << point.comm_seconds
+                      << std::setw(10) << std::fixed << std::setprecision(3) << point.speedup
+                      << std::setw(12) << std::fixed << std::setprecision(3) << point.efficiency
+                      << std::setw(12) << std::fixed << std::setprecision(4) << point.karp_flatt
+                      << std::setw(12) << std::fixed << std::setprecision(3) << point.comm_fraction;
+            if (point.joules >= 0.0)
+                std::cout << std::setw(12) << std::fixed << std::setprecision(3) << point.joules
+                          << std::setw(10) << std::fixed << std::setprecision(1) << point.joules / point.seconds << "\n";
+            else
+                std::cout << std::setw(12) << "n/a" << std::setw(10) << "n/a" << "\n";
+        }
+    }
+} // namespace solver::scaling
@@ -0,0 +1,96 @@
+/// @file separable.cpp
+/// @brief This file contains the implementation of the separability test.
+
+#include <cmath>
+#include <algorithm>
+
+#include "separable.hpp"
+
+namespace solver::separable
+{
+    namespace
+    {
+        /// @brief k-th sample point in (0, 1), irregularly spaced (golden ratio sequence)
+        double sample_point(size_t k, double offset)
+        {
+            double value = offset + 0.6180339887498949 * static_cast<double>(k);
+            return value - std::floor(value);
+        }
+    }
+
+    bool detect(const function_type &f, Factors &factors, double tol)
+    {
+        // Sample matrix M_ij = f(x_i, y_j)
+        double x[samples], y[samples], M[samples][samples];
+        for (size_t k = 0; k < samples; ++k)
+        {
+            x[k] = sample_point(k, 0.1234);
+            y[k] = sample_point(k, 0.3817);
+        }
+
+        size_t p = 0, q = 0;
+        for (size_t i = 0; i < samples; ++i)
+        {
+            for (size_t j = 0; j < samples; ++j)
+            {
+                M[i][j] = f({x[i], y[j]});
+                if (std::abs(M[i][j]) > std::abs(M[p][q]))
+                {
+                    p = i;
+                    q = j;
+                }
+            }
+        }
+
+        const double pivot = M[p][q];
+        if (pivot == 0.0 || !std::isfinite(pivot))
+            return false;
+
+        // Every 2x2 minor through the pivot must vanish
+        for (size_t i = 0; i < samples; ++i)
+        {
+            for (size_t j = 0; j < samples; ++j)
+            {
+                if (std::abs(M[i][j] * pivot - M[i][q] * M[p][j]) > tol * pivot * pivot)
+                    return false;
+            }
+        }
+
+        const double x_pivot = x[p], y_pivot = y[q];
+        factors.g = [f, y_pivot](std::vector<double> point)
+        { return f({point[0], y_pivot}); };
+        factors.h = [f, x_pivot, pivot](std::vector<double> point)
+        { return f({x_pivot, point[1]}) / pivot; };
+        return true;
+    }
+
+    bool verify(const function_type &f, const Factors &factors, size_t n, size_t first_row, size_t rows, double tol)
+    {
+        std::vector<double> gx, hy;
+        sample(factors, n, first_row, rows, 1.0, gx, hy);
+
+        const double h = 1.0 / (n - 1);
+        double largest = 0.0, error = 0.0;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                const double value = f({static_cast<double>(first_row + i) * h, static_cast<double>(j) * h});
+                largest = std::max(largest, std::abs(value));
+                error = std::max(error, std::abs(value - gx[i] * hy[j]));
+            }
+        }
+        return std::isfinite(largest) && error <= tol * largest;
+    }
+
+    void sample(const Factors &factors, size_t n, size_t first_row, size_t rows, double scale, std::vector<double> &gx, std::vector<double> &hy)
+    {
+        const double h = 1.0 / (n - 1);
+        gx.resize(rows);
+        hy.resize(n);
+        for (size_t i = 0; i < rows; ++i)
+            gx[i] = scale * factors.g({static_cast<double>(first_row + i) * h, 0.0});
+        for (size_t j = 0; j < n; ++j)
+            hy[j] = factors.h({0.0, static_cast<double>(j) * h});
+    }
+} // namespace solver::separable
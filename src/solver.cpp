@@ -9,12 +9,20 @@
 #include <vector>
 #include <cmath>
 #include <iomanip>
+#include <numeric>
+#include <tuple>
+#include <stdexcept>
+#include <limits>
 #include <omp.h>
 #include <mpi.h>
 
 #include <Eigen/Sparse>
+#include <Eigen/Dense>
 #include <Eigen/IterativeLinearSolvers>
 #include "solver.hpp"
+#include "kernels.hpp"
+#include "trace.hpp"
+#include "checkerboard.hpp"
 
 namespace solver
 {
@@ -24,6 +32,12 @@ namespace solver
 
     void Solver::solve_jacobi_serial()
     {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+        check_memory("jacobi_serial", n, MPI_COMM_NULL, 1);
+
         // Initialize h
         const double h = 1.0 / (n - 1);
 
@@ -36,31 +50,37 @@ namespace solver
             uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
         }
 
-        // Initialize the previous solution vector
-        std::vector<double> previous(n * n);
+        // Rolling buffers with the old values of the row above and of the current row
+        std::vector<double> above(n), current(n);
+
+        // Right-hand side of the Jacobi update, an outer product of two vectors if f is separable
+        std::vector<double> f_x, f_y;
+        const bool separable_f = rhs_factors(0, n, f_x, f_y);
+        auto rhs = [&](size_t i, size_t j)
+        { return separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, i, j); };
 
         // Initialize the converged variable
         bool converged = false;
 
+        // Writer of the progress of the solve (if any)
+        telemetry::Publisher *progress = start_telemetry("jacobi_serial", 0, 1);
+
         for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
         {
-            // Save the previous solution in a temporary vector
-            std::copy(uh.begin(), uh.end(), previous.begin());
+            // The first row is Dirichlet data, so it is also the old row above the first interior row
+            std::copy(uh.begin(), uh.begin() + n, above.begin());
 
-            // Perform the iteration
-            for (size_t i = 1; i < n - 1; ++i)
+            // Perform the iteration in place
+            double diff;
             {
-                for (size_t j = 1; j < n - 1; ++j)
-                {
-                    // Jacobi iteration
-                    uh[i * n + j] = 0.25 * (previous[(i - 1) * n + j] + previous[(i + 1) * n + j] +
-                                            previous[i * n + (j - 1)] + previous[i * n + (j + 1)] +
-                                            h * h * fun_at(f, i, j));
-                }
+                trace::Scope scope(trace::Phase::Sweep);
+                diff = kernels::jacobi_sweep_inplace(uh.data(), n, 1, n - 1, above, current, &uh[(n - 1) * n], rhs);
             }
 
             // Check for convergence
-            double residual = compute_error_serial(uh, previous, n, n);
+            double residual = std::sqrt(1.0 / (n - 1) * diff);
+            if (progress)
+                progress->publish(iteration + 1, residual);
             if (residual < tol)
             {
                 converged = true;
@@ -73,25 +93,24 @@ namespace solver
                 std::cout << "Warning from serial solver: Maximum number of iterations reached without convergence." << std::endl;
             }
         }
+
+        // Record the statistics of the solve
+        solver_stats.method = "jacobi_serial";
+        solver_stats.grid_pages = memory::page_info(uh.data());
         return;
     }
 
     void Solver::solve_jacobi_omp()
     {
-
-#ifndef _OPENMP
-        std::cout << "Warning from OpenMP solver: OpenMP is not enabled. Falling back to serial execution." << std::endl;
-#endif
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy, num_threads);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+        check_memory("jacobi_omp", n, MPI_COMM_NULL, num_threads);
 
         // Initialize h
         const double h = 1.0 / (n - 1);
 
-#ifdef _OPENMP
-        int num_threads = omp_get_num_threads();
-        int chunk_size = (n * n) / (num_threads); // ensures all elements are covered
-#pragma omp barrier
-#pragma omp parallel for schedule(static, chunk_size)
-#endif
         // Set the boundary conditions
         for (size_t i = 0; i < n; ++i)
         {
@@ -101,51 +120,55 @@ namespace solver
             uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
         }
 
-        // Initialize the previous solution vector
-        std::vector<double> previous(n * n);
+        // Right-hand side of the Jacobi update, an outer product of two vectors if f is separable
+        std::vector<double> f_x, f_y;
+        const bool separable_f = rhs_factors(0, n, f_x, f_y);
+        auto rhs = [&](size_t i, size_t j)
+        { return separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, i, j); };
 
         // Initialize converged variable
         bool converged = false;
 
-#ifdef _OPENMP
-#pragma omp parallel num_threads(2) shared(uh, previous, converged)
-#endif
+        // Partial sums of the squared updates, one per thread of the team (sized by thread 0)
+        std::vector<double> partial_diff;
+
+        // Writer of the progress of the solve (if any), fed by thread 0
+        telemetry::Publisher *progress = start_telemetry("jacobi_omp", 0, 1);
+
+        // Each thread updates a strip of interior rows in place
+        auto worker = [&](unsigned thread_id, unsigned team_size, const std::function<void()> &barrier)
         {
+            size_t first, last;
+            kernels::strip_bounds(1, n - 1, thread_id, team_size, first, last);
+
+            // Old values of the rows bordering the strip and rolling buffer
+            std::vector<double> above(n), below(n), current(n);
+
+            // The team may be smaller than num_threads, it is sized before the first barrier
+            if (thread_id == 0)
+                partial_diff.assign(team_size, 0.0);
 
             for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
             {
-#ifdef _OPENMP
-#pragma omp single
-#endif
-                {
-                    // Save the previous solution in a temporary vector
-                    std::copy(uh.begin(), uh.end(), previous.begin());
-                }
+                // Save the old rows bordering the strip before the neighbours overwrite them
+                std::copy(uh.begin() + (first - 1) * n, uh.begin() + first * n, above.begin());
+                std::copy(uh.begin() + last * n, uh.begin() + (last + 1) * n, below.begin());
+                barrier();
 
-#ifdef _OPENMP
-                int num_threads = omp_get_num_threads();
-                int chunk_size = (n * n) / (num_threads); // ensures all elements are covered
-#pragma omp barrier
-#pragma omp for collapse(2) schedule(static, chunk_size)
-#endif
                 // Perform the iteration
-                for (size_t i = 1; i < n - 1; ++i)
                 {
-                    for (size_t j = 1; j < n - 1; ++j)
-                    {
-                        // Jacobi iteration
-                        uh[i * n + j] = 0.25 * (previous[(i - 1) * n + j] + previous[(i + 1) * n + j] +
-                                                previous[i * n + (j - 1)] + previous[i * n + (j + 1)] +
-                                                h * h * fun_at(f, i, j));
-                    }
+                    trace::Scope scope(trace::Phase::Sweep);
+                    partial_diff[thread_id] = kernels::jacobi_sweep_inplace(uh.data(), n, first, last, above, current, below.data(), rhs);
                 }
-#ifdef _OPENMP
-#pragma omp barrier
-#pragma omp single
-#endif
+                barrier();
+
+                if (thread_id == 0)
                 {
                     // Check for convergence
-                    double residual = compute_error_serial(uh, previous, n, n);
+                    double diff = std::accumulate(partial_diff.begin(), partial_diff.end(), 0.0);
+                    double residual = std::sqrt(1.0 / (n - 1) * diff);
+                    if (progress)
+                        progress->publish(iteration + 1, residual);
                     if (residual < tol)
                     {
                         converged = true;
@@ -158,21 +181,127 @@ namespace solver
                         std::cout << "Warning from OpenMP solver: Maximum number of iterations reached without convergence." << std::endl;
                     }
                 }
+                barrier();
             }
+        };
+        run_parallel(worker);
+
+        // Record the statistics of the solve
+        solver_stats.method = "jacobi_omp";
+        solver_stats.grid_pages = memory::page_info(uh.data());
+        return;
+    }
+
+    void Solver::solve_gauss_seidel_rb()
+    {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy, num_threads);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+        check_memory("gauss_seidel_rb", n, MPI_COMM_NULL, num_threads);
+
+        // Initialize h
+        const double h = 1.0 / (n - 1);
+
+        // Set the boundary conditions
+        for (size_t i = 0; i < n; ++i)
+        {
+            uh[i] = fun_at(top_bc, 0, i);                      // Top boundary
+            uh[i * n + (n - 1)] = fun_at(right_bc, i, n - 1);  // Right boundary
+            uh[(n - 1) * n + i] = fun_at(bottom_bc, n - 1, i); // Bottom boundary
+            uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
+        }
+
+        // The grid and h^2 f are split by colour for the sweeps, the grid is merged back at the end
+        checkerboard::Grid u(n), rhs(n);
+        {
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(0, n, f_x, f_y);
+            std::vector<double> rhs_grid(n * n);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    rhs_grid[i * n + j] = separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, i, j);
+            rhs.split(rhs_grid.data());
         }
+        u.split(uh.data());
+
+        // Initialize converged variable
+        bool converged = false;
+
+        // Partial sums of the squared updates, one per thread of the team (sized by thread 0)
+        std::vector<double> partial_diff;
+
+        // Writer of the progress of the solve (if any), fed by thread 0
+        telemetry::Publisher *progress = start_telemetry("gauss_seidel_rb", 0, 1);
+
+        // Each thread updates the points of a colour on a strip of interior rows, the red ones first
+        auto worker = [&](unsigned thread_id, unsigned team_size, const std::function<void()> &barrier)
+        {
+            size_t first, last;
+            kernels::strip_bounds(1, n - 1, thread_id, team_size, first, last);
+            if (thread_id == 0)
+                partial_diff.assign(team_size, 0.0);
+            barrier();
+
+            for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
+            {
+                // Perform the iteration: the black points read the red ones of the neighbouring strips
+                double diff;
+                {
+                    trace::Scope scope(trace::Phase::Sweep);
+                    diff = checkerboard::sweep(u, rhs, checkerboard::Colour::Red, first, last);
+                }
+                barrier();
+                {
+                    trace::Scope scope(trace::Phase::Sweep);
+                    diff += checkerboard::sweep(u, rhs, checkerboard::Colour::Black, first, last);
+                }
+                partial_diff[thread_id] = diff;
+                barrier();
+
+                if (thread_id == 0)
+                {
+                    // Check for convergence
+                    double residual = std::sqrt(1.0 / (n - 1) * std::accumulate(partial_diff.begin(), partial_diff.end(), 0.0));
+                    if (progress)
+                        progress->publish(iteration + 1, residual);
+                    if (residual < tol)
+                    {
+                        converged = true;
+                        iter = ++iteration;
+                    }
+                    else if (iteration == max_iter - 1)
+                    {
+                        iter = ++iteration;
+                        std::cout << "Warning from red-black Gauss-Seidel solver: Maximum number of iterations reached without convergence." << std::endl;
+                    }
+                }
+                barrier();
+            }
+        };
+        run_parallel(worker);
+        u.merge(uh.data());
 
+        // Record the statistics of the solve
+        solver_stats.method = "gauss_seidel_rb";
+        solver_stats.grid_pages = memory::page_info(u.data(checkerboard::Colour::Red));
         return;
     }
 
     void Solver::solve_jacobi_mpi()
     {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+
         int initialized;
         MPI_Initialized(&initialized);
 
         if (initialized)
         {
-            // We use MPI_COMM_WORLD ad communicator
-            MPI_Comm mpi_comm = MPI_COMM_WORLD;
+            // Communicator among which the grid is distributed (MPI_COMM_WORLD by default)
+            MPI_Comm mpi_comm = comm;
 
             // Get size and rank
             int mpi_rank, mpi_size;
@@ -191,116 +320,82 @@ namespace solver
                 }
             }
 
-            // Compute these two quantities to divide the work among processes
-            unsigned int count = n / mpi_size;
-            int remainder = n - count * mpi_size;
-
-            // Vector to store the number of elements to send to each processor,
-            // and to store the number of elements to receive from each processor.
-            std::vector<int> counts(mpi_size, 0);
-
-            // Vector to store the offset index where to start reading/writing them from.
-            std::vector<int> start_idxs(mpi_size, 0);
-
-            // Auxiliary index
-            unsigned start_idx{0};
-
-            if (mpi_rank == 0)
-            {
-                if (mpi_size > 1)
-                {
-                    // The first and last processors will have only one extra row,
-                    // while the others will have two ghost rows.
-
-                    counts[0] = ((0 < remainder) ? (count + 1 + 1) : count + 1) * n;
-                    start_idxs[0] = 0;
-                    start_idx = counts[0] - 2 * n;
-
-                    for (int i = 1; i < mpi_size - 1; ++i)
-                    {
-                        counts[i] = ((i < remainder) ? (count + 1 + 2) : count + 2) * n;
-                        start_idxs[i] = start_idx;
-                        start_idx += counts[i] - 2 * n; // consider repetition of ghost row
-                    }
-                    counts[mpi_size - 1] = ((mpi_size - 1 < remainder) ? (count + 1 + 1) : count + 1) * n;
-                    start_idxs[mpi_size - 1] = start_idx;
-                }
-                else
-                {
-                    // We handle the case with only one process separately
-                    counts[0] = n * n; // Only one process, all data
-                    start_idxs[0] = 0;
-                }
-            }
+            // Divide the rows of the grid among the processes
+            std::vector<int> counts, start_idxs;
+            decompose(mpi_size, counts, start_idxs);
 
-            // Compute the number of rows of the local grid
-            unsigned int local_rows;
-            if (mpi_size > 1)
-            {
-                local_rows = (mpi_rank < remainder) ? (count + 1) : count;
-                local_rows += (mpi_rank == 0 || mpi_rank == mpi_size - 1) ? 1 : 2; // Add ghost rows
-            }
-            else
-            {
-                local_rows = n; // Only one process, all rows
-            }
+            // Reduction of the residual, built on the first solve on this communicator (collective)
+            const reduction::Allreduce &allreducer = reducer();
 
-            // Broadcast start_idxs because the y will be used during computation
-            MPI_Bcast(start_idxs.data(), mpi_size, MPI_INT, 0, mpi_comm);
+            // Number of rows of the local grid, ghost rows included
+            unsigned int local_rows = counts[mpi_rank] / n;
 
-            // Synchronize all processes
-            MPI_Barrier(mpi_comm);
+            // Memory of the solve on this rank (warns if the node would run out of it, collective)
+            check_memory("jacobi_mpi", local_rows, mpi_comm, 1);
 
             // Declare the local grid
-            std::vector<double> local_uh(local_rows * n);
+            grid_type local_uh(local_rows * n);
 
             // Scatter the initial guess between processes
-            MPI_Scatterv(uh.data(),
-                         counts.data(),
-                         start_idxs.data(),
-                         MPI_DOUBLE,
-                         local_uh.data(),
-                         local_rows * n,
-                         MPI_DOUBLE,
-                         0,
-                         mpi_comm);
+            {
+                trace::Scope scope(trace::Phase::Scatter);
+                MPI_Scatterv(uh.data(),
+                             counts.data(),
+                             start_idxs.data(),
+                             MPI_DOUBLE,
+                             local_uh.data(),
+                             local_rows * n,
+                             MPI_DOUBLE,
+                             0,
+                             mpi_comm);
+            }
 
-            // Grid that will containt the solution at the previous iteration
-            std::vector<double> local_previous(local_rows * n);
+            // Rolling buffers with the old values of the row above and of the current row
+            std::vector<double> above(n), current(n);
 
             // Define converged variable
             bool converged = false;
 
+            // Writer of the progress of the solve (if any, on rank 0)
+            telemetry::Publisher *progress = start_telemetry("jacobi_mpi", mpi_rank, mpi_size);
+
             // Define h
             const double h = 1.0 / (n - 1);
 
+            // Right-hand side of the Jacobi update (local row i is global row start_idxs[mpi_rank] / n + i),
+            // an outer product of two vectors if f is separable
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(start_idxs[mpi_rank] / n, local_rows, f_x, f_y, mpi_comm);
+            auto rhs = [&](size_t i, size_t j)
+            { return separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, start_idxs[mpi_rank] / n + i, j); };
+
             for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
             {
-                // Save the previous solution for convergence check
-                std::copy(local_uh.begin(), local_uh.end(), local_previous.begin());
+                // Ghost (or boundary) rows are not updated by the sweep
+                std::copy(local_uh.begin(), local_uh.begin() + n, above.begin());
 
-                // Perform the iteration
-                for (size_t i = 1; i < local_rows - 1; ++i)
+                // Perform the iteration in place
+                double diff;
                 {
-                    for (size_t j = 1; j < n - 1; ++j)
-                    {
-                        // Jacobi iteration
-                        local_uh[i * n + j] = 0.25 * (local_previous[(i - 1) * n + j] + local_previous[(i + 1) * n + j] +
-                                                      local_previous[i * n + (j - 1)] + local_previous[i * n + (j + 1)] +
-                                                      h * h * fun_at(f, start_idxs[mpi_rank] / n + i, j));
-                    }
+                    trace::Scope scope(trace::Phase::Sweep);
+                    diff = kernels::jacobi_sweep_inplace(local_uh.data(), n, 1, local_rows - 1, above, current,
+                                                         &local_uh[(local_rows - 1) * n], rhs);
                 }
 
                 // Check for convergence
                 // Compute the local residual
-                double local_residual = compute_error_serial(local_uh, local_previous, local_rows, n);
+                double local_residual = std::sqrt(1.0 / (n - 1) * diff);
                 double global_residual;
-                // Ensure all processes have computed their local residual before reduction
-                MPI_Barrier(mpi_comm);
-                // Find the maximum residual across all processes
-                MPI_Allreduce(&local_residual, &global_residual, 1, MPI_DOUBLE, MPI_MAX, mpi_comm);
+                {
+                    trace::Scope scope(trace::Phase::Reduction);
+                    // Find the maximum residual across all processes (the reduction synchronizes them)
+                    global_residual = local_residual;
+                    allreducer.reduce(&global_residual, 1, MPI_MAX);
+                }
                 // The method converged if all local residual satisfy the convergence criterion
                 converged = (global_residual < tol);
+                if (progress)
+                    progress->publish(iteration + 1, global_residual);
                 if (converged)
                 {
                     iter = ++iteration;
@@ -315,6 +410,8 @@ namespace solver
                 // Bidirectional ghost cell exchange
                 if (mpi_size > 1)
                 {
+                    trace::Scope scope(trace::Phase::Exchange);
+
                     // Send/receive with next rank
                     if (mpi_rank < mpi_size - 1)
                     {
@@ -333,21 +430,34 @@ namespace solver
                         MPI_Recv(&local_uh[0], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, MPI_STATUS_IGNORE);
                     }
                 }
+
+                // In-situ heatmap of the iterate, whose ghost rows are now up to date
+                if (!converged && !monitor_name.empty() && monitor_every > 0 && (iteration + 1) % monitor_every == 0)
+                    monitor(local_uh.data(), start_idxs, local_rows, std::to_string(iteration + 1));
             }
+            if (!monitor_name.empty())
+                monitor(local_uh.data(), start_idxs, local_rows, "final");
 
-            // Synchronize all processes before gathering results
-            MPI_Barrier(mpi_comm);
+            // Record the statistics of the solve
+            solver_stats.method = "jacobi_mpi";
+            solver_stats.grid_pages = memory::page_info(local_uh.data());
+
+            {
+                trace::Scope scope(trace::Phase::Gather);
+                // Synchronize all processes before gathering results
+                MPI_Barrier(mpi_comm);
 
-            // Gather the results from local grids in uh (global grid)
-            MPI_Gatherv(local_uh.data(),
-                        local_rows * n,
-                        MPI_DOUBLE,
-                        uh.data(),
-                        counts.data(),
-                        start_idxs.data(),
-                        MPI_DOUBLE,
-                        0,
-                        mpi_comm);
+                // Gather the results from local grids in uh (global grid)
+                MPI_Gatherv(local_uh.data(),
+                            local_rows * n,
+                            MPI_DOUBLE,
+                            uh.data(),
+                            counts.data(),
+                            start_idxs.data(),
+                            MPI_DOUBLE,
+                            0,
+                            mpi_comm);
+            }
         }
         else
         {
@@ -358,17 +468,18 @@ namespace solver
 
     void Solver::solve_jacobi_hybrid()
     {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy, num_threads);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
 
-#ifndef _OPENMP
-        std::cout << "Warning from Hybrid solver: OpenMP is not enabled. Falling back to serial execution." << std::endl;
-#endif
         int initialized;
         MPI_Initialized(&initialized);
 
         if (initialized)
         {
-            // We use MPI_COMM_WORLD ad communicator
-            MPI_Comm mpi_comm = MPI_COMM_WORLD;
+            // Communicator among which the grid is distributed (MPI_COMM_WORLD by default)
+            MPI_Comm mpi_comm = comm;
 
             // Get size and rank
             int mpi_rank, mpi_size;
@@ -387,182 +498,156 @@ namespace solver
                 }
             }
 
-            // Compute these two quantities to divide the work among processes
-            unsigned int count = n / mpi_size;
-            int remainder = n - count * mpi_size;
-
-            // Vector to store the number of elements to send to each processor,
-            // and to store the number of elements to receive from each processor.
-            std::vector<int> counts(mpi_size, 0);
-
-            // Vector to store the offset index where to start reading/writing them from.
-            std::vector<int> start_idxs(mpi_size, 0);
+            // Divide the rows of the grid among the processes
+            std::vector<int> counts, start_idxs;
+            decompose(mpi_size, counts, start_idxs);
 
-            // Auxiliary index
-            unsigned start_idx{0};
-
-            if (mpi_rank == 0)
-            {
-                if (mpi_size > 1)
-                {
-                    // The first and last processors will have only one extra row,
-                    // while the others will have two ghost rows.
-
-                    counts[0] = ((0 < remainder) ? (count + 1 + 1) : count + 1) * n;
-                    start_idxs[0] = 0;
-                    start_idx = counts[0] - 2 * n;
-
-                    for (int i = 1; i < mpi_size - 1; ++i)
-                    {
-                        counts[i] = ((i < remainder) ? (count + 1 + 2) : count + 2) * n;
-                        start_idxs[i] = start_idx;
-                        start_idx += counts[i] - 2 * n; // consider repetition of ghost row
-                    }
-                    counts[mpi_size - 1] = ((mpi_size - 1 < remainder) ? (count + 1 + 1) : count + 1) * n;
-                    start_idxs[mpi_size - 1] = start_idx;
-                }
-                else
-                {
-                    // We handle the case with only one process separately
-                    counts[0] = n * n; // Only one process, all data
-                    start_idxs[0] = 0;
-                }
-            }
-
-            // Compute the number of rows of the local grid
-            unsigned int local_rows;
-            if (mpi_size > 1)
-            {
-                local_rows = (mpi_rank < remainder) ? (count + 1) : count;
-                local_rows += (mpi_rank == 0 || mpi_rank == mpi_size - 1) ? 1 : 2; // Add ghost rows
-            }
-            else
-            {
-                local_rows = n; // Only one process, all rows
-            }
+            // Reduction of the residual, built on the first solve on this communicator (collective)
+            const reduction::Allreduce &allreducer = reducer();
 
-            // Broadcast start_idxs because the y will be used during computation
-            MPI_Bcast(start_idxs.data(), mpi_size, MPI_INT, 0, mpi_comm);
+            // Number of rows of the local grid, ghost rows included
+            unsigned int local_rows = counts[mpi_rank] / n;
 
-            // Synchronize all processes
-            MPI_Barrier(mpi_comm);
+            // Memory of the solve on this rank (warns if the node would run out of it, collective)
+            check_memory("jacobi_hybrid", local_rows, mpi_comm, num_threads);
 
             // Declare the local grid
-            std::vector<double> local_uh(local_rows * n);
+            grid_type local_uh(local_rows * n);
 
             // Scatter the initial guess between processes
-            MPI_Scatterv(uh.data(),
-                         counts.data(),
-                         start_idxs.data(),
-                         MPI_DOUBLE,
-                         local_uh.data(),
-                         local_rows * n,
-                         MPI_DOUBLE,
-                         0,
-                         mpi_comm);
-
-            // Grid that will containt the solution at the previous iteration
-            std::vector<double> local_previous(local_rows * n);
+            {
+                trace::Scope scope(trace::Phase::Scatter);
+                MPI_Scatterv(uh.data(),
+                             counts.data(),
+                             start_idxs.data(),
+                             MPI_DOUBLE,
+                             local_uh.data(),
+                             local_rows * n,
+                             MPI_DOUBLE,
+                             0,
+                             mpi_comm);
+            }
 
             // Define converged variable
             bool converged = false;
 
+            // Writer of the progress of the solve (if any, on rank 0), fed by thread 0
+            telemetry::Publisher *progress = start_telemetry("jacobi_hybrid", mpi_rank, mpi_size);
+
+            // Partial sums of the squared updates, one per thread
+            std::vector<double> partial_diff(num_threads, 0.0);
+
             // Define h
             const double h = 1.0 / (n - 1);
 
-#ifdef _OPENMP
-#pragma omp parallel num_threads(2) shared(local_uh, local_previous, converged)
-#endif
+            // Right-hand side of the Jacobi update (local row i is global row start_idxs[mpi_rank] / n + i),
+            // an outer product of two vectors if f is separable
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(start_idxs[mpi_rank] / n, local_rows, f_x, f_y, mpi_comm);
+            auto rhs = [&](size_t i, size_t j)
+            { return separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, start_idxs[mpi_rank] / n + i, j); };
 
-            for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
+            // Each thread updates a strip of the local interior rows in place,
+            // thread 0 also takes care of the communication
+            auto worker = [&](unsigned thread_id, unsigned team_size, const std::function<void()> &barrier)
             {
-#ifdef _OPENMP
-#pragma omp single
-#endif
-                {
-                    // Save the previous solution for convergence check
-                    std::copy(local_uh.begin(), local_uh.end(), local_previous.begin());
-                }
-#ifdef _OPENMP
-                int num_threads = omp_get_num_threads();
-                int chunk_size = (local_rows * n) / (num_threads); // ensures all elements are covered
-#pragma omp barrier
-#pragma omp for collapse(2) schedule(static, chunk_size)
-#endif
-                // Perform the iteration
-                for (size_t i = 1; i < local_rows - 1; ++i)
-                {
-                    for (size_t j = 1; j < n - 1; ++j)
-                    {
-                        // Jacobi iteration
-                        local_uh[i * n + j] = 0.25 * (local_previous[(i - 1) * n + j] + local_previous[(i + 1) * n + j] +
-                                                      local_previous[i * n + (j - 1)] + local_previous[i * n + (j + 1)] +
-                                                      h * h * fun_at(f, start_idxs[mpi_rank] / n + i, j));
-                    }
-                }
-#ifdef _OPENMP
-#pragma omp barrier
-#pragma omp single
-#endif
+                size_t first, last;
+                kernels::strip_bounds(1, local_rows - 1, thread_id, team_size, first, last);
+
+                // Old values of the rows bordering the strip and rolling buffer
+                std::vector<double> above(n), below(n), current(n);
+
+                for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
                 {
-                    // Check for convergence
-                    // Compute the local residual
-                    double local_residual = compute_error_serial(local_uh, local_previous, local_rows, n);
-                    double global_residual;
-                    // Ensure all processes have computed their local residual before reduction
-                    MPI_Barrier(mpi_comm);
-                    // Find the maximum residual across all processes
-                    MPI_Allreduce(&local_residual, &global_residual, 1, MPI_DOUBLE, MPI_MAX, mpi_comm);
-                    // The method converged if all local residual satisfy the convergence criterion
-                    converged = (global_residual < tol);
-                    if (converged)
-                    {
-                        iter = ++iteration;
-                    }
-                    else if (iteration == max_iter - 1)
+                    // Save the old rows bordering the strip before the neighbours overwrite them
+                    std::copy(local_uh.begin() + (first - 1) * n, local_uh.begin() + first * n, above.begin());
+                    std::copy(local_uh.begin() + last * n, local_uh.begin() + (last + 1) * n, below.begin());
+                    barrier();
+
+                    // Perform the iteration
                     {
-                        iter = ++iteration;
-                        if (mpi_rank == 0)
-                            std::cout << "Warning from Hybrid solver: Maximum number of iterations reached without convergence." << std::endl;
+                        trace::Scope scope(trace::Phase::Sweep);
+                        partial_diff[thread_id] = kernels::jacobi_sweep_inplace(local_uh.data(), n, first, last, above, current, below.data(), rhs);
                     }
+                    barrier();
 
-                    // Bidirectional ghost cell exchange
-                    if (mpi_size > 1)
+                    if (thread_id == 0)
                     {
-                        // Send/receive with next rank
-                        if (mpi_rank < mpi_size - 1)
+                        // Check for convergence
+                        // Compute the local residual
+                        double diff = std::accumulate(partial_diff.begin(), partial_diff.begin() + team_size, 0.0);
+                        double local_residual = std::sqrt(1.0 / (n - 1) * diff);
+                        double global_residual;
+                        {
+                            trace::Scope scope(trace::Phase::Reduction);
+                            // Find the maximum residual across all processes (the reduction synchronizes them)
+                            global_residual = local_residual;
+                            allreducer.reduce(&global_residual, 1, MPI_MAX);
+                        }
+                        // The method converged if all local residual satisfy the convergence criterion
+                        converged = (global_residual < tol);
+                        if (progress)
+                            progress->publish(iteration + 1, global_residual);
+                        if (converged)
+                        {
+                            iter = ++iteration;
+                        }
+                        else if (iteration == max_iter - 1)
                         {
-                            // Send my last interior row to next rank's ghost row
-                            MPI_Send(&local_uh[(local_rows - 2) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm);
-                            // Receive next rank's first interior row into my ghost row
-                            MPI_Recv(&local_uh[(local_rows - 1) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                            iter = ++iteration;
+                            if (mpi_rank == 0)
+                                std::cout << "Warning from Hybrid solver: Maximum number of iterations reached without convergence." << std::endl;
                         }
 
-                        // Send/receive with previous rank
-                        if (mpi_rank > 0)
+                        // Bidirectional ghost cell exchange
+                        if (mpi_size > 1)
                         {
-                            // Send my first interior row to previous rank's ghost row
-                            MPI_Send(&local_uh[1 * n], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm);
-                            // Receive previous rank's last interior row into my ghost row
-                            MPI_Recv(&local_uh[0], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                            trace::Scope scope(trace::Phase::Exchange);
+
+                            // Send/receive with next rank
+                            if (mpi_rank < mpi_size - 1)
+                            {
+                                // Send my last interior row to next rank's ghost row
+                                MPI_Send(&local_uh[(local_rows - 2) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm);
+                                // Receive next rank's first interior row into my ghost row
+                                MPI_Recv(&local_uh[(local_rows - 1) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                            }
+
+                            // Send/receive with previous rank
+                            if (mpi_rank > 0)
+                            {
+                                // Send my first interior row to previous rank's ghost row
+                                MPI_Send(&local_uh[1 * n], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm);
+                                // Receive previous rank's last interior row into my ghost row
+                                MPI_Recv(&local_uh[0], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                            }
                         }
                     }
+                    barrier();
                 }
-            }
+            };
+            run_parallel(worker);
 
-            // Synchronize all processes before gathering results
-            MPI_Barrier(mpi_comm);
+            // Record the statistics of the solve
+            solver_stats.method = "jacobi_hybrid";
+            solver_stats.grid_pages = memory::page_info(local_uh.data());
+
+            {
+                trace::Scope scope(trace::Phase::Gather);
+                // Synchronize all processes before gathering results
+                MPI_Barrier(mpi_comm);
 
-            // Gather the results from local grids in uh (global grid)
-            MPI_Gatherv(local_uh.data(),
-                        local_rows * n,
-                        MPI_DOUBLE,
-                        uh.data(),
-                        counts.data(),
-                        start_idxs.data(),
-                        MPI_DOUBLE,
-                        0,
-                        mpi_comm);
+                // Gather the results from local grids in uh (global grid)
+                MPI_Gatherv(local_uh.data(),
+                            local_rows * n,
+                            MPI_DOUBLE,
+                            uh.data(),
+                            counts.data(),
+                            start_idxs.data(),
+                            MPI_DOUBLE,
+                            0,
+                            mpi_comm);
+            }
         }
         else
         {
@@ -571,21 +656,32 @@ namespace solver
         }
     }
 
-    void Solver::solve_direct_mpi()
+    void Solver::solve_jacobi_hybrid_tasks()
     {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy, num_threads);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+
         int initialized;
         MPI_Initialized(&initialized);
 
         if (initialized)
         {
-            // We use MPI_COMM_WORLD ad communicator
-            MPI_Comm mpi_comm = MPI_COMM_WORLD;
+            // Communicator among which the grid is distributed (MPI_COMM_WORLD by default)
+            MPI_Comm mpi_comm = comm;
 
             // Get size and rank
             int mpi_rank, mpi_size;
             MPI_Comm_rank(mpi_comm, &mpi_rank);
             MPI_Comm_size(mpi_comm, &mpi_size);
 
+            // With MPI_THREAD_SERIALIZED the halo exchange can be completed by any thread,
+            // otherwise only the master thread can wait for it
+            int thread_level;
+            MPI_Query_thread(&thread_level);
+            const bool serialized = (thread_level >= MPI_THREAD_SERIALIZED);
+
             // Set the boundary conditions
             if (mpi_rank == 0)
             {
@@ -598,125 +694,362 @@ namespace solver
                 }
             }
 
-            // Compute these two quantities to divide the work among processes
-            unsigned int count = n / mpi_size;
-            int remainder = n - count * mpi_size;
+            // Divide the rows of the grid among the processes
+            std::vector<int> counts, start_idxs;
+            decompose(mpi_size, counts, start_idxs);
 
-            // Vector to store the number of elements to send to each processor,
-            // and to store the number of elements to receive from each processor.
-            std::vector<int> counts(mpi_size, 0);
+            // Reduction of the residual, built on the first solve on this communicator (collective)
+            const reduction::Allreduce &allreducer = reducer();
 
-            // Vector to store the offset index where to start reading/writing them from.
-            std::vector<int> start_idxs(mpi_size, 0);
+            // Number of rows of the local grid, ghost rows included
+            unsigned int local_rows = counts[mpi_rank] / n;
 
-            // Auxiliary index
-            unsigned start_idx{0};
+            // Declare the local grid
+            grid_type local_uh(local_rows * n);
 
-            if (mpi_rank == 0)
+            // Scatter the initial guess between processes
             {
-                if (mpi_size > 1)
-                {
-                    // The first and last processors will have only one extra row,
-                    // while the others will have two ghost rows.
-
-                    counts[0] = ((0 < remainder) ? (count + 1 + 1) : count + 1) * n;
-                    start_idxs[0] = 0;
-                    start_idx = counts[0] - 2 * n;
-
-                    for (int i = 1; i < mpi_size - 1; ++i)
-                    {
-                        counts[i] = ((i < remainder) ? (count + 1 + 2) : count + 2) * n;
-                        start_idxs[i] = start_idx;
-                        start_idx += counts[i] - 2 * n; // consider repetition of ghost row
-                    }
-                    counts[mpi_size - 1] = ((mpi_size - 1 < remainder) ? (count + 1 + 1) : count + 1) * n;
-                    start_idxs[mpi_size - 1] = start_idx;
-                }
-                else
-                {
-                    // We handle the case with only one process separately
-                    counts[0] = n * n; // Only one process, all data
-                    start_idxs[0] = 0;
-                }
+                trace::Scope scope(trace::Phase::Scatter);
+                MPI_Scatterv(uh.data(),
+                             counts.data(),
+                             start_idxs.data(),
+                             MPI_DOUBLE,
+                             local_uh.data(),
+                             local_rows * n,
+                             MPI_DOUBLE,
+                             0,
+                             mpi_comm);
             }
 
-            // Compute the number of rows of the local grid
-            unsigned int local_rows;
-            if (mpi_size > 1)
-            {
-                local_rows = (mpi_rank < remainder) ? (count + 1) : count;
-                local_rows += (mpi_rank == 0 || mpi_rank == mpi_size - 1) ? 1 : 2; // Add ghost rows
-            }
-            else
-            {
-                local_rows = n; // Only one process, all rows
-            }
+            // Ghost rows exchanged with the neighbours (the others are Dirichlet data)
+            const bool has_prev = (mpi_rank > 0);
+            const bool has_next = (mpi_rank < mpi_size - 1);
 
-            // Broadcast start_idxs because the y will be used during computation
-            MPI_Bcast(start_idxs.data(), mpi_size, MPI_INT, 0, mpi_comm);
+            // Split the local interior rows into tiles of about tile_rows rows, or by default into four
+            // tiles per thread, so that the tiles away from the ghost rows overlap the exchange
+            const size_t interior = local_rows - 2;
+            const size_t num_tiles = (tile_rows > 0) ? std::max<size_t>(1, interior / tile_rows)
+                                                     : std::max<size_t>(1, std::min<size_t>(4 * num_threads, interior));
 
-            // Synchronize all processes
-            MPI_Barrier(mpi_comm);
+            // Memory of the solve on this rank, with the rows of every tile (collective)
+            check_memory("jacobi_hybrid_tasks", local_rows, mpi_comm, num_tiles);
+            std::vector<size_t> tile_first(num_tiles), tile_last(num_tiles);
+            for (size_t t = 0; t < num_tiles; ++t)
+                kernels::strip_bounds(1, local_rows - 1, t, num_tiles, tile_first[t], tile_last[t]);
 
-            // Declare the local grid
-            std::vector<double> local_uh(local_rows * n);
+            // Old values of the rows bordering each tile and rolling buffers
+            std::vector<std::vector<double>> above(num_tiles, std::vector<double>(n));
+            std::vector<std::vector<double>> below(num_tiles, std::vector<double>(n));
+            std::vector<std::vector<double>> current(num_tiles, std::vector<double>(n));
 
-            // Scatter the initial guess between processes
-            MPI_Scatterv(uh.data(),
-                         counts.data(),
-                         start_idxs.data(),
-                         MPI_DOUBLE,
-                         local_uh.data(),
-                         local_rows * n,
-                         MPI_DOUBLE,
-                         0,
-                         mpi_comm);
+            // Partial sums of the squared updates, one per tile
+            std::vector<double> partial_diff(num_tiles, 0.0);
 
-            // Grid that will containt the solution at the previous iteration
-            std::vector<double> local_previous(local_rows * n);
+            // Copies of the first and last interior rows sent to the neighbours
+            std::vector<double> send_top(n), send_bottom(n);
+
+            // Ghost (or boundary) rows, also used as dependence objects of the tasks
+            double *top_ghost = &local_uh[0];
+            double *bottom_ghost = &local_uh[(local_rows - 1) * n];
 
             // Define converged variable
             bool converged = false;
 
+            // Writer of the progress of the solve (if any, on rank 0)
+            telemetry::Publisher *progress = start_telemetry("jacobi_hybrid_tasks", mpi_rank, mpi_size);
+
             // Define h
             const double h = 1.0 / (n - 1);
 
-            for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
-            {
-                // Save the previous solution for convergence check
-                std::copy(local_uh.begin(), local_uh.end(), local_previous.begin());
+            // Right-hand side of the Jacobi update (local row i is global row start_idxs[mpi_rank] / n + i),
+            // an outer product of two vectors if f is separable
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(start_idxs[mpi_rank] / n, local_rows, f_x, f_y, mpi_comm);
+            auto rhs = [&](size_t i, size_t j)
+            { return separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, start_idxs[mpi_rank] / n + i, j); };
 
-                // Assemble local system
-                unsigned working_rows = local_rows - 2; // in each case, top and bottom rows are given
-                unsigned working_cols = n - 2;          // in each case, left and right columns are given
-                // Unknowns are in the interior of the grid, so we have working_rows * working_cols unknowns
-                SparseMatrix<double> A(working_rows * working_cols, working_rows * working_cols);
-                std::vector<Triplet<double>> triplets; // to insert elements in sparse matrix
-                VectorXd b = VectorXd::Zero(working_rows * working_cols);
+            // Update tile t in place; tiles touching a ghost row read it only after it has arrived
+            auto sweep_tile = [&](size_t t)
+            {
+                trace::Scope scope(trace::Phase::Sweep);
+                if (tile_first[t] == 1)
+                    std::copy(top_ghost, top_ghost + n, above[t].begin());
+                const double *next = (tile_last[t] == local_rows - 1) ? bottom_ghost : below[t].data();
+                partial_diff[t] = kernels::jacobi_sweep_inplace(local_uh.data(), n, tile_first[t], tile_last[t], above[t], current[t], next, rhs);
+            };
+
+            // Tiles that need the ghost row above or below
+            auto needs_top = [&](size_t t)
+            { return has_prev && tile_first[t] == 1; };
+            auto needs_bottom = [&](size_t t)
+            { return has_next && tile_last[t] == local_rows - 1; };
 
-                for (size_t i = 0; i < working_rows; ++i)
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads)
+#pragma omp master
+#endif
+            {
+                for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
                 {
-                    for (size_t j = 0; j < working_cols; ++j)
+                    // Save the old rows bordering the interior tiles before any tile overwrites them
+                    for (size_t t = 0; t < num_tiles; ++t)
                     {
-                        int idx = i * working_cols + j;
-                        triplets.emplace_back(idx, idx, 4.0);
-                        if (i > 0)
-                        { // Use top neighbor
-                            triplets.emplace_back(idx, idx - working_cols, -1.0);
-                        }
-                        else
-                        {
-                            // If we are at the first local row, use upper ghost row
-                            b(idx) += local_uh[j];
-                        }
-                        if (i < working_rows - 1)
-                        { // Use bottom neighbor
+                        if (tile_first[t] > 1)
+                            std::copy(local_uh.begin() + (tile_first[t] - 1) * n, local_uh.begin() + tile_first[t] * n, above[t].begin());
+                        if (tile_last[t] < local_rows - 1)
+                            std::copy(local_uh.begin() + tile_last[t] * n, local_uh.begin() + (tile_last[t] + 1) * n, below[t].begin());
+                    }
+
+                    // Post the halo exchange of the values of the previous iteration
+                    MPI_Request requests[4];
+                    int num_requests = 0;
+                    if (has_next)
+                    {
+                        std::copy(local_uh.begin() + (local_rows - 2) * n, local_uh.begin() + (local_rows - 1) * n, send_bottom.begin());
+                        MPI_Irecv(bottom_ghost, n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, &requests[num_requests++]);
+                        MPI_Isend(send_bottom.data(), n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, &requests[num_requests++]);
+                    }
+                    if (has_prev)
+                    {
+                        std::copy(local_uh.begin() + n, local_uh.begin() + 2 * n, send_top.begin());
+                        MPI_Irecv(top_ghost, n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, &requests[num_requests++]);
+                        MPI_Isend(send_top.data(), n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, &requests[num_requests++]);
+                    }
+
+                    // With MPI_THREAD_SERIALIZED the exchange is completed by a task, which
+                    // releases the tiles touching the ghost rows as soon as they have arrived
+                    if (serialized)
+                    {
+#ifdef _OPENMP
+#pragma omp task default(shared) depend(out : top_ghost[0], bottom_ghost[0])
+#endif
+                        {
+                            trace::Scope scope(trace::Phase::Exchange);
+                            MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+                        }
+                    }
+
+                    // Tiles that do not depend on the ghost rows start immediately
+                    for (size_t t = 0; t < num_tiles; ++t)
+                    {
+                        if (!needs_top(t) && !needs_bottom(t))
+                        {
+#ifdef _OPENMP
+#pragma omp task default(shared) firstprivate(t)
+#endif
+                            sweep_tile(t);
+                        }
+                    }
+
+                    // Otherwise the master waits for the exchange while the other threads compute
+                    if (!serialized)
+                    {
+                        trace::Scope scope(trace::Phase::Exchange);
+                        MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+                    }
+
+                    for (size_t t = 0; t < num_tiles; ++t)
+                    {
+                        if (needs_top(t) || needs_bottom(t))
+                        {
+#ifdef _OPENMP
+#pragma omp task default(shared) firstprivate(t) depend(in : top_ghost[0], bottom_ghost[0])
+#endif
+                            sweep_tile(t);
+                        }
+                    }
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+
+                    // Check for convergence
+                    // Compute the local residual
+                    double diff = std::accumulate(partial_diff.begin(), partial_diff.end(), 0.0);
+                    double local_residual = std::sqrt(1.0 / (n - 1) * diff);
+                    double global_residual;
+                    {
+                        trace::Scope scope(trace::Phase::Reduction);
+                        // Find the maximum residual across all processes
+                        global_residual = local_residual;
+                        allreducer.reduce(&global_residual, 1, MPI_MAX);
+                    }
+                    // The method converged if all local residual satisfy the convergence criterion
+                    converged = (global_residual < tol);
+                    if (progress)
+                        progress->publish(iteration + 1, global_residual);
+                    if (converged)
+                    {
+                        iter = ++iteration;
+                    }
+                    else if (iteration == max_iter - 1)
+                    {
+                        iter = ++iteration;
+                        if (mpi_rank == 0)
+                            std::cout << "Warning from Hybrid tasks solver: Maximum number of iterations reached without convergence." << std::endl;
+                    }
+                }
+            }
+
+            // The exchange is posted at the start of an iteration, so the ghost rows still hold the values of
+            // the previous one: bring them up to date, so that the gathered slabs agree on the rows they share
+            if (mpi_size > 1)
+            {
+                trace::Scope scope(trace::Phase::Exchange);
+                MPI_Request requests[4];
+                int num_requests = 0;
+                if (has_next)
+                {
+                    MPI_Irecv(bottom_ghost, n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, &requests[num_requests++]);
+                    MPI_Isend(&local_uh[(local_rows - 2) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, &requests[num_requests++]);
+                }
+                if (has_prev)
+                {
+                    MPI_Irecv(top_ghost, n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, &requests[num_requests++]);
+                    MPI_Isend(&local_uh[n], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, &requests[num_requests++]);
+                }
+                MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+            }
+
+            // Record the statistics of the solve
+            solver_stats.method = "jacobi_hybrid_tasks";
+            solver_stats.grid_pages = memory::page_info(local_uh.data());
+
+            {
+                trace::Scope scope(trace::Phase::Gather);
+                // Synchronize all processes before gathering results
+                MPI_Barrier(mpi_comm);
+
+                // Gather the results from local grids in uh (global grid)
+                MPI_Gatherv(local_uh.data(),
+                            local_rows * n,
+                            MPI_DOUBLE,
+                            uh.data(),
+                            counts.data(),
+                            start_idxs.data(),
+                            MPI_DOUBLE,
+                            0,
+                            mpi_comm);
+            }
+        }
+        else
+        {
+            std::cerr << "Error: MPI is not initialized." << std::endl;
+            return;
+        }
+    }
+
+    void Solver::solve_direct_mpi()
+    {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+
+        int initialized;
+        MPI_Initialized(&initialized);
+
+        if (initialized)
+        {
+            // Communicator among which the grid is distributed (MPI_COMM_WORLD by default)
+            MPI_Comm mpi_comm = comm;
+
+            // Get size and rank
+            int mpi_rank, mpi_size;
+            MPI_Comm_rank(mpi_comm, &mpi_rank);
+            MPI_Comm_size(mpi_comm, &mpi_size);
+
+            // Set the boundary conditions
+            if (mpi_rank == 0)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    uh[i] = fun_at(top_bc, 0, i);                      // Top boundary
+                    uh[i * n + (n - 1)] = fun_at(right_bc, i, n - 1);  // Right boundary
+                    uh[(n - 1) * n + i] = fun_at(bottom_bc, n - 1, i); // Bottom boundary
+                    uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
+                }
+            }
+
+            // Divide the rows of the grid among the processes
+            std::vector<int> counts, start_idxs;
+            decompose(mpi_size, counts, start_idxs);
+
+            // Reduction of the residual, built on the first solve on this communicator (collective)
+            const reduction::Allreduce &allreducer = reducer();
+
+            // Number of rows of the local grid, ghost rows included
+            unsigned int local_rows = counts[mpi_rank] / n;
+
+            // Memory of the solve on this rank (warns if the node would run out of it, collective)
+            check_memory("direct_mpi", local_rows, mpi_comm, 1);
+
+            // Declare the local grid
+            grid_type local_uh(local_rows * n);
+
+            // Scatter the initial guess between processes
+            {
+                trace::Scope scope(trace::Phase::Scatter);
+                MPI_Scatterv(uh.data(),
+                             counts.data(),
+                             start_idxs.data(),
+                             MPI_DOUBLE,
+                             local_uh.data(),
+                             local_rows * n,
+                             MPI_DOUBLE,
+                             0,
+                             mpi_comm);
+            }
+
+            // Grid that will containt the solution at the previous iteration
+            grid_type local_previous(local_rows * n);
+
+            // Define converged variable
+            bool converged = false;
+
+            // Writer of the progress of the solve (if any, on rank 0)
+            telemetry::Publisher *progress = start_telemetry("direct_mpi", mpi_rank, mpi_size);
+
+            // Define h
+            const double h = 1.0 / (n - 1);
+
+            // Right-hand side, an outer product of two vectors if f is separable
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(start_idxs[mpi_rank] / n, local_rows, f_x, f_y, mpi_comm);
+
+            // Solve the local system with the current ghost rows
+            auto solve_subdomain = [&]()
+            {
+                // Assemble local system
+                unsigned working_rows = local_rows - 2; // in each case, top and bottom rows are given
+                unsigned working_cols = n - 2;          // in each case, left and right columns are given
+                // Unknowns are in the interior of the grid, so we have working_rows * working_cols unknowns
+                SparseMatrix<double> A(working_rows * working_cols, working_rows * working_cols);
+                std::vector<Triplet<double>> triplets; // to insert elements in sparse matrix
+                VectorXd b = VectorXd::Zero(working_rows * working_cols);
+
+                for (size_t i = 0; i < working_rows; ++i)
+                {
+                    for (size_t j = 0; j < working_cols; ++j)
+                    {
+                        int idx = i * working_cols + j;
+                        triplets.emplace_back(idx, idx, 4.0);
+                        if (i > 0)
+                        { // Use top neighbor
+                            triplets.emplace_back(idx, idx - working_cols, -1.0);
+                        }
+                        else
+                        {
+                            // If we are at the first local row, use upper ghost row
+                            b(idx) += local_uh[j + 1];
+                        }
+                        if (i < working_rows - 1)
+                        { // Use bottom neighbor
                             triplets.emplace_back(idx, idx + working_cols, -1.0);
                         }
                         else
                         {
                             // If we are at the last local row, use lower ghost row
-                            b(idx) += local_uh[(local_rows - 1) * n + j];
+                            b(idx) += local_uh[(local_rows - 1) * n + j + 1];
                         }
                         if (j > 0)
                         { // Use left neighbor
@@ -725,7 +1058,7 @@ namespace solver
                         else
                         {
                             // If we are at the first local column, use left ghost column
-                            b(idx) += local_uh[i * n];
+                            b(idx) += local_uh[(i + 1) * n];
                         }
                         if (j < working_cols - 1)
                         { // Use right neighbor
@@ -734,33 +1067,89 @@ namespace solver
                         else
                         {
                             // If we are at the last local column, use right ghost column
-                            b(idx) += local_uh[i * n + (n - 1)];
+                            b(idx) += local_uh[(i + 1) * n + (n - 1)];
                         }
-                        b(idx) += h * h * fun_at(f, start_idxs[mpi_rank] / n + i + 1, j + 1);
+                        b(idx) += separable_f ? f_x[i + 1] * f_y[j + 1] : h * h * fun_at(f, start_idxs[mpi_rank] / n + i + 1, j + 1);
                     }
                 }
 
                 A.setFromTriplets(triplets.begin(), triplets.end());
 
                 // Solve the local system
-                Eigen::SimplicialLDLT<SparseMatrix<double>> solver;
-                solver.compute(A);
-                VectorXd x = solver.solve(b);
+                VectorXd x;
+                {
+                    trace::Scope scope(trace::Phase::Sweep);
+                    Eigen::SimplicialLDLT<SparseMatrix<double>> solver;
+                    solver.compute(A);
+                    x = solver.solve(b);
+                }
 
                 for (unsigned i = 1; i < local_rows - 1; ++i)
                     for (unsigned j = 1; j < n - 1; ++j)
                         local_uh[i * n + j] = x[(i - 1) * working_cols + j - 1];
+            };
+
+            // Send the first and last interior rows to the ghost rows of the neighbouring ranks
+            auto send_rows = [&]()
+            {
+                if (mpi_rank < mpi_size - 1)
+                    MPI_Send(&local_uh[(local_rows - 2) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm);
+                if (mpi_rank > 0)
+                    MPI_Send(&local_uh[1 * n], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm);
+            };
+
+            // Receive the interior rows of the neighbouring ranks in the ghost rows
+            auto receive_rows = [&]()
+            {
+                if (mpi_rank > 0)
+                    MPI_Recv(&local_uh[0], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                if (mpi_rank < mpi_size - 1)
+                    MPI_Recv(&local_uh[(local_rows - 1) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+            };
+
+            for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
+            {
+                // Save the previous solution for convergence check
+                std::copy(local_uh.begin(), local_uh.end(), local_previous.begin());
+
+                if (schwarz == Schwarz::Multiplicative)
+                {
+                    // The neighbours of an even rank are odd: the even ranks solve and send their new rows,
+                    // then the odd ranks solve with them and send theirs back
+                    for (int colour : {0, 1})
+                    {
+                        if (mpi_rank % 2 == colour)
+                            solve_subdomain();
+                        if (mpi_size > 1)
+                        {
+                            trace::Scope scope(trace::Phase::Exchange);
+                            if (mpi_rank % 2 == colour)
+                                send_rows();
+                            else
+                                receive_rows();
+                        }
+                    }
+                }
+                else
+                    solve_subdomain();
 
                 // Check for convergence
-                // Compute the local residual
-                double local_residual = compute_error_serial(local_uh, local_previous, local_rows, n);
+                // Compute the local residual on the interior rows (the ghost rows may already hold new values)
+                double local_diff{0.0};
+                for (unsigned i = 1; i < local_rows - 1; ++i)
+                    local_diff += kernels::squared_difference(&local_uh[i * n], &local_previous[i * n], n);
+                double local_residual = std::sqrt(1.0 / (n - 1) * local_diff);
                 double global_residual;
-                // Ensure all processes have computed their local residual before reduction
-                MPI_Barrier(mpi_comm);
-                // Find the maximum residual across all processes
-                MPI_Allreduce(&local_residual, &global_residual, 1, MPI_DOUBLE, MPI_MAX, mpi_comm);
+                {
+                    trace::Scope scope(trace::Phase::Reduction);
+                    // Find the maximum residual across all processes (the reduction synchronizes them)
+                    global_residual = local_residual;
+                    allreducer.reduce(&global_residual, 1, MPI_MAX);
+                }
                 // The method converged if all local residual satisfy the convergence criterion
                 converged = (global_residual < tol);
+                if (progress)
+                    progress->publish(iteration + 1, global_residual);
                 if (converged)
                 {
                     iter = ++iteration;
@@ -772,9 +1161,11 @@ namespace solver
                         std::cout << "Warning from Direct solver: Maximum number of iterations reached without convergence." << std::endl;
                 }
 
-                // Bidirectional ghost cell exchange
-                if (mpi_size > 1)
+                // Bidirectional ghost cell exchange (the multiplicative iteration has exchanged after each colour)
+                if (mpi_size > 1 && schwarz == Schwarz::Additive)
                 {
+                    trace::Scope scope(trace::Phase::Exchange);
+
                     // Send/receive with next rank
                     if (mpi_rank < mpi_size - 1)
                     {
@@ -795,19 +1186,26 @@ namespace solver
                 }
             }
 
-            // Synchronize all processes before gathering results
-            MPI_Barrier(mpi_comm);
+            // Record the statistics of the solve
+            solver_stats.method = (schwarz == Schwarz::Multiplicative) ? "direct_mpi_multiplicative" : "direct_mpi";
+            solver_stats.grid_pages = memory::page_info(local_uh.data());
+
+            {
+                trace::Scope scope(trace::Phase::Gather);
+                // Synchronize all processes before gathering results
+                MPI_Barrier(mpi_comm);
 
-            // Gather the results from local grids in uh (global grid)
-            MPI_Gatherv(local_uh.data(),
-                        local_rows * n,
-                        MPI_DOUBLE,
-                        uh.data(),
-                        counts.data(),
-                        start_idxs.data(),
-                        MPI_DOUBLE,
-                        0,
-                        mpi_comm);
+                // Gather the results from local grids in uh (global grid)
+                MPI_Gatherv(local_uh.data(),
+                            local_rows * n,
+                            MPI_DOUBLE,
+                            uh.data(),
+                            counts.data(),
+                            start_idxs.data(),
+                            MPI_DOUBLE,
+                            0,
+                            mpi_comm);
+            }
         }
         else
         {
@@ -816,41 +1214,1052 @@ namespace solver
         }
     }
 
-    double Solver::compute_error_serial(const std::vector<double> &sol1, const std::vector<double> &sol2, unsigned rows, unsigned cols) const
+    void Solver::solve_direct_hybrid()
     {
-        double error{0.0};
-        for (unsigned i = 0; i < rows; ++i)
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy, num_threads);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+
+        int initialized;
+        MPI_Initialized(&initialized);
+
+        if (initialized)
         {
-            for (unsigned j = 0; j < cols; ++j)
+            // Communicator among which the grid is distributed (MPI_COMM_WORLD by default)
+            MPI_Comm mpi_comm = comm;
+
+            // Get size and rank
+            int mpi_rank, mpi_size;
+            MPI_Comm_rank(mpi_comm, &mpi_rank);
+            MPI_Comm_size(mpi_comm, &mpi_size);
+
+            // Set the boundary conditions
+            if (mpi_rank == 0)
             {
-                error += (sol1[i * n + j] - sol2[i * n + j]) * (sol1[i * n + j] - sol2[i * n + j]);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    uh[i] = fun_at(top_bc, 0, i);                      // Top boundary
+                    uh[i * n + (n - 1)] = fun_at(right_bc, i, n - 1);  // Right boundary
+                    uh[(n - 1) * n + i] = fun_at(bottom_bc, n - 1, i); // Bottom boundary
+                    uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
+                }
             }
-        }
-        error = std::sqrt(1.0 / (n - 1) * error);
-        return error;
-    }
 
-    double Solver::compute_error_omp(const std::vector<double> &sol1, const std::vector<double> &sol2, unsigned rows, unsigned cols) const
-    {
-        double error{0.0};
-#ifdef _OPENMP
-        int num_threads = omp_get_num_threads();
-        int chunk_size = (n * n) / (num_threads); // ensures all elements are covered
-#pragma omp barrier
-#pragma omp parallel for collapse(2) schedule(static, chunk_size) reduction(+ : error) num_threads(num_threads)
-#endif
-        for (unsigned i = 0; i < rows; ++i)
-        {
-            for (unsigned j = 0; j < cols; ++j)
+            // Divide the rows of the grid among the processes
+            std::vector<int> counts, start_idxs;
+            decompose(mpi_size, counts, start_idxs);
+
+            // Reduction of the residual, built on the first solve on this communicator (collective)
+            const reduction::Allreduce &allreducer = reducer();
+
+            // Number of rows of the local grid, ghost rows included
+            unsigned int local_rows = counts[mpi_rank] / n;
+
+            // Memory of the solve on this rank (warns if the node would run out of it, collective)
+            check_memory("direct_hybrid", local_rows, mpi_comm, num_threads);
+
+            // Declare the local grid
+            grid_type local_uh(local_rows * n);
+
+            // Scatter the initial guess between processes
             {
-                error += (sol1[i * n + j] - sol2[i * n + j]) * (sol1[i * n + j] - sol2[i * n + j]);
+                trace::Scope scope(trace::Phase::Scatter);
+                MPI_Scatterv(uh.data(),
+                             counts.data(),
+                             start_idxs.data(),
+                             MPI_DOUBLE,
+                             local_uh.data(),
+                             local_rows * n,
+                             MPI_DOUBLE,
+                             0,
+                             mpi_comm);
             }
+
+            // Define converged variable
+            bool converged = false;
+
+            // Writer of the progress of the solve (if any, on rank 0), fed by thread 0
+            telemetry::Publisher *progress = start_telemetry("direct_hybrid", mpi_rank, mpi_size);
+
+            // Partial sums of the squared updates, one per thread
+            std::vector<double> partial_diff(num_threads, 0.0);
+
+            // Define h
+            const double h = 1.0 / (n - 1);
+
+            // Right-hand side, an outer product of two vectors if f is separable
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(start_idxs[mpi_rank] / n, local_rows, f_x, f_y, mpi_comm);
+
+            // Each thread solves the subdomain of a strip of the local interior rows, with the old values of the
+            // rows bordering the strip as Dirichlet data; thread 0 also takes care of the communication
+            auto worker = [&](unsigned thread_id, unsigned team_size, const std::function<void()> &barrier)
+            {
+                size_t first, last;
+                kernels::strip_bounds(1, local_rows - 1, thread_id, team_size, first, last);
+                const size_t rows = last - first, cols = n - 2, unknowns = rows * cols;
+
+                // The matrix and h^2 f do not change between the iterations: the strip is assembled and
+                // factorized once, and every iteration only builds b and solves with the cached factor
+                Eigen::SimplicialLDLT<SparseMatrix<double>> factor;
+                VectorXd source(unknowns);
+                if (unknowns > 0)
+                {
+                    trace::Scope scope(trace::Phase::Sweep);
+                    SparseMatrix<double> A(unknowns, unknowns);
+                    std::vector<Triplet<double>> triplets;
+                    triplets.reserve(5 * unknowns);
+                    for (size_t i = 0; i < rows; ++i)
+                    {
+                        for (size_t j = 0; j < cols; ++j)
+                        {
+                            const size_t idx = i * cols + j;
+                            triplets.emplace_back(idx, idx, 4.0);
+                            if (i > 0)
+                                triplets.emplace_back(idx, idx - cols, -1.0);
+                            if (i < rows - 1)
+                                triplets.emplace_back(idx, idx + cols, -1.0);
+                            if (j > 0)
+                                triplets.emplace_back(idx, idx - 1, -1.0);
+                            if (j < cols - 1)
+                                triplets.emplace_back(idx, idx + 1, -1.0);
+                            source(idx) = separable_f ? f_x[first + i] * f_y[j + 1] : h * h * fun_at(f, start_idxs[mpi_rank] / n + first + i, j + 1);
+                        }
+                    }
+                    A.setFromTriplets(triplets.begin(), triplets.end());
+                    factor.compute(A);
+                }
+
+                // Old values of the rows bordering the strip, right-hand side and solution of the strip
+                std::vector<double> above(n), below(n);
+                VectorXd b(unknowns), x(unknowns);
+
+                for (size_t iteration = 0; iteration < max_iter && !converged; ++iteration)
+                {
+                    // Save the old rows bordering the strip before the neighbours overwrite them
+                    std::copy(local_uh.begin() + (first - 1) * n, local_uh.begin() + first * n, above.begin());
+                    std::copy(local_uh.begin() + last * n, local_uh.begin() + (last + 1) * n, below.begin());
+                    barrier();
+
+                    // Solve the system of the strip
+                    double diff{0.0};
+                    if (unknowns > 0)
+                    {
+                        trace::Scope scope(trace::Phase::Sweep);
+                        b = source;
+                        for (size_t i = 0; i < rows; ++i)
+                        {
+                            const double *row = &local_uh[(first + i) * n];
+                            b(i * cols) += row[0];                // Left boundary
+                            b(i * cols + cols - 1) += row[n - 1]; // Right boundary
+                        }
+                        for (size_t j = 0; j < cols; ++j)
+                        {
+                            b(j) += above[j + 1];                     // Row above the strip
+                            b((rows - 1) * cols + j) += below[j + 1]; // Row below the strip
+                        }
+                        x = factor.solve(b);
+
+                        for (size_t i = 0; i < rows; ++i)
+                        {
+                            double *row = &local_uh[(first + i) * n];
+                            for (size_t j = 0; j < cols; ++j)
+                            {
+                                const double delta = x(i * cols + j) - row[j + 1];
+                                diff += delta * delta;
+                                row[j + 1] = x(i * cols + j);
+                            }
+                        }
+                    }
+                    partial_diff[thread_id] = diff;
+                    barrier();
+
+                    if (thread_id == 0)
+                    {
+                        // Check for convergence
+                        // Compute the local residual
+                        double local_diff = std::accumulate(partial_diff.begin(), partial_diff.begin() + team_size, 0.0);
+                        double local_residual = std::sqrt(1.0 / (n - 1) * local_diff);
+                        double global_residual;
+                        {
+                            trace::Scope scope(trace::Phase::Reduction);
+                            // Find the maximum residual across all processes (the reduction synchronizes them)
+                            global_residual = local_residual;
+                            allreducer.reduce(&global_residual, 1, MPI_MAX);
+                        }
+                        // The method converged if all local residual satisfy the convergence criterion
+                        converged = (global_residual < tol);
+                        if (progress)
+                            progress->publish(iteration + 1, global_residual);
+                        if (converged)
+                        {
+                            iter = ++iteration;
+                        }
+                        else if (iteration == max_iter - 1)
+                        {
+                            iter = ++iteration;
+                            if (mpi_rank == 0)
+                                std::cout << "Warning from Direct hybrid solver: Maximum number of iterations reached without convergence." << std::endl;
+                        }
+
+                        // Bidirectional ghost cell exchange
+                        if (mpi_size > 1)
+                        {
+                            trace::Scope scope(trace::Phase::Exchange);
+
+                            // Send/receive with next rank
+                            if (mpi_rank < mpi_size - 1)
+                            {
+                                // Send my last interior row to next rank's ghost row
+                                MPI_Send(&local_uh[(local_rows - 2) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm);
+                                // Receive next rank's first interior row into my ghost row
+                                MPI_Recv(&local_uh[(local_rows - 1) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                            }
+
+                            // Send/receive with previous rank
+                            if (mpi_rank > 0)
+                            {
+                                // Send my first interior row to previous rank's ghost row
+                                MPI_Send(&local_uh[1 * n], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm);
+                                // Receive previous rank's last interior row into my ghost row
+                                MPI_Recv(&local_uh[0], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+                            }
+                        }
+                    }
+                    barrier();
+                }
+            };
+            run_parallel(worker);
+
+            // Record the statistics of the solve
+            solver_stats.method = "direct_hybrid";
+            solver_stats.grid_pages = memory::page_info(local_uh.data());
+
+            {
+                trace::Scope scope(trace::Phase::Gather);
+                // Synchronize all processes before gathering results
+                MPI_Barrier(mpi_comm);
+
+                // Gather the results from local grids in uh (global grid)
+                MPI_Gatherv(local_uh.data(),
+                            local_rows * n,
+                            MPI_DOUBLE,
+                            uh.data(),
+                            counts.data(),
+                            start_idxs.data(),
+                            MPI_DOUBLE,
+                            0,
+                            mpi_comm);
+            }
+        }
+        else
+        {
+            std::cerr << "Error: MPI is not initialized." << std::endl;
+            return;
+        }
+    }
+
+    void Solver::solve_cg_mpi()
+    {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+
+        int initialized;
+        MPI_Initialized(&initialized);
+
+        if (!initialized)
+        {
+            std::cerr << "Error: MPI is not initialized." << std::endl;
+            return;
+        }
+
+        // Communicator among which the grid is distributed (MPI_COMM_WORLD by default)
+        MPI_Comm mpi_comm = comm;
+
+        // Get size and rank
+        int mpi_rank, mpi_size;
+        MPI_Comm_rank(mpi_comm, &mpi_rank);
+        MPI_Comm_size(mpi_comm, &mpi_size);
+
+        // Set the boundary conditions
+        if (mpi_rank == 0)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                uh[i] = fun_at(top_bc, 0, i);                      // Top boundary
+                uh[i * n + (n - 1)] = fun_at(right_bc, i, n - 1);  // Right boundary
+                uh[(n - 1) * n + i] = fun_at(bottom_bc, n - 1, i); // Bottom boundary
+                uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
+            }
+        }
+
+        // Divide the rows of the grid among the processes
+        std::vector<int> counts, start_idxs;
+        decompose(mpi_size, counts, start_idxs);
+
+        // Reduction of the residual, built on the first solve on this communicator (collective)
+        const reduction::Allreduce &allreducer = reducer();
+
+        // Number of rows of the local grid, ghost rows included
+        const size_t local_rows = counts[mpi_rank] / n;
+        const size_t size = local_rows * n;
+
+        // Memory of the solve on this rank (warns if the node would run out of it, collective)
+        check_memory("cg_mpi", local_rows, mpi_comm, 1);
+
+        // Declare the local grid and scatter the initial guess
+        grid_type local_uh(size);
+        {
+            trace::Scope scope(trace::Phase::Scatter);
+            MPI_Scatterv(uh.data(), counts.data(), start_idxs.data(), MPI_DOUBLE,
+                         local_uh.data(), size, MPI_DOUBLE, 0, mpi_comm);
+        }
+
+        // The owned points are the interior rows 1, ..., local_rows - 2; the vectors of the
+        // iteration vanish on the boundary columns, so whole rows can be processed
+        const size_t begin = n, end = (local_rows - 1) * n;
+
+        auto local_dot = [&](const double *a, const double *b)
+        {
+            double sum{0.0};
+            for (size_t k = begin; k < end; ++k)
+                sum += a[k] * b[k];
+            return sum;
+        };
+
+        // Ghost cell exchange of a local vector
+        auto exchange = [&](double *v)
+        {
+            if (mpi_size == 1)
+                return;
+            trace::Scope scope(trace::Phase::Exchange);
+            if (mpi_rank < mpi_size - 1)
+                MPI_Sendrecv(&v[(local_rows - 2) * n], n, MPI_DOUBLE, mpi_rank + 1, 0,
+                             &v[(local_rows - 1) * n], n, MPI_DOUBLE, mpi_rank + 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+            if (mpi_rank > 0)
+                MPI_Sendrecv(&v[n], n, MPI_DOUBLE, mpi_rank - 1, 0,
+                             &v[0], n, MPI_DOUBLE, mpi_rank - 1, 0, mpi_comm, MPI_STATUS_IGNORE);
+        };
+
+        // Matrix-free 5-point operator on the owned points (v must have up-to-date ghost rows)
+        auto apply = [&](const double *v, double *Av)
+        {
+            trace::Scope scope(trace::Phase::Sweep);
+            for (size_t i = 1; i < local_rows - 1; ++i)
+                for (size_t j = 1; j < n - 1; ++j)
+                {
+                    const size_t k = i * n + j;
+                    Av[k] = 4.0 * v[k] - v[k - n] - v[k + n] - v[k - 1] - v[k + 1];
+                }
+        };
+
+        auto allreduce = [&](double *values, int count)
+        {
+            trace::Scope scope(trace::Phase::Reduction);
+            allreducer.reduce(values, count, MPI_SUM);
+        };
+
+        // Residual of the equations scaled by h^2: r = h^2 f - A u, with the Dirichlet data in u
+        const double h = 1.0 / (n - 1);
+        std::vector<double> r(size, 0.0);
+        {
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(start_idxs[mpi_rank] / n, local_rows, f_x, f_y, mpi_comm);
+            std::vector<double> Au(size, 0.0);
+            apply(local_uh.data(), Au.data());
+            for (size_t i = 1; i < local_rows - 1; ++i)
+                for (size_t j = 1; j < n - 1; ++j)
+                {
+                    const double rhs = separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, start_idxs[mpi_rank] / n + i, j);
+                    r[i * n + j] = rhs - Au[i * n + j];
+                }
+        }
+
+        // Recycled space: it is used only if every process has one for this decomposition
+        double valid = (recycle > 0 && !recycle_W.empty() && recycle_W[0].size() == size) ? 1.0 : 0.0;
+        {
+            trace::Scope scope(trace::Phase::Reduction);
+            allreducer.reduce(&valid, 1, MPI_MIN);
+        }
+        if (valid == 0.0)
+            clear_recycle();
+        const size_t k = recycle_W.size();
+
+        // W^T A W (the identity up to rounding) and the projection mu = (W^T A W)^-1 (AW)^T v
+        Eigen::MatrixXd WAW(k, k);
+        for (size_t a = 0; a < k; ++a)
+            for (size_t b = 0; b < k; ++b)
+                WAW(a, b) = local_dot(recycle_W[a].data(), recycle_AW[b].data());
+        allreduce(WAW.data(), k * k);
+        Eigen::LDLT<Eigen::MatrixXd> WAW_ldlt(0.5 * (WAW + WAW.transpose()));
+
+        // Packed reductions: {r.r, (AW)^T r} and {W^T r}
+        std::vector<double> packed(k + 1);
+        auto reduce_residual = [&]()
+        {
+            packed[0] = local_dot(r.data(), r.data());
+            for (size_t a = 0; a < k; ++a)
+                packed[a + 1] = local_dot(recycle_AW[a].data(), r.data());
+            allreduce(packed.data(), k + 1);
+        };
+        auto projection = [&]()
+        {
+            Eigen::VectorXd rhs(k);
+            for (size_t a = 0; a < k; ++a)
+                rhs(a) = packed[a + 1];
+            return Eigen::VectorXd(WAW_ldlt.solve(rhs));
+        };
+
+        // Deflated initial guess: x0 = x + W (W^T A W)^-1 W^T r, so that r0 is orthogonal to W
+        if (k > 0)
+        {
+            for (size_t a = 0; a < k; ++a)
+                packed[a + 1] = local_dot(recycle_W[a].data(), r.data());
+            allreduce(packed.data() + 1, k);
+            const Eigen::VectorXd c = projection();
+            for (size_t a = 0; a < k; ++a)
+                for (size_t q = begin; q < end; ++q)
+                {
+                    local_uh[q] += c(a) * recycle_W[a][q];
+                    r[q] -= c(a) * recycle_AW[a][q];
+                }
+        }
+
+        // Rayleigh-Ritz on span(Z): Z is replaced by the Ritz vectors of the keep smallest Ritz values,
+        // which are A-orthonormal; returns the smallest Ritz value (0 if the projection failed)
+        auto rayleigh_ritz = [&](std::vector<std::vector<double>> &Z, std::vector<std::vector<double>> &AZ, size_t keep)
+        {
+            const size_t m = Z.size();
+            if (m == 0)
+                return 0.0;
+
+            // G = Z^T A Z and F = Z^T Z in a single reduction
+            std::vector<double> GF(2 * m * m);
+            for (size_t a = 0; a < m; ++a)
+                for (size_t b = a; b < m; ++b)
+                {
+                    GF[a * m + b] = GF[b * m + a] = 0.5 * (local_dot(Z[a].data(), AZ[b].data()) + local_dot(Z[b].data(), AZ[a].data()));
+                    GF[m * m + a * m + b] = GF[m * m + b * m + a] = local_dot(Z[a].data(), Z[b].data());
+                }
+            allreduce(GF.data(), 2 * m * m);
+            const Eigen::MatrixXd G = Eigen::Map<Eigen::MatrixXd>(GF.data(), m, m);
+            const Eigen::MatrixXd F = Eigen::Map<Eigen::MatrixXd>(GF.data() + m * m, m, m);
+
+            // F y = mu G y with mu = 1 / theta: the largest mu are the smallest Ritz values,
+            // and the eigenvectors are G-orthonormal
+            Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> ritz(F, G);
+            if (ritz.info() != Eigen::Success)
+                return 0.0;
+
+            keep = std::min(keep, m);
+            std::vector<std::vector<double>> Y(keep, std::vector<double>(size, 0.0)), AY(keep, std::vector<double>(size, 0.0));
+            for (size_t c = 0; c < keep; ++c)
+            {
+                for (size_t a = 0; a < m; ++a)
+                {
+                    const double y = ritz.eigenvectors()(a, m - 1 - c);
+                    for (size_t q = begin; q < end; ++q)
+                    {
+                        Y[c][q] += y * Z[a][q];
+                        AY[c][q] += y * AZ[a][q];
+                    }
+                }
+            }
+            Z = std::move(Y);
+            AZ = std::move(AY);
+            return 1.0 / ritz.eigenvalues()(m - 1);
+        };
+
+        // First search direction p0 = r0 - W mu0
+        std::vector<double> p(r), Ap(size, 0.0), Ap_previous(size, 0.0);
+        reduce_residual();
+        double rr = packed[0];
+        Eigen::VectorXd mu = Eigen::VectorXd::Zero(k);
+        if (k > 0)
+        {
+            mu = projection();
+            for (size_t a = 0; a < k; ++a)
+                for (size_t q = begin; q < end; ++q)
+                    p[q] -= mu(a) * recycle_W[a][q];
+        }
+        double beta = 0.0;
+
+        // The normalized residuals are the Lanczos vectors of CG: they are collected with their
+        // products with the matrix, and compressed to the 2 recycle best Ritz vectors every time
+        // the window of 4 recycle vectors is full (thick restart, as in eigCG)
+        const size_t window = 4 * recycle;
+        std::vector<std::vector<double>> V, AV;
+
+        // Writer of the progress of the solve (if any, on rank 0)
+        telemetry::Publisher *progress = start_telemetry("cg_mpi", mpi_rank, mpi_size);
+
+        bool converged = false, breakdown = false;
+        double breakdown_pAp = 0.0;
+        size_t iteration = 0;
+        for (; iteration < max_iter; ++iteration)
+        {
+            // Check for convergence
+            if (std::sqrt(rr / (n - 1)) < tol)
+            {
+                converged = true;
+                break;
+            }
+
+            exchange(p.data());
+            apply(p.data(), Ap.data());
+            double pAp = local_dot(p.data(), Ap.data());
+            allreduce(&pAp, 1);
+            if (!(pAp > 0.0))
+            {
+                // The operator is not positive definite along p (or the values are not finite)
+                breakdown = true;
+                breakdown_pAp = pAp;
+                break;
+            }
+
+            if (window > 0)
+            {
+                // p = r + beta p_previous - W mu, so A r = A p - beta A p_previous + (AW) mu
+                const double scale = 1.0 / std::sqrt(rr);
+                V.emplace_back(size, 0.0);
+                AV.emplace_back(size, 0.0);
+                for (size_t q = begin; q < end; ++q)
+                {
+                    double Ar = Ap[q] - beta * Ap_previous[q];
+                    for (size_t a = 0; a < k; ++a)
+                        Ar += mu(a) * recycle_AW[a][q];
+                    V.back()[q] = scale * r[q];
+                    AV.back()[q] = scale * Ar;
+                }
+                if (V.size() == window)
+                    rayleigh_ritz(V, AV, 2 * recycle);
+            }
+
+            const double alpha = rr / pAp;
+            for (size_t q = begin; q < end; ++q)
+            {
+                local_uh[q] += alpha * p[q];
+                r[q] -= alpha * Ap[q];
+            }
+
+            reduce_residual();
+            beta = packed[0] / rr;
+            rr = packed[0];
+            if (progress)
+                progress->publish(iteration + 1, std::sqrt(rr / (n - 1)));
+            std::swap(Ap, Ap_previous);
+            for (size_t q = begin; q < end; ++q)
+                p[q] = r[q] + beta * p[q];
+            if (k > 0)
+            {
+                mu = projection();
+                for (size_t a = 0; a < k; ++a)
+                    for (size_t q = begin; q < end; ++q)
+                        p[q] -= mu(a) * recycle_W[a][q];
+            }
+
+            // In-situ heatmap of the iterate (its ghost rows are only exchanged for the image)
+            if (!monitor_name.empty() && monitor_every > 0 && (iteration + 1) % monitor_every == 0)
+            {
+                exchange(local_uh.data());
+                monitor(local_uh.data(), start_idxs, local_rows, std::to_string(iteration + 1));
+            }
+        }
+        iter = iteration;
+        if (breakdown && mpi_rank == 0)
+            std::cout << "Warning from CG solver: breakdown at iteration " << iteration << ", p^T A p = " << breakdown_pAp
+                      << " is not positive (indefinite operator)." << std::endl;
+        else if (!converged && mpi_rank == 0)
+            std::cout << "Warning from CG solver: Maximum number of iterations reached without convergence." << std::endl;
+
+        // The new recycled space comes from the old one and the vectors harvested in this solve
+        solver_stats.smallest_ritz_value = 0.0;
+        if (recycle > 0)
+        {
+            for (size_t a = 0; a < k; ++a)
+            {
+                V.push_back(std::move(recycle_W[a]));
+                AV.push_back(std::move(recycle_AW[a]));
+            }
+            solver_stats.smallest_ritz_value = rayleigh_ritz(V, AV, recycle);
+            recycle_W = std::move(V);
+            recycle_AW = std::move(AV);
+        }
+
+        // Record the statistics of the solve
+        solver_stats.method = "cg_mpi";
+        solver_stats.grid_pages = memory::page_info(local_uh.data());
+        solver_stats.deflation_vectors = k;
+
+        // The ghost rows are gathered as well, so they must be up to date
+        exchange(local_uh.data());
+        if (!monitor_name.empty())
+            monitor(local_uh.data(), start_idxs, local_rows, "final");
+        {
+            trace::Scope scope(trace::Phase::Gather);
+            MPI_Barrier(mpi_comm);
+            MPI_Gatherv(local_uh.data(), size, MPI_DOUBLE, uh.data(), counts.data(), start_idxs.data(),
+                        MPI_DOUBLE, 0, mpi_comm);
+        }
+    }
+
+    void Solver::solve_lifting()
+    {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy, num_threads);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+
+        if (!lifting || lifting->size() != n)
+        {
+            lifting.emplace(n);
+            lifting_interior.clear();
+        }
+
+        unsigned iterations = 0;
+        if (lifting_interior.size() != n * n)
+        {
+            // Solve once with homogeneous Dirichlet data, starting from zero
+            auto bcs = std::make_tuple(top_bc, right_bc, bottom_bc, left_bc);
+            auto zero = [](std::vector<double>)
+            { return 0.0; };
+            set_bc(zero, zero, zero, zero);
+            reset();
+            solve_jacobi_omp();
+            iterations = iter;
+            lifting_interior = uh;
+            std::tie(top_bc, right_bc, bottom_bc, left_bc) = bcs;
+        }
+
+        // Memory of the solve, after the homogeneous solve that has its own
+        check_memory("lifting", n, MPI_COMM_NULL, num_threads);
+
+        // Values of the boundary conditions on the four sides
+        std::vector<double> top(n), right(n), bottom(n), left(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            top[i] = fun_at(top_bc, 0, i);
+            right[i] = fun_at(right_bc, i, n - 1);
+            bottom[i] = fun_at(bottom_bc, n - 1, i);
+            left[i] = fun_at(left_bc, i, 0);
+        }
+
+        uh = lifting_interior;
+        {
+            trace::Scope scope(trace::Phase::Sweep);
+            lifting->apply(top, right, bottom, left, uh.data());
+        }
+
+        // Set the boundary conditions (in the same order as the other solvers, for the corners)
+        for (size_t i = 0; i < n; ++i)
+        {
+            uh[i] = top[i];                   // Top boundary
+            uh[i * n + (n - 1)] = right[i];   // Right boundary
+            uh[(n - 1) * n + i] = bottom[i];  // Bottom boundary
+            uh[i * n] = left[i];              // Left boundary
+        }
+
+        iter = iterations;
+
+        // Record the statistics of the solve
+        solver_stats.method = "lifting";
+        solver_stats.grid_pages = memory::page_info(uh.data());
+        return;
+    }
+
+    void Solver::solve_fast_poisson()
+    {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+        check_memory("fast_poisson", n, MPI_COMM_NULL, 1);
+
+        uh.assign(n * n, 0.0);
+        grid_type rhs_grid, equations;
+        dirichlet_equations(rhs_grid, equations);
+        {
+            trace::Scope scope(trace::Phase::Sweep);
+            add_dirichlet_solution(n, equations.data(), uh.data());
+        }
+
+        // The solve is exact up to rounding: one Gauss-Seidel sweep measures the residual against tol
+        double diff;
+        {
+            trace::Scope scope(trace::Phase::Sweep);
+            diff = kernels::gauss_seidel_sweep(uh.data(), n, rhs_grid.data());
+        }
+        if (std::sqrt(1.0 / (n - 1) * diff) >= tol)
+            std::cout << "Warning from fast Poisson solver: the residual is above the tolerance." << std::endl;
+        iter = 1;
+
+        // Record the statistics of the solve
+        solver_stats.method = "fast_poisson";
+        solver_stats.grid_pages = memory::page_info(uh.data());
+        return;
+    }
+
+    void Solver::solve_incremental()
+    {
+        trace::Scope solve_scope(trace::Phase::Solve);
+        probe_slab.clear();
+        energy::Measurement energy_measurement(solver_stats.energy);
+        footprint::Measurement footprint_measurement(solver_stats.footprint, memory_check);
+        check_memory("incremental", n, MPI_COMM_NULL, 1);
+
+        uh.assign(n * n, 0.0);
+        grid_type rhs_grid, equations;
+        dirichlet_equations(rhs_grid, equations);
+
+        // Nothing cached for this grid: the change is the whole system, from a zero solution
+        if (incremental_equations.size() != n * n)
+        {
+            incremental_equations.assign(n * n, 0.0);
+            incremental_uh.assign(n * n, 0.0);
+        }
+
+        // Warm start from the interior of the previous solution
+        for (size_t i = 1; i < n - 1; ++i)
+            std::copy(incremental_uh.begin() + i * n + 1, incremental_uh.begin() + (i + 1) * n - 1, uh.begin() + i * n + 1);
+
+        // The change of the equations (zero away from the changed region) is solved and added to the
+        // previous solution; the cache then takes the new equations. Changes at the level of rounding,
+        // e.g. between the outer product of a separable f and its pointwise values, are left to the sweeps
+        constexpr double rounding = 16 * std::numeric_limits<double>::epsilon();
+        for (size_t k = 0; k < n * n; ++k)
+        {
+            const double change = equations[k] - incremental_equations[k];
+            incremental_equations[k] = (std::abs(change) > rounding * std::abs(equations[k])) ? change : 0.0;
+        }
+        {
+            trace::Scope scope(trace::Phase::Sweep);
+            add_dirichlet_solution(n, incremental_equations.data(), uh.data());
+        }
+        incremental_equations.swap(equations);
+
+        // Global cleanup of the rounding of the previous solves
+        size_t sweeps = 0;
+        double residual;
+        do
+        {
+            trace::Scope scope(trace::Phase::Sweep);
+            residual = std::sqrt(1.0 / (n - 1) * kernels::gauss_seidel_sweep(uh.data(), n, rhs_grid.data()));
+        } while (++sweeps < max_iter && residual >= tol);
+        if (residual >= tol)
+            std::cout << "Warning from incremental solver: Maximum number of iterations reached without convergence." << std::endl;
+        iter = sweeps;
+        incremental_uh = uh;
+
+        // Record the statistics of the solve
+        solver_stats.method = "incremental";
+        solver_stats.grid_pages = memory::page_info(uh.data());
+        return;
+    }
+
+    void Solver::dirichlet_equations(grid_type &rhs_grid, grid_type &equations)
+    {
+        // Right-hand side h^2 f
+        const double h = 1.0 / (n - 1);
+        rhs_grid.assign(n * n, 0.0);
+        {
+            std::vector<double> f_x, f_y;
+            const bool separable_f = rhs_factors(0, n, f_x, f_y);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    rhs_grid[i * n + j] = separable_f ? f_x[i] * f_y[j] : h * h * fun_at(f, i, j);
+        }
+
+        // Set the boundary conditions
+        for (size_t i = 0; i < n; ++i)
+        {
+            uh[i] = fun_at(top_bc, 0, i);                      // Top boundary
+            uh[i * n + (n - 1)] = fun_at(right_bc, i, n - 1);  // Right boundary
+            uh[(n - 1) * n + i] = fun_at(bottom_bc, n - 1, i); // Bottom boundary
+            uh[i * n] = fun_at(left_bc, i, 0);                 // Left boundary
+        }
+
+        // The boundary values are known: move them to the equations of the neighbouring interior points,
+        // which leaves a problem with homogeneous Dirichlet data
+        equations = rhs_grid;
+        for (size_t k = 1; k < n - 1; ++k)
+        {
+            equations[n + k] += uh[k];
+            equations[(n - 2) * n + k] += uh[(n - 1) * n + k];
+            equations[k * n + 1] += uh[k * n];
+            equations[k * n + (n - 2)] += uh[k * n + (n - 1)];
+        }
+    }
+
+    bool Solver::rhs_factors(size_t first_row, size_t rows, std::vector<double> &f_x, std::vector<double> &f_y, MPI_Comm comm)
+    {
+        // The test costs rows x n evaluations once per f, evaluating f everywhere as much per iteration
+        if (!f_checked)
+        {
+            separable::Factors factors;
+            if (separable::detect(f, factors) && separable::verify(f, factors, n, first_row, rows))
+                f_factors = factors;
+            f_checked = true;
+        }
+
+        // Every rank saw only its slab: f is separable if it is on all of them
+        if (comm != MPI_COMM_NULL)
+        {
+            int separable_here = f_factors.has_value(), separable_everywhere = 0;
+            MPI_Allreduce(&separable_here, &separable_everywhere, 1, MPI_INT, MPI_LAND, comm);
+            if (!separable_everywhere)
+                f_factors.reset();
+        }
+
+        solver_stats.separable_rhs = f_factors.has_value();
+        if (!f_factors)
+            return false;
+
+        const double h = 1.0 / (n - 1);
+        separable::sample(*f_factors, n, first_row, rows, h * h, f_x, f_y);
+        return true;
+    }
+
+    std::vector<double> Solver::probe(const std::vector<double> &x, const std::vector<double> &y, probe::Method method) const
+    {
+        if (x.size() != y.size())
+        {
+            throw std::invalid_argument("The coordinates of the probe points must have the same size");
+        }
+
+        MPI_Comm mpi_comm = comm;
+        int mpi_rank, mpi_size;
+        MPI_Comm_rank(mpi_comm, &mpi_rank);
+        MPI_Comm_size(mpi_comm, &mpi_size);
+
+        if (mpi_size == 1)
+        {
+            std::vector<double> values(x.size());
+            probe::interpolate(uh.data(), n, 0, n, x.data(), y.data(), x.size(), method, values.data());
+            return values;
+        }
+
+        // Row slabs of the solution, with the halo needed by the stencils, scattered once per solution.
+        // A threaded solve may have changed the solution on rank 0 only, so the processes agree on the reuse
+        const std::vector<size_t> bounds = probe::partition(n, mpi_size);
+        std::vector<int> counts(mpi_size), start_idxs(mpi_size);
+        for (int r = 0; r < mpi_size; ++r)
+        {
+            size_t first_row, rows;
+            probe::held_rows(bounds, r, n, first_row, rows);
+            counts[r] = rows * n;
+            start_idxs[r] = first_row * n;
+        }
+        int cached = (probe_slab.size() == static_cast<size_t>(counts[mpi_rank])) ? 1 : 0;
+        MPI_Allreduce(MPI_IN_PLACE, &cached, 1, MPI_INT, MPI_LAND, mpi_comm);
+        if (!cached)
+        {
+            trace::Scope scope(trace::Phase::Scatter);
+            probe_slab.resize(counts[mpi_rank]);
+            MPI_Scatterv(uh.data(), counts.data(), start_idxs.data(), MPI_DOUBLE,
+                         probe_slab.data(), counts[mpi_rank], MPI_DOUBLE, 0, mpi_comm);
+        }
+
+        return probe::interpolate(probe_slab.data(), n, bounds, x, y, method, mpi_comm);
+    }
+
+    size_t Solver::save_vtk_pyramid(const std::string &filename, size_t min_size) const
+    {
+        MPI_Comm mpi_comm = comm;
+        int mpi_rank, mpi_size;
+        MPI_Comm_rank(mpi_comm, &mpi_rank);
+        MPI_Comm_size(mpi_comm, &mpi_size);
+
+        // Row slabs of the solution, without halo: the writer exchanges the rows it needs
+        const std::vector<size_t> bounds = probe::partition(n, mpi_size);
+        std::vector<int> counts(mpi_size), start_idxs(mpi_size);
+        for (int r = 0; r < mpi_size; ++r)
+        {
+            counts[r] = (bounds[r + 1] - bounds[r]) * n;
+            start_idxs[r] = bounds[r] * n;
+        }
+        std::vector<double> slab(counts[mpi_rank]);
+        {
+            trace::Scope scope(trace::Phase::Scatter);
+            MPI_Scatterv(uh.data(), counts.data(), start_idxs.data(), MPI_DOUBLE,
+                         slab.data(), counts[mpi_rank], MPI_DOUBLE, 0, mpi_comm);
+        }
+
+        if (mpi_rank == 0)
+        {
+            std::cout << "Saving solution pyramid to " << filename << ".vtk" << std::endl;
+            std::filesystem::create_directories("test/data");
+        }
+        MPI_Barrier(mpi_comm);
+        return pyramid::write(slab.data(), n, bounds, "test/data/" + filename, min_size, mpi_comm);
+    }
+
+    void Solver::save_heatmap(const std::string &filename, const render::Options &options) const
+    {
+        MPI_Comm mpi_comm = comm;
+        int mpi_rank, mpi_size;
+        MPI_Comm_rank(mpi_comm, &mpi_rank);
+        MPI_Comm_size(mpi_comm, &mpi_size);
+
+        // Row slabs of the solution, with the row below needed by the bilinear samples
+        const std::vector<size_t> bounds = probe::partition(n, mpi_size);
+        std::vector<int> counts(mpi_size), start_idxs(mpi_size);
+        for (int r = 0; r < mpi_size; ++r)
+        {
+            size_t first_row, rows;
+            probe::held_rows(bounds, r, n, first_row, rows);
+            counts[r] = rows * n;
+            start_idxs[r] = first_row * n;
+        }
+        std::vector<double> block(counts[mpi_rank]);
+        {
+            trace::Scope scope(trace::Phase::Scatter);
+            MPI_Scatterv(uh.data(), counts.data(), start_idxs.data(), MPI_DOUBLE,
+                         block.data(), counts[mpi_rank], MPI_DOUBLE, 0, mpi_comm);
+        }
+
+        if (mpi_rank == 0)
+            std::filesystem::create_directories("test/data");
+        MPI_Barrier(mpi_comm);
+        render::heatmap(block.data(), n, start_idxs[mpi_rank] / n, counts[mpi_rank] / n, bounds, options,
+                        "test/data/" + filename, mpi_comm);
+    }
+
+    std::vector<size_t> Solver::owned_rows(const std::vector<int> &start_idxs) const
+    {
+        // Every process but the first starts with a ghost row, and the slabs are contiguous
+        std::vector<size_t> bounds(start_idxs.size() + 1, n);
+        for (size_t r = 0; r < start_idxs.size(); ++r)
+            bounds[r] = start_idxs[r] / n + ((r > 0) ? 1 : 0);
+        return bounds;
+    }
+
+    void Solver::monitor(const double *local, const std::vector<int> &start_idxs, size_t local_rows, const std::string &suffix) const
+    {
+        int mpi_rank;
+        MPI_Comm_rank(comm, &mpi_rank);
+        if (mpi_rank == 0)
+            std::filesystem::create_directories("test/data");
+        MPI_Barrier(comm);
+        render::heatmap(local, n, start_idxs[mpi_rank] / n, local_rows, owned_rows(start_idxs), monitor_options,
+                        "test/data/" + monitor_name + "_" + suffix, comm);
+    }
+
+    telemetry::Publisher *Solver::start_telemetry(const std::string &method, int rank, int processes) const
+    {
+        if (!telemetry_publisher || rank != 0)
+            return nullptr;
+        telemetry_publisher->begin(method, n, processes, tol);
+        return telemetry_publisher.get();
+    }
+
+    void Solver::check_memory(const std::string &method, size_t local_rows, MPI_Comm comm, size_t threads)
+    {
+        // A solve called by another one is covered by the prediction of the outer solve
+        if (footprint::nested())
+            return;
+        solver_stats.footprint.predicted = footprint::predict(method, n, local_rows, static_cast<unsigned>(threads), recycle);
+        if (memory_check)
+            footprint::check(method, solver_stats.footprint.predicted, comm);
+    }
+
+    const reduction::Allreduce &Solver::reducer()
+    {
+        // The communicators and the window are built on the first reduction on a communicator
+        if (!residual_reduction || residual_reduction->communicator() != comm)
+            residual_reduction = std::make_shared<reduction::Allreduce>(comm, reduction_algorithm, reduction_node_size);
+        return *residual_reduction;
+    }
+
+    void Solver::decompose(int mpi_size, std::vector<int> &counts, std::vector<int> &start_idxs) const
+    {
+        // Compute these two quantities to divide the work among processes
+        unsigned int count = n / mpi_size;
+        int remainder = n - count * mpi_size;
+
+        // Number of elements sent to (and received from) each processor,
+        // and offset index where to start reading/writing them from.
+        counts.assign(mpi_size, 0);
+        start_idxs.assign(mpi_size, 0);
+
+        if (mpi_size > 1)
+        {
+            // The first and last processors will have only one extra row,
+            // while the others will have two ghost rows.
+            unsigned start_idx{0};
+
+            counts[0] = ((0 < remainder) ? (count + 1 + 1) : count + 1) * n;
+            start_idxs[0] = 0;
+            start_idx = counts[0] - 2 * n;
+
+            for (int i = 1; i < mpi_size - 1; ++i)
+            {
+                counts[i] = ((i < remainder) ? (count + 1 + 2) : count + 2) * n;
+                start_idxs[i] = start_idx;
+                start_idx += counts[i] - 2 * n; // consider repetition of ghost row
+            }
+            counts[mpi_size - 1] = ((mpi_size - 1 < remainder) ? (count + 1 + 1) : count + 1) * n;
+            start_idxs[mpi_size - 1] = start_idx;
+        }
+        else
+        {
+            // We handle the case with only one process separately
+            counts[0] = n * n; // Only one process, all data
+            start_idxs[0] = 0;
+        }
+    }
+
+    void Solver::run_parallel(const std::function<void(unsigned, unsigned, const std::function<void()> &)> &worker) const
+    {
+#ifdef _OPENMP
+        if (thread_backend == ThreadBackend::OpenMP)
+        {
+            const std::function<void()> barrier = []
+            {
+#pragma omp barrier
+            };
+#pragma omp parallel num_threads(num_threads)
+            worker(omp_get_thread_num(), omp_get_num_threads(), barrier);
+            return;
+        }
+#endif
+        ThreadPool &pool = ThreadPool::instance();
+        const std::function<void()> barrier = [&pool]
+        { pool.barrier(); };
+        pool.run(num_threads, [&](unsigned thread_id, unsigned team_size)
+                 { worker(thread_id, team_size, barrier); });
+    }
+
+    double Solver::compute_error_serial(const grid_type &sol1, const grid_type &sol2, unsigned rows, unsigned cols) const
+    {
+        double error{0.0};
+        for (unsigned i = 0; i < rows; ++i)
+        {
+            error += kernels::squared_difference(&sol1[i * n], &sol2[i * n], cols);
+        }
+        error = std::sqrt(1.0 / (n - 1) * error);
+        return error;
+    }
+
+    double Solver::compute_error_omp(const grid_type &sol1, const grid_type &sol2, unsigned rows, unsigned cols) const
+    {
+        double error{0.0};
+#ifdef _OPENMP
+        int num_threads = omp_get_num_threads();
+#pragma omp barrier
+#pragma omp parallel for schedule(static) reduction(+ : error) num_threads(num_threads)
+#endif
+        for (unsigned i = 0; i < rows; ++i)
+        {
+            error += kernels::squared_difference(&sol1[i * n], &sol2[i * n], cols);
         }
         error = std::sqrt(1.0 / (n - 1) * error);
         return error;
     }
 
-    double Solver::compute_error_serial(const std::vector<double> &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const
+    double Solver::compute_error_serial(const grid_type &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const
     {
         double error{0.0};
         for (unsigned i = 0; i < rows; ++i)
@@ -864,7 +2273,7 @@ namespace solver
         return error;
     }
 
-    double Solver::compute_error_omp(const std::vector<double> &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const
+    double Solver::compute_error_omp(const grid_type &sol1, const std::function<double(std::vector<double>)> &sol2, unsigned rows, unsigned cols) const
     {
         double error{0.0};
 #ifdef _OPENMP
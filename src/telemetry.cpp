@@ -0,0 +1,199 @@
+/// @file telemetry.cpp
+/// @brief This file contains the implementation of the shared-memory telemetry publisher and reader.
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <mpi.h>
+
+#include "telemetry.hpp"
+
+namespace solver::telemetry
+{
+    namespace
+    {
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+                      "the atomics shared between processes must be lock-free");
+
+        /// @brief offset of the first slot, rounded to a cache line
+        constexpr size_t slots_offset = (sizeof(Header) + 63) / 64 * 64;
+
+        /// @brief size of a segment with the given number of slots
+        size_t segment_size(size_t capacity)
+        {
+            return slots_offset + capacity * sizeof(Slot);
+        }
+
+        /// @brief error of a system call, with the description of errno
+        std::runtime_error system_error(const std::string &what, const std::string &name)
+        {
+            return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+        }
+    }
+
+    std::string segment_name(const std::string &name)
+    {
+        return (!name.empty() && name[0] == '/') ? name : "/" + name;
+    }
+
+    Publisher::Publisher(const std::string &name, size_t capacity)
+        : segment(segment_name(name)), bytes(segment_size(capacity))
+    {
+        if (capacity == 0)
+            throw std::runtime_error("telemetry: the capacity of " + segment + " must be positive");
+
+        // A stale segment of a previous run is replaced, so that its readers see it closed
+        shm_unlink(segment.c_str());
+        const int fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            throw system_error("telemetry: cannot create", segment);
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            close(fd);
+            shm_unlink(segment.c_str());
+            throw system_error("telemetry: cannot size", segment);
+        }
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            shm_unlink(segment.c_str());
+            throw system_error("telemetry: cannot map", segment);
+        }
+
+        header = new (mapping) Header{0, version, static_cast<std::uint32_t>(capacity), sizeof(Slot), {0}, {0}};
+        slots = reinterpret_cast<Slot *>(static_cast<char *>(mapping) + slots_offset);
+        for (size_t s = 0; s < capacity; ++s)
+            new (&slots[s]) Slot{{0}, {}};
+
+        // The magic number is written last: a reader never sees a segment being initialized as valid
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = magic;
+
+        trace::accumulating.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Publisher::~Publisher()
+    {
+        trace::accumulating.fetch_sub(1, std::memory_order_relaxed);
+        header->closed.store(1, std::memory_order_release);
+        munmap(header, bytes);
+        shm_unlink(segment.c_str());
+    }
+
+    void Publisher::begin(const std::string &method, size_t n, int processes, double tolerance)
+    {
+        current = Sample{};
+        current.solve = solves++;
+        current.tolerance = tolerance;
+        current.n = static_cast<std::uint32_t>(n);
+        current.processes = static_cast<std::uint32_t>(processes);
+        method.copy(current.method, sizeof(current.method) - 1);
+        start = MPI_Wtime();
+        first_time = -1.0;
+    }
+
+    void Publisher::publish(size_t iteration, double residual)
+    {
+        const double now = MPI_Wtime();
+
+        // The phases are counted from the first sample, on the thread that publishes (which may
+        // not be the one that called begin, with the thread pool)
+        if (first_time < 0.0)
+        {
+            first_time = now;
+            first_residual = residual;
+            std::copy(trace::phase_seconds, trace::phase_seconds + trace::phase_count, baseline);
+        }
+
+        current.iteration = iteration;
+        current.residual = residual;
+        current.elapsed = now - start;
+        for (size_t p = 0; p < trace::phase_count; ++p)
+            current.phase_seconds[p] = trace::phase_seconds[p] - baseline[p];
+
+        // Time to reduce the residual to the tolerance at the mean rate observed so far
+        current.eta = -1.0;
+        if (residual < current.tolerance)
+            current.eta = 0.0;
+        else if (current.tolerance > 0.0 && residual < first_residual && now > first_time)
+            current.eta = std::log(residual / current.tolerance) * (now - first_time) / std::log(first_residual / residual);
+
+        // Seqlock write: odd sequence, payload, even sequence, then the head
+        const std::uint64_t index = header->head.load(std::memory_order_relaxed);
+        Slot &slot = slots[index % header->capacity];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.sample, &current, sizeof(Sample));
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        header->head.store(index + 1, std::memory_order_release);
+    }
+
+    Reader::Reader(const std::string &name)
+    {
+        const std::string segment = segment_name(name);
+        const int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            throw system_error("telemetry: cannot open", segment);
+        struct stat status;
+        if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < slots_offset)
+        {
+            close(fd);
+            throw std::runtime_error("telemetry: " + segment + " is not a telemetry segment");
+        }
+        bytes = static_cast<size_t>(status.st_size);
+        void *mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+            throw system_error("telemetry: cannot map", segment);
+
+        header = static_cast<const Header *>(mapping);
+        slots = reinterpret_cast<const Slot *>(static_cast<const char *>(mapping) + slots_offset);
+        const bool valid = header->magic == magic && header->version == version && header->slot_size == sizeof(Slot) &&
+                           header->capacity > 0 && bytes >= segment_size(header->capacity);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!valid)
+        {
+            munmap(mapping, bytes);
+            throw std::runtime_error("telemetry: " + segment + " is not a telemetry segment (or is being created)");
+        }
+    }
+
+    Reader::~Reader()
+    {
+        munmap(const_cast<Header *>(header), bytes);
+    }
+
+    std::uint64_t Reader::head() const
+    {
+        return header->head.load(std::memory_order_acquire);
+    }
+
+    size_t Reader::capacity() const
+    {
+        return header->capacity;
+    }
+
+    bool Reader::closed() const
+    {
+        return header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    bool Reader::read(std::uint64_t index, Sample &sample) const
+    {
+        // Seqlock read: the copy is valid if the sequence was even before it and unchanged after it
+        const Slot &slot = slots[index % header->capacity];
+        const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2)
+            return false;
+        std::memcpy(&sample, &slot.sample, sizeof(Sample));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+} // namespace solver::telemetry
@@ -0,0 +1,135 @@
+/// @file thread_pool.cpp
+/// @brief This file contains the implementation of the ThreadPool class.
+/// @details Workers sleep on a condition variable and are woken up at the start of
+///          each region; the end of the region is detected with a std::latch.
+
+#include <algorithm>
+
+#include "thread_pool.hpp"
+
+namespace solver
+{
+    namespace
+    {
+        /// @brief barrier of the team the calling thread belongs to (nullptr outside a region)
+        thread_local std::barrier<> *current_barrier = nullptr;
+
+        /// @brief true on the threads currently executing a job
+        thread_local bool inside_region = false;
+
+        /// @brief execute job(thread_id, num_threads) as a member of a team with the given barrier
+        void execute(const std::function<void(unsigned, unsigned)> &job, unsigned thread_id, unsigned num_threads, std::barrier<> *sync)
+        {
+            std::barrier<> *saved_barrier = current_barrier;
+            const bool saved_inside = inside_region;
+            current_barrier = sync;
+            inside_region = true;
+            job(thread_id, num_threads);
+            current_barrier = saved_barrier;
+            inside_region = saved_inside;
+        }
+    }
+
+    ThreadPool::ThreadPool(unsigned num_workers)
+    {
+        for (unsigned id = 0; id < num_workers; ++id)
+            workers.emplace_back(&ThreadPool::worker_loop, this, id);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake_up.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool &ThreadPool::instance()
+    {
+        static ThreadPool pool(default_threads() - 1);
+        return pool;
+    }
+
+    unsigned ThreadPool::default_threads()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    void ThreadPool::run(unsigned num_threads, const std::function<void(unsigned, unsigned)> &job)
+    {
+        num_threads = std::max(1u, num_threads);
+
+        // Nested regions (or a team of one) are executed by the calling thread only
+        if (inside_region || num_threads == 1)
+        {
+            execute(job, 0, 1, nullptr);
+            return;
+        }
+
+        std::lock_guard<std::mutex> region_lock(region_mutex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Create the missing workers
+            for (unsigned id = static_cast<unsigned>(workers.size()); id + 1 < num_threads; ++id)
+                workers.emplace_back(&ThreadPool::worker_loop, this, id);
+
+            this->job = &job;
+            team_size = num_threads;
+            team_barrier = std::make_unique<std::barrier<>>(num_threads);
+            finished = std::make_unique<std::latch>(num_threads - 1);
+            ++generation;
+        }
+        wake_up.notify_all();
+
+        // The calling thread is thread 0 of the team
+        execute(job, 0, num_threads, team_barrier.get());
+
+        finished->wait();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = nullptr;
+        team_barrier.reset();
+        finished.reset();
+    }
+
+    void ThreadPool::barrier()
+    {
+        if (current_barrier != nullptr)
+            current_barrier->arrive_and_wait();
+    }
+
+    void ThreadPool::worker_loop(unsigned id)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            const std::function<void(unsigned, unsigned)> *current_job;
+            unsigned current_size;
+            std::barrier<> *current_sync;
+            std::latch *current_finished;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake_up.wait(lock, [&]
+                             { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                current_job = job;
+                current_size = team_size;
+                current_sync = team_barrier.get();
+                current_finished = finished.get();
+            }
+
+            // Workers beyond the size of the team skip this region
+            if (id + 1 < current_size)
+            {
+                execute(*current_job, id + 1, current_size, current_sync);
+                current_finished->count_down();
+            }
+        }
+    }
+}
@@ -0,0 +1,200 @@
+/// @file tiled.cpp
+/// @brief This file contains the implementation of the tiled grids and of their kernels.
+
+#include <algorithm>
+#include <atomic>
+
+#include "tiled.hpp"
+
+namespace solver::tiled
+{
+    namespace
+    {
+        /// @brief values of a cache line
+        constexpr size_t line = 64 / sizeof(double);
+
+        /// @brief number of grids built, to skew each grid by a different number of cache lines
+        std::atomic<size_t> grids_built{0};
+    }
+
+    Grid::Grid(size_t n, size_t tile, Order order)
+        : n(n), shift(2), tile_order(order)
+    {
+        // Tiles of at least 4 x 4 values, so that a tile has interior points and an even side
+        while ((size_t{1} << shift) < tile)
+            ++shift;
+        const size_t side = size_t{1} << shift;
+        mask = side - 1;
+        per_side = (n + mask) >> shift;
+
+        sequence.reserve(per_side * per_side);
+        for (std::uint32_t I = 0; I < per_side; ++I)
+            for (std::uint32_t J = 0; J < per_side; ++J)
+                sequence.emplace_back(I, J);
+        if (order == Order::Morton)
+            std::sort(sequence.begin(), sequence.end(), [](const auto &a, const auto &b)
+                      { return morton_key(a.first, a.second) < morton_key(b.first, b.second); });
+
+        // The grids read together by a kernel have the same tiles at the same offsets: skewed by
+        // 0 to 7 times 17 cache lines, their tiles do not all start in the same cache sets
+        const size_t skew = (grids_built++ % 8) * 17 * line;
+        start.resize(per_side * per_side);
+        for (size_t t = 0; t < sequence.size(); ++t)
+            start[sequence[t].first * per_side + sequence[t].second] = skew + t * side * side;
+        values.assign(skew + sequence.size() * side * side, 0.0);
+    }
+
+    void Grid::from_natural(const double *natural)
+    {
+        // Row segments of a tile are contiguous in both layouts
+        const size_t side = tile();
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; j += side)
+                std::copy(natural + i * n + j, natural + i * n + std::min(n, j + side), &values[index(i, j)]);
+    }
+
+    void Grid::to_natural(double *natural) const
+    {
+        const size_t side = tile();
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; j += side)
+            {
+                const double *segment = &values[index(i, j)];
+                std::copy(segment, segment + std::min(side, n - j), natural + i * n + j);
+            }
+    }
+
+    double jacobi_sweep(const Grid &u, Grid &next, const Grid &rhs)
+    {
+        const size_t n = u.size(), side = u.tile();
+        double diff{0.0};
+        for (const auto &[I, J] : u.storage_order())
+        {
+            const double *tile = u.tile_data(I, J);
+            const double *f = rhs.tile_data(I, J);
+            double *out = next.tile_data(I, J);
+
+            // Interior points of the tile: 1 <= i, j <= n - 2
+            const size_t i0 = I * side, j0 = J * side;
+            const size_t r_begin = (i0 == 0) ? 1 : 0, r_end = std::min(side, n - 1 - i0);
+            const size_t c_begin = (j0 == 0) ? 1 : 0, c_end = std::min(side, n - 1 - j0);
+
+            // Columns next to the tiles on the left and on the right (if the tile has points there)
+            const double *left_tile = (c_begin == 0) ? u.tile_data(I, J - 1) : nullptr;
+            const double *right_tile = (c_end == side) ? u.tile_data(I, J + 1) : nullptr;
+
+            for (size_t r = r_begin; r < r_end; ++r)
+            {
+                // The rows above and below the tile are the last and first rows of the tiles there
+                const double *__restrict row = tile + r * side;
+                const double *__restrict above = (r > 0) ? row - side : u.tile_data(I - 1, J) + (side - 1) * side;
+                const double *__restrict below = (r + 1 < side) ? row + side : u.tile_data(I + 1, J);
+                const double *__restrict source = f + r * side;
+                double *__restrict target = out + r * side;
+
+                auto update = [&](size_t c, double left, double right)
+                {
+                    const double value = 0.25 * (above[c] + below[c] + left + right + source[c]);
+                    const double delta = value - row[c];
+                    diff += delta * delta;
+                    target[c] = value;
+                };
+
+                if (c_begin == 0 && c_end > 0)
+                    update(0, left_tile[r * side + side - 1], row[1]);
+                const size_t inner_end = std::min(c_end, side - 1);
+                double inner_diff{0.0};
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : inner_diff)
+#endif
+                for (size_t c = std::max<size_t>(c_begin, 1); c < inner_end; ++c)
+                {
+                    const double value = 0.25 * (above[c] + below[c] + row[c - 1] + row[c + 1] + source[c]);
+                    const double delta = value - row[c];
+                    inner_diff += delta * delta;
+                    target[c] = value;
+                }
+                diff += inner_diff;
+                if (c_end == side)
+                    update(side - 1, row[side - 2], right_tile[r * side]);
+            }
+        }
+        return diff;
+    }
+
+    void restrict_full_weighting(const Grid &fine, Grid &coarse)
+    {
+        const size_t nc = coarse.size(), side = coarse.tile(), fine_mask = fine.tile() - 1;
+        for (const auto &[I, J] : coarse.storage_order())
+        {
+            double *tile = coarse.tile_data(I, J);
+            const size_t i0 = I * side, j0 = J * side;
+            const size_t r_end = std::min(side, nc - i0), c_end = std::min(side, nc - j0);
+            for (size_t r = 0; r < r_end; ++r)
+            {
+                const size_t ci = i0 + r;
+                double *target = tile + r * side;
+                for (size_t c = 0; c < c_end;)
+                {
+                    const size_t cj = j0 + c, fi = 2 * ci, fj = 2 * cj;
+                    if (ci == 0 || ci == nc - 1 || cj == 0 || cj == nc - 1)
+                    {
+                        // The boundary is injected
+                        target[c++] = fine(fi, fj);
+                        continue;
+                    }
+
+                    // Coarse points whose fine point lies in the same fine tile: their three fine
+                    // rows are contiguous there, only the left neighbour of the first may not be
+                    const size_t end = std::min({c_end, ((fj | fine_mask) + 1) / 2 - j0, nc - 1 - j0});
+                    const double *above = fine.data() + fine.index(fi - 1, fj);
+                    const double *middle = fine.data() + fine.index(fi, fj);
+                    const double *below = fine.data() + fine.index(fi + 1, fj);
+                    double left_above = fine(fi - 1, fj - 1), left = fine(fi, fj - 1), left_below = fine(fi + 1, fj - 1);
+                    for (size_t k = 0; c < end; ++c, k += 2)
+                    {
+                        target[c] = 0.0625 * (4.0 * middle[k] + 2.0 * (above[k] + below[k] + left + middle[k + 1]) +
+                                              left_above + above[k + 1] + left_below + below[k + 1]);
+                        left_above = above[k + 1];
+                        left = middle[k + 1];
+                        left_below = below[k + 1];
+                    }
+                }
+            }
+        }
+    }
+
+    void prolong_bilinear(const Grid &coarse, Grid &fine)
+    {
+        const size_t n = fine.size(), side = fine.tile(), half = side / 2;
+
+        // Coarse values under a row of a fine tile, interpolated between two coarse rows for odd rows
+        std::vector<double> row_values(half + 1);
+        for (const auto &[I, J] : fine.storage_order())
+        {
+            double *tile = fine.tile_data(I, J);
+            const size_t i0 = I * side, j0 = J * side;
+            const size_t r_begin = (i0 == 0) ? 1 : 0, r_end = std::min(side, n - 1 - i0);
+            const size_t c_begin = (j0 == 0) ? 1 : 0, c_end = std::min(side, n - 1 - j0);
+
+            // Coarse columns j0 / 2, ..., j0 / 2 + half: the first half are contiguous in a coarse
+            // tile, the last one may be in the next (its coarse column is at most the last one)
+            const size_t cj0 = j0 / 2, count = std::min(half + 1, coarse.size() - cj0);
+            for (size_t r = r_begin; r < r_end; ++r)
+            {
+                const size_t fi = i0 + r;
+                const size_t ci_top = fi / 2, ci_bottom = (fi + 1) / 2;
+                const double *top = coarse.data() + coarse.index(ci_top, cj0);
+                const double *bottom = coarse.data() + coarse.index(ci_bottom, cj0);
+                for (size_t q = 0; q < std::min(count, half); ++q)
+                    row_values[q] = 0.5 * (top[q] + bottom[q]);
+                if (count > half)
+                    row_values[half] = 0.5 * (coarse(ci_top, cj0 + half) + coarse(ci_bottom, cj0 + half));
+
+                double *target = tile + r * side;
+                for (size_t c = c_begin; c < c_end; ++c)
+                    target[c] += (c & 1) ? 0.5 * (row_values[c / 2] + row_values[c / 2 + 1]) : row_values[c / 2];
+            }
+        }
+    }
+} // namespace solver::tiled
@@ -0,0 +1,120 @@
+/// @file topology.cpp
+/// @brief This file contains the implementation of the topology-aware ordering of the ranks.
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "topology.hpp"
+
+namespace solver::topology
+{
+    Reorder parse(const std::string &name)
+    {
+        if (name == "none")
+            return Reorder::None;
+        if (name == "node")
+            return Reorder::NodeMajor;
+        if (name == "cart")
+            return Reorder::Cartesian;
+        if (name == "graph")
+            return Reorder::Graph;
+        throw std::invalid_argument("Unknown rank ordering: " + name + " (none, node, cart or graph)");
+    }
+
+    std::vector<int> nodes(MPI_Comm comm, int emulated_nodes)
+    {
+        int rank, size, world_rank;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+        int node;
+        if (emulated_nodes > 0)
+            node = world_rank % emulated_nodes;
+        else
+        {
+            // The first rank of the shared-memory sub-communicator names the node
+            MPI_Comm shared;
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &shared);
+            node = world_rank;
+            MPI_Bcast(&node, 1, MPI_INT, 0, shared);
+            MPI_Comm_free(&shared);
+        }
+
+        std::vector<int> all(size);
+        MPI_Allgather(&node, 1, MPI_INT, all.data(), 1, MPI_INT, comm);
+        return all;
+    }
+
+    MPI_Comm reorder(MPI_Comm comm, Reorder method, int emulated_nodes)
+    {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        MPI_Comm ordered;
+        switch (method)
+        {
+        case Reorder::NodeMajor:
+        {
+            // Nodes in the order of their first rank, ranks of a node in their order (stable sort)
+            const std::vector<int> node = nodes(comm, emulated_nodes);
+            std::vector<int> first_rank(size);
+            for (int r = 0; r < size; ++r)
+                first_rank[r] = static_cast<int>(std::find(node.begin(), node.end(), node[r]) - node.begin());
+            std::vector<int> order(size);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                             { return first_rank[a] < first_rank[b]; });
+            const int position = static_cast<int>(std::find(order.begin(), order.end(), rank) - order.begin());
+            MPI_Comm_split(comm, 0, position, &ordered);
+            break;
+        }
+        case Reorder::Cartesian:
+        {
+            int dims[1] = {size}, periods[1] = {0};
+            MPI_Cart_create(comm, 1, dims, periods, 1, &ordered);
+            break;
+        }
+        case Reorder::Graph:
+        {
+            // Slab i is a node of the graph linked to slabs i - 1 and i + 1; the process that gets
+            // rank i of the new communicator is the one the library places best for slab i
+            std::vector<int> index(size), edges;
+            for (int i = 0; i < size; ++i)
+            {
+                if (i > 0)
+                    edges.push_back(i - 1);
+                if (i < size - 1)
+                    edges.push_back(i + 1);
+                index[i] = static_cast<int>(edges.size());
+            }
+            MPI_Graph_create(comm, size, index.data(), edges.data(), 1, &ordered);
+            break;
+        }
+        default:
+            MPI_Comm_dup(comm, &ordered);
+        }
+        return ordered;
+    }
+
+    Traffic halo_traffic(MPI_Comm comm, size_t n, int emulated_nodes)
+    {
+        // Slabs r and r + 1 exchange one row of n doubles in each direction per iteration
+        const std::vector<int> node = nodes(comm, emulated_nodes);
+        const double bytes = 2.0 * n * sizeof(double);
+        Traffic traffic;
+        for (size_t r = 0; r + 1 < node.size(); ++r)
+        {
+            if (node[r] == node[r + 1])
+                traffic.intra_bytes += bytes;
+            else
+            {
+                traffic.inter_bytes += bytes;
+                ++traffic.inter_neighbours;
+            }
+        }
+        return traffic;
+    }
+} // namespace solver::topology
@@ -0,0 +1,259 @@
+/// @file trace.cpp
+/// @brief This file contains the implementation of the event tracer.
+/// @details Each thread owns a buffer registered on its first event; the registry keeps
+///          the buffers alive until the events are written, so that they survive the
+///          threads of an OpenMP region.
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "trace.hpp"
+
+namespace solver::trace
+{
+    std::atomic<bool> enabled{false};
+    std::atomic<unsigned> accumulating{0};
+    thread_local double phase_seconds[phase_count] = {};
+    std::atomic<double> team_phase_seconds[phase_count] = {};
+
+    namespace
+    {
+        /// @brief events of one thread
+        struct ThreadBuffer
+        {
+            std::vector<Event> events;
+            unsigned id = 0;
+            size_t dropped = 0;
+        };
+
+        /// @brief buffers of all the threads of the process
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        /// @brief protects the registration of the buffers
+        std::mutex registry_mutex;
+
+        /// @brief maximum number of events per thread
+        size_t buffer_capacity = 0;
+
+        /// @brief counter of the recordings, used to detect the stale buffers of a previous one
+        uint64_t generation = 0;
+
+        /// @brief offset of the local clock with respect to the clock of rank 0 (seconds)
+        double clock_offset = 0.0;
+
+        /// @brief time of rank 0 at which the recording started, origin of the timeline
+        double origin = 0.0;
+
+        /// @brief buffer of the calling thread
+        thread_local ThreadBuffer *local_buffer = nullptr;
+
+        /// @brief recording the buffer of the calling thread belongs to
+        thread_local uint64_t local_generation = 0;
+
+        /// @brief number of ping-pongs used to estimate each clock offset
+        constexpr int clock_rounds = 8;
+
+        /// @brief estimate the offset of the clock of every process with respect to rank 0
+        /// @details rank 0 pings every other rank and keeps the round trip with the smallest
+        ///          latency; the remote time is assumed to be read halfway through it
+        double estimate_clock_offset(MPI_Comm comm)
+        {
+            int rank, size;
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+
+            double offset = 0.0;
+            if (rank == 0)
+            {
+                for (int r = 1; r < size; ++r)
+                {
+                    double best_rtt = -1.0, best_offset = 0.0;
+                    for (int round = 0; round < clock_rounds; ++round)
+                    {
+                        double remote;
+                        const double t0 = MPI_Wtime();
+                        MPI_Send(&t0, 1, MPI_DOUBLE, r, 0, comm);
+                        MPI_Recv(&remote, 1, MPI_DOUBLE, r, 0, comm, MPI_STATUS_IGNORE);
+                        const double t1 = MPI_Wtime();
+                        if (best_rtt < 0.0 || t1 - t0 < best_rtt)
+                        {
+                            best_rtt = t1 - t0;
+                            best_offset = remote - 0.5 * (t0 + t1);
+                        }
+                    }
+                    MPI_Send(&best_offset, 1, MPI_DOUBLE, r, 1, comm);
+                }
+            }
+            else
+            {
+                for (int round = 0; round < clock_rounds; ++round)
+                {
+                    double ping;
+                    MPI_Recv(&ping, 1, MPI_DOUBLE, 0, 0, comm, MPI_STATUS_IGNORE);
+                    const double now = MPI_Wtime();
+                    MPI_Send(&now, 1, MPI_DOUBLE, 0, 0, comm);
+                }
+                MPI_Recv(&offset, 1, MPI_DOUBLE, 0, 1, comm, MPI_STATUS_IGNORE);
+            }
+            return offset;
+        }
+
+        /// @brief get the buffer of the calling thread, registering it if needed
+        ThreadBuffer *thread_buffer()
+        {
+            if (local_buffer == nullptr || local_generation != generation)
+            {
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                auto buffer = std::make_unique<ThreadBuffer>();
+                buffer->id = static_cast<unsigned>(buffers.size());
+                buffer->events.reserve(buffer_capacity);
+                local_buffer = buffer.get();
+                local_generation = generation;
+                buffers.push_back(std::move(buffer));
+            }
+            return local_buffer;
+        }
+    }
+
+    const char *phase_name(Phase phase)
+    {
+        switch (phase)
+        {
+        case Phase::Scatter:
+            return "scatter";
+        case Phase::Sweep:
+            return "sweep";
+        case Phase::Exchange:
+            return "exchange";
+        case Phase::Reduction:
+            return "reduction";
+        case Phase::Gather:
+            return "gather";
+        case Phase::Solve:
+            return "solve";
+        }
+        return "unknown";
+    }
+
+    void start(MPI_Comm comm, size_t capacity)
+    {
+        enabled = false;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            buffers.clear();
+            buffer_capacity = capacity;
+            ++generation;
+        }
+
+        clock_offset = estimate_clock_offset(comm);
+
+        // The timeline starts when all the processes are ready
+        MPI_Barrier(comm);
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+        origin = (rank == 0) ? MPI_Wtime() : 0.0;
+        MPI_Bcast(&origin, 1, MPI_DOUBLE, 0, comm);
+
+        enabled = true;
+    }
+
+    void record(Phase phase, double begin, double end)
+    {
+        ThreadBuffer *buffer = thread_buffer();
+        if (buffer->events.size() < buffer_capacity)
+            buffer->events.push_back({begin, end, buffer->id, phase});
+        else
+            ++buffer->dropped;
+    }
+
+    std::vector<Event> local_events()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::vector<Event> events;
+        for (const auto &buffer : buffers)
+            events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+        return events;
+    }
+
+    size_t write(const std::string &filename, MPI_Comm comm)
+    {
+        enabled = false;
+
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        // Pack the local events as (begin, end, thread, phase) on the clock of rank 0
+        std::vector<double> packed;
+        unsigned long dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (const auto &buffer : buffers)
+            {
+                dropped += buffer->dropped;
+                for (const Event &event : buffer->events)
+                {
+                    packed.push_back(event.begin - clock_offset - origin);
+                    packed.push_back(event.end - clock_offset - origin);
+                    packed.push_back(static_cast<double>(event.thread));
+                    packed.push_back(static_cast<double>(static_cast<unsigned>(event.phase)));
+                }
+            }
+        }
+
+        // Gather the events on rank 0
+        int local_count = static_cast<int>(packed.size());
+        std::vector<int> counts(size, 0), displs(size, 0);
+        MPI_Gather(&local_count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+        for (int r = 1; r < size; ++r)
+            displs[r] = displs[r - 1] + counts[r - 1];
+        std::vector<double> all;
+        if (rank == 0)
+            all.resize(displs[size - 1] + counts[size - 1]);
+        MPI_Gatherv(packed.data(), local_count, MPI_DOUBLE, all.data(), counts.data(), displs.data(), MPI_DOUBLE, 0, comm);
+
+        unsigned long total_dropped = 0;
+        MPI_Reduce(&dropped, &total_dropped, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, comm);
+
+        if (rank != 0)
+            return 0;
+
+        std::ofstream ofs(filename);
+        if (!ofs)
+        {
+            std::cerr << "Error: cannot open " << filename << " for writing." << std::endl;
+            return 0;
+        }
+
+        // Chrome trace format: one complete ("X") event per phase, timestamps in microseconds
+        ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        ofs << std::fixed << std::setprecision(3);
+        bool first = true;
+        size_t written = 0;
+        for (int r = 0; r < size; ++r)
+        {
+            ofs << (first ? "" : ",\n") << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << r
+                << ",\"args\":{\"name\":\"rank " << r << "\"}}";
+            first = false;
+            for (int k = displs[r]; k < displs[r] + counts[r]; k += 4)
+            {
+                const double begin = all[k] * 1e6;
+                const double duration = (all[k + 1] - all[k]) * 1e6;
+                ofs << ",\n{\"name\":\"" << phase_name(static_cast<Phase>(static_cast<unsigned>(all[k + 3])))
+                    << "\",\"ph\":\"X\",\"pid\":" << r << ",\"tid\":" << static_cast<unsigned>(all[k + 2])
+                    << ",\"ts\":" << begin << ",\"dur\":" << duration << "}";
+                ++written;
+            }
+        }
+        ofs << "\n]}\n";
+
+        std::cout << "Trace with " << written << " events written to " << filename << std::endl;
+        if (total_dropped > 0)
+            std::cout << "Warning: " << total_dropped << " events dropped, increase the capacity of the tracer." << std::endl;
+        return written;
+    }
+} // namespace solver::trace
@@ -0,0 +1,244 @@
+/// @file tuner.cpp
+/// @brief This file contains the implementation of the Tuner class.
+/// @details The cache is a CSV file with one line per tuned problem; it is read and
+///          written by the first process of the communicator only, and the chosen
+///          configuration is broadcast to the others.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cstdint>
+
+#include "tuner.hpp"
+#include "quiet_cout.hpp"
+
+namespace solver
+{
+    namespace
+    {
+        /// @brief first line of /proc/cpuinfo or /proc/meminfo starting with key, without the key
+        std::string proc_field(const std::string &file, const std::string &key)
+        {
+            std::ifstream ifs(file);
+            std::string line;
+            while (std::getline(ifs, line))
+            {
+                if (line.rfind(key, 0) == 0)
+                {
+                    size_t colon = line.find(':');
+                    return (colon == std::string::npos) ? line : line.substr(colon + 1);
+                }
+            }
+            return "";
+        }
+
+        /// @brief content of a small sysfs file, without the trailing newline
+        std::string sysfs_value(const std::string &file)
+        {
+            std::ifstream ifs(file);
+            std::string value;
+            std::getline(ifs, value);
+            return value;
+        }
+
+        /// @brief 64-bit FNV-1a hash
+        uint64_t fnv1a(const std::string &text)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (unsigned char c : text)
+            {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    std::string Tuner::hardware_fingerprint()
+    {
+        // Same fields as docs/generate_hw_info.sh
+        std::ostringstream fields;
+        fields << "model name=" << proc_field("/proc/cpuinfo", "model name") << ";"
+               << "cpu cores=" << proc_field("/proc/cpuinfo", "cpu cores") << ";"
+               << "logical=" << std::thread::hardware_concurrency() << ";";
+        for (int index = 0; index < 4; ++index)
+            fields << "cache" << index << "=" << sysfs_value("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size") << ";";
+        fields << "MemTotal=" << proc_field("/proc/meminfo", "MemTotal") << ";";
+
+        std::ostringstream hex;
+        hex << std::hex << std::setw(16) << std::setfill('0') << fnv1a(fields.str());
+        return hex.str();
+    }
+
+    void Tuner::apply(Solver &solver, const TuningConfig &config)
+    {
+        solver.set_num_threads(config.num_threads);
+        solver.set_thread_backend(config.backend);
+        solver.set_tile_rows(config.tile_rows);
+    }
+
+    bool Tuner::lookup(const std::string &fingerprint, const TuningKey &key, TuningConfig &config) const
+    {
+        std::ifstream ifs(cache_file);
+        std::string line;
+        bool found = false;
+        while (std::getline(ifs, line))
+        {
+            std::istringstream iss(line);
+            std::vector<std::string> fields;
+            std::string field;
+            while (std::getline(iss, field, ','))
+                fields.push_back(field);
+            if (fields.size() != 10 || fields[0] == "fingerprint")
+                continue;
+
+            if (fields[0] == fingerprint && fields[1] == key.method && std::stoul(fields[2]) == key.n &&
+                std::stoi(fields[3]) == key.ranks && std::stoul(fields[4]) == key.threads)
+            {
+                // The last entry wins, so that a re-tuning overrides the previous one
+                config.num_threads = std::stoul(fields[5]);
+                config.backend = (fields[6] == "openmp") ? ThreadBackend::OpenMP : ThreadBackend::Native;
+                config.overlap = (fields[7] == "1");
+                config.tile_rows = std::stoul(fields[8]);
+                config.seconds = std::stod(fields[9]);
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    void Tuner::store(const std::string &fingerprint, const TuningKey &key, const TuningConfig &config) const
+    {
+        const bool exists = std::ifstream(cache_file).good();
+        std::ofstream ofs(cache_file, std::ios::app);
+        if (!ofs)
+        {
+            std::cerr << "Warning: cannot write the tuning cache " << cache_file << std::endl;
+            return;
+        }
+        if (!exists)
+            ofs << "fingerprint,method,n,ranks,threads,num_threads,backend,overlap,tile_rows,seconds\n";
+        ofs << fingerprint << "," << key.method << "," << key.n << "," << key.ranks << "," << key.threads << ","
+            << config.num_threads << "," << (config.backend == ThreadBackend::OpenMP ? "openmp" : "native") << ","
+            << (config.overlap ? 1 : 0) << "," << config.tile_rows << "," << config.seconds << "\n";
+    }
+
+    std::vector<TuningConfig> Tuner::candidates(const std::string &method, unsigned max_threads) const
+    {
+        std::vector<unsigned> thread_counts;
+        for (unsigned threads = 1; threads < max_threads; threads *= 2)
+            thread_counts.push_back(threads);
+        thread_counts.push_back(std::max(1u, max_threads));
+
+        std::vector<ThreadBackend> backends{ThreadBackend::Native};
+#ifdef _OPENMP
+        backends.push_back(ThreadBackend::OpenMP);
+#endif
+
+        std::vector<TuningConfig> result;
+        for (unsigned threads : thread_counts)
+        {
+            for (ThreadBackend backend : backends)
+            {
+                TuningConfig config;
+                config.num_threads = threads;
+                config.backend = backend;
+                result.push_back(config);
+            }
+
+            // The task-based solver always uses OpenMP tasks
+            if (method == "jacobi_hybrid")
+            {
+                for (size_t tile_rows : {0, 16, 64})
+                {
+                    TuningConfig config;
+                    config.num_threads = threads;
+                    config.backend = backends.back();
+                    config.overlap = true;
+                    config.tile_rows = tile_rows;
+                    result.push_back(config);
+                }
+            }
+        }
+        return result;
+    }
+
+    double Tuner::benchmark(const Solver &solver, const std::string &method, const TuningConfig &config, MPI_Comm comm) const
+    {
+        Solver trial = solver;
+        trial.reset();
+        trial.set_max_iter(iterations);
+        trial.set_tol(0.0);
+        trial.set_comm(comm);
+        apply(trial, config);
+
+        MPI_Barrier(comm);
+        const double start = MPI_Wtime();
+        {
+            QuietCout quiet;
+            if (method == "jacobi_omp")
+                trial.solve_jacobi_omp();
+            else if (config.overlap)
+                trial.solve_jacobi_hybrid_tasks();
+            else
+                trial.solve_jacobi_hybrid();
+        }
+        double elapsed = MPI_Wtime() - start, slowest;
+        MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, comm);
+        return slowest;
+    }
+
+    TuningConfig Tuner::tune(const Solver &solver, const std::string &method, unsigned max_threads, MPI_Comm comm)
+    {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        TuningKey key;
+        key.method = method;
+        key.n = solver.get_n();
+        key.ranks = size;
+        key.threads = max_threads;
+        const std::string fingerprint = hardware_fingerprint();
+
+        // Look up the cache on the first process: {found, num_threads, backend, overlap, tile_rows, seconds}
+        TuningConfig best;
+        double packed[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        if (rank == 0 && lookup(fingerprint, key, best))
+        {
+            packed[0] = 1.0;
+            packed[1] = best.num_threads;
+            packed[2] = (best.backend == ThreadBackend::OpenMP) ? 1.0 : 0.0;
+            packed[3] = best.overlap ? 1.0 : 0.0;
+            packed[4] = static_cast<double>(best.tile_rows);
+            packed[5] = best.seconds;
+        }
+        MPI_Bcast(packed, 6, MPI_DOUBLE, 0, comm);
+
+        last_hit = (packed[0] == 1.0);
+        if (last_hit)
+        {
+            best.num_threads = static_cast<unsigned>(packed[1]);
+            best.backend = (packed[2] == 1.0) ? ThreadBackend::OpenMP : ThreadBackend::Native;
+            best.overlap = (packed[3] == 1.0);
+            best.tile_rows = static_cast<size_t>(packed[4]);
+            best.seconds = packed[5];
+            return best;
+        }
+
+        // Benchmark every candidate; the timings are reduced over comm, so all processes agree
+        best.seconds = -1.0;
+        for (TuningConfig config : candidates(method, max_threads))
+        {
+            config.seconds = benchmark(solver, method, config, comm);
+            if (best.seconds < 0.0 || config.seconds < best.seconds)
+                best = config;
+        }
+
+        if (rank == 0)
+            store(fingerprint, key, best);
+        return best;
+    }
+} // namespace solver
@@ -35,6 +35,16 @@ echo ""
 echo ""
 echo "Scalability test completed."
 
+# Threaded solvers with more threads than the default, through the OpenMP solver
+# (boundary sweep), both thread backends and the red-black Gauss-Seidel solver
+echo ""
+echo "========================================"
+echo "Testing the threaded solvers (4 threads)"
+echo "========================================"
+mpirun -np 1 ./main --bc-sweep 2 --threads 4
+mpirun -np 1 ./main --backend-test --threads 4
+mpirun -np 1 ./main --red-black-test 128 --threads 4
+
 gnuplot test/plots/l2error_vs_h.gp test/plots/l2error_vs_n.gp test/plots/timing_vs_h.gp test/plots/timing_vs_n.gp test/plots/scalability.gp
 
 echo "Plots generated successfully."
\ No newline at end of file
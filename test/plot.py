@@ -56,24 +56,29 @@ grid_size_test("results_2.csv")
 grid_size_test("results_4.csv")
 grid_size_test("results_8.csv")
 
-def scalability_test():
-    x = [1, 2, 4, 8]
-    for i in [56, 64]:
-        timings = []
-        for filename in os.listdir('data'):
-            if filename.endswith('.csv'):
-                df = pd.read_csv('data/' + filename)
-                df = df[df['n'] == i]
-                timings.append(df['hybrid'].iloc[0])
-        print(timings)
-        plt.plot(x, timings, 'o-', label=f'n={i}')
-        timings = []
-    plt.xscale('log', base=2)
-    plt.legend()
-    plt.xlabel('Number of Processes')
-    plt.ylabel('Time (s)')
-    plt.title('Scalability Test')
+def scalability_test(mode: str):
+    # Structured output of the scaling driver (mpirun -np P ./main --scaling strong|weak)
+    filename = 'data/scaling/' + mode + '.csv'
+    if not os.path.exists(filename):
+        return
+    df = pd.read_csv(filename)
+    fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(10, 4))
+    for threads, group in df.groupby('threads'):
+        group = group.sort_values('ranks')
+        ax1.plot(group['ranks'], group['seconds'], 'o-', label=f'{threads} threads')
+        ax2.plot(group['ranks'], group['efficiency'], 'o-', label=f'{threads} threads')
+    ax1.set_xscale('log', base=2)
+    ax1.set_yscale('log', base=2)
+    ax1.set_xlabel('Number of Processes')
+    ax1.set_ylabel('Time (s)')
+    ax1.legend()
+    ax2.set_xscale('log', base=2)
+    ax2.set_xlabel('Number of Processes')
+    ax2.set_ylabel('Parallel efficiency')
+    ax2.legend()
+    fig.suptitle(f'Scaling ({mode})')
     plt.tight_layout()
     plt.show()
 
-scalability_test()
\ No newline at end of file
+scalability_test('strong')
+scalability_test('weak')
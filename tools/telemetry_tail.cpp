@@ -0,0 +1,163 @@
+/**
+ * @file telemetry_tail.cpp
+ * @brief Follow the progress of a solver publishing in a shared-memory telemetry segment.
+ *
+ * The solvers publish one sample per iteration in a ring buffer (see telemetry.hpp) when
+ * main is run with --telemetry <name>. This program maps the segment, polls it and prints
+ * the progress of every solve: iteration, residual, elapsed time, estimated time to
+ * convergence and time spent in the sweeps, halo exchanges and reductions. By default the
+ * newest sample is printed at every poll; with --all every sample still in the buffer is
+ * printed, and the samples overwritten before they could be read are counted. The program
+ * exits when the publisher closes the segment.
+ *
+ * Command Line Options:
+ * - --all: Print every sample instead of the newest one at each poll
+ * - --interval <ms>: Polling interval in milliseconds (default 200)
+ * - --wait: Wait for the segment to be created instead of failing
+ *
+ * Build and run with
+ * ```bash
+ * make telemetry_tail && ./telemetry_tail <name>
+ * ```
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+#include "telemetry.hpp"
+
+namespace
+{
+    using solver::telemetry::Sample;
+    using solver::trace::Phase;
+
+    /// @brief print the header of a solve
+    void print_solve(const Sample &sample)
+    {
+        std::cout << "\n=== solve " << sample.solve << ": " << sample.method << ", n = " << sample.n << ", "
+                  << sample.processes << " process(es), tolerance " << std::scientific << std::setprecision(1)
+                  << sample.tolerance << " ===" << std::endl;
+        std::cout << std::setw(10) << "iteration"
+                  << std::setw(13) << "residual"
+                  << std::setw(12) << "elapsed(s)"
+                  << std::setw(12) << "ETA(s)"
+                  << std::setw(12) << "sweep(s)"
+                  << std::setw(12) << "exchange(s)"
+                  << std::setw(13) << "reduction(s)" << std::endl;
+    }
+
+    /// @brief print a sample
+    void print_sample(const Sample &sample)
+    {
+        auto phase = [&](Phase p)
+        { return sample.phase_seconds[static_cast<size_t>(p)]; };
+        std::cout << std::setw(10) << sample.iteration
+                  << std::setw(13) << std::scientific << std::setprecision(4) << sample.residual
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(12) << sample.elapsed;
+        if (sample.eta >= 0.0)
+            std::cout << std::setw(12) << sample.eta;
+        else
+            std::cout << std::setw(12) << "-";
+        std::cout << std::setw(12) << phase(Phase::Sweep)
+                  << std::setw(12) << phase(Phase::Exchange)
+                  << std::setw(13) << phase(Phase::Reduction) << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string name;
+    bool all = false, wait = false;
+    std::chrono::milliseconds interval(200);
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--all")
+            all = true;
+        else if (arg == "--wait")
+            wait = true;
+        else if (arg == "--interval" && i + 1 < argc)
+            interval = std::chrono::milliseconds(std::stoul(argv[++i]));
+        else if (name.empty() && arg[0] != '-')
+            name = arg;
+        else
+        {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (name.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " <name> [--all] [--interval <ms>] [--wait]" << std::endl;
+        return 1;
+    }
+
+    // Map the segment, waiting for it if requested
+    std::unique_ptr<solver::telemetry::Reader> reader;
+    while (!reader)
+    {
+        try
+        {
+            reader = std::make_unique<solver::telemetry::Reader>(name);
+        }
+        catch (const std::runtime_error &error)
+        {
+            if (!wait)
+            {
+                std::cerr << error.what() << std::endl;
+                return 1;
+            }
+            std::this_thread::sleep_for(interval);
+        }
+    }
+
+    // Index of the next sample to print, and solve of the last sample printed
+    std::uint64_t next = 0, solve = UINT64_MAX, dropped = 0;
+    for (;;)
+    {
+        // The segment is drained once more after it is closed
+        const bool closed = reader->closed();
+        const std::uint64_t head = reader->head();
+        const std::uint64_t oldest = (head > reader->capacity()) ? head - reader->capacity() : 0;
+        if (!all && head > 0)
+            next = std::max(next, head - 1);
+        if (next < oldest)
+        {
+            dropped += oldest - next;
+            next = oldest;
+        }
+
+        for (; next < head; ++next)
+        {
+            Sample sample;
+            if (!reader->read(next, sample))
+            {
+                // Overwritten while it was read: the publisher is more than a buffer ahead
+                ++dropped;
+                continue;
+            }
+            if (sample.solve != solve)
+            {
+                print_solve(sample);
+                solve = sample.solve;
+            }
+            print_sample(sample);
+        }
+
+        if (closed)
+            break;
+        std::this_thread::sleep_for(interval);
+    }
+
+    if (all && dropped > 0)
+        std::cout << dropped << " sample(s) overwritten before they could be read (try a shorter --interval)" << std::endl;
+    return 0;
+}